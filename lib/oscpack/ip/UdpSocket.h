@@ -102,6 +102,20 @@ public:
 	// operating systems.
 	void SetAllowReuse( bool allowReuse );
 
+	// Time to live (hops) of outgoing multicast datagrams.
+	// Sets IP_MULTICAST_TTL socket option.
+	void SetMulticastTtl( int ttl );
+
+	// Deliver our own outgoing multicast datagrams to listeners
+	// on this host. Sets IP_MULTICAST_LOOP socket option.
+	void SetMulticastLoopback( bool enableLoopback );
+
+	// Join/leave a multicast group (address in 224.0.0.0/4) on the
+	// default interface. Bind() first (to 'any' and the group's port).
+	// Join throws std::runtime_error if the group can't be joined.
+	void JoinMulticastGroup( const IpEndpointName& group );
+	void LeaveMulticastGroup( const IpEndpointName& group );
+
 
 	// The socket is created in an unbound, unconnected state
 	// such a socket can only be used to send to an arbitrary
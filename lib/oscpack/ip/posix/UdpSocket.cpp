@@ -143,6 +143,38 @@ public:
 #endif
 	}
 
+	void SetMulticastTtl( int ttl )
+	{
+		unsigned char multicastTtl = (unsigned char)ttl;
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_TTL, &multicastTtl, sizeof(multicastTtl));
+	}
+
+	void SetMulticastLoopback( bool enableLoopback )
+	{
+		unsigned char loop = (unsigned char)((enableLoopback) ? 1 : 0);
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+	}
+
+	void JoinMulticastGroup( const IpEndpointName& group )
+	{
+		struct ip_mreq mreq;
+		std::memset( &mreq, 0, sizeof(mreq) );
+		mreq.imr_multiaddr.s_addr = htonl( group.address );
+		mreq.imr_interface.s_addr = htonl( INADDR_ANY );
+		if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+			throw std::runtime_error("unable to join multicast group\n");
+		}
+	}
+
+	void LeaveMulticastGroup( const IpEndpointName& group )
+	{
+		struct ip_mreq mreq;
+		std::memset( &mreq, 0, sizeof(mreq) );
+		mreq.imr_multiaddr.s_addr = htonl( group.address );
+		mreq.imr_interface.s_addr = htonl( INADDR_ANY );
+		setsockopt(socket_, IPPROTO_IP, IP_DROP_MEMBERSHIP, &mreq, sizeof(mreq));
+	}
+
 	IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 	{
 		assert( isBound_ );
@@ -269,6 +301,26 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetMulticastTtl( int ttl )
+{
+    impl_->SetMulticastTtl( ttl );
+}
+
+void UdpSocket::SetMulticastLoopback( bool enableLoopback )
+{
+    impl_->SetMulticastLoopback( enableLoopback );
+}
+
+void UdpSocket::JoinMulticastGroup( const IpEndpointName& group )
+{
+    impl_->JoinMulticastGroup( group );
+}
+
+void UdpSocket::LeaveMulticastGroup( const IpEndpointName& group )
+{
+    impl_->LeaveMulticastGroup( group );
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
 	return impl_->LocalEndpointFor( remoteEndpoint );
@@ -36,6 +36,7 @@
 */
 
 #include <winsock2.h>   // this must come first to prevent errors with MSVC7
+#include <ws2tcpip.h>   // ip_mreq
 #include <windows.h>
 #include <mmsystem.h>   // for timeGetTime()
 
@@ -137,6 +138,38 @@ public:
 		setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuseAddr, sizeof(reuseAddr));
 	}
 
+	void SetMulticastTtl( int ttl )
+	{
+		DWORD multicastTtl = (DWORD)ttl; // DWORD on win32
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_TTL, (const char*)&multicastTtl, sizeof(multicastTtl));
+	}
+
+	void SetMulticastLoopback( bool enableLoopback )
+	{
+		DWORD loop = (DWORD)((enableLoopback) ? 1 : 0); // DWORD on win32
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_LOOP, (const char*)&loop, sizeof(loop));
+	}
+
+	void JoinMulticastGroup( const IpEndpointName& group )
+	{
+		struct ip_mreq mreq;
+		std::memset( &mreq, 0, sizeof(mreq) );
+		mreq.imr_multiaddr.s_addr = htonl( group.address );
+		mreq.imr_interface.s_addr = htonl( INADDR_ANY );
+		if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char*)&mreq, sizeof(mreq)) == SOCKET_ERROR) {
+			throw std::runtime_error("unable to join multicast group\n");
+		}
+	}
+
+	void LeaveMulticastGroup( const IpEndpointName& group )
+	{
+		struct ip_mreq mreq;
+		std::memset( &mreq, 0, sizeof(mreq) );
+		mreq.imr_multiaddr.s_addr = htonl( group.address );
+		mreq.imr_interface.s_addr = htonl( INADDR_ANY );
+		setsockopt(socket_, IPPROTO_IP, IP_DROP_MEMBERSHIP, (const char*)&mreq, sizeof(mreq));
+	}
+
 	IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 	{
 		assert( isBound_ );
@@ -262,6 +295,26 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetMulticastTtl( int ttl )
+{
+    impl_->SetMulticastTtl( ttl );
+}
+
+void UdpSocket::SetMulticastLoopback( bool enableLoopback )
+{
+    impl_->SetMulticastLoopback( enableLoopback );
+}
+
+void UdpSocket::JoinMulticastGroup( const IpEndpointName& group )
+{
+    impl_->JoinMulticastGroup( group );
+}
+
+void UdpSocket::LeaveMulticastGroup( const IpEndpointName& group )
+{
+    impl_->LeaveMulticastGroup( group );
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
 	return impl_->LocalEndpointFor( remoteEndpoint );
@@ -1,4 +1,5 @@
 #include "Module_multiOscillator.hpp"
+#include "TSRealTimeCheck.hpp"
 #include "math.hpp"
 #include "Widget_multiOscillator.hpp"
 #include "TSParamQuantity.hpp"
@@ -136,8 +137,12 @@ void TS_Oscillator::deserialize(json_t* rootJ)
 //--------------------------------------------------------
 void TS_Oscillator::setPhaseShift_deg(float deg)
 {
-	phaseShift_deg = deg;
-	phaseShift_norm = deg / 360.0f;
+	if (deg != phaseShift_deg)
+	{
+		phaseShift_deg = deg;
+		phaseShift_norm = deg / 360.0f;
+		phaseShift_u32 = PhaseNorm2U32(phaseShift_norm);
+	}
 	return;
 }
 
@@ -150,6 +155,30 @@ void TS_Oscillator::setPhaseShift_deg(float deg)
 bool TS_Oscillator::calculatePhase(float dt, bool doSync)
 {
 	bool waveReset = doSync;
+#if TROWA_MOSC_FIXED_POINT_PHASE
+	if (doSync)
+	{
+		phase_u32 = 0;
+	}
+	else
+	{
+		if (frequency_Hz != dPhaseFrequency_Hz || dt != dPhaseDt)
+		{
+			// Only recalculate the increment when the frequency changes.
+			dPhaseFrequency_Hz = frequency_Hz;
+			dPhaseDt = dt;
+			double dPhase = clamp(frequency_Hz * dt, 0.f, 0.5f);
+			dPhase_u32 = (uint32_t)(dPhase * TROWA_MOSC_PHASE_U32_SCALE);
+		}
+		phase_u32 += dPhase_u32; // Wraps
+	}
+	uint32_t prevSPhi = shiftedPhase_u32;
+	shiftedPhase_u32 = phase_u32 + phaseShift_u32;
+	if (!waveReset)
+		waveReset = prevSPhi > shiftedPhase_u32;
+	phase = PhaseU32ToNorm(phase_u32);
+	shiftedPhase = PhaseU32ToNorm(shiftedPhase_u32);
+#else
 	if (doSync)
 	{
 		phase = 0;
@@ -164,6 +193,7 @@ bool TS_Oscillator::calculatePhase(float dt, bool doSync)
 	shiftedPhase = eucMod(phase + phaseShift_norm, 1.0f);
 	if (!waveReset)
 		waveReset = prevSPhi > shiftedPhase;
+#endif
 	return waveReset;
 }
 
@@ -285,6 +315,57 @@ float TS_Oscillator::calcSaw()
 	return amplitude_V * val + offset_V;
 }
 
+//--------------------------------------------------------
+// calcSin()
+// Sine wave (fixed point phase).
+// @phaseShift_u32 : (IN) Phase shift (fixed point).
+//--------------------------------------------------------
+float TS_Oscillator::calcSin(uint32_t phaseShift_u32)
+{
+	return amplitude_V * sinf(PhaseU32ToNorm(shiftedPhase_u32 + phaseShift_u32) * 2.0f * NVG_PI) + offset_V;
+} // end calcSin()
+//--------------------------------------------------------
+// calcRect()
+// Rectangle wave (fixed point phase).
+// @phaseShift_u32 : (IN) Phase shift (fixed point).
+// @pulseWidth_n : (IN) Normalized pulse width (0-1).
+//--------------------------------------------------------
+float TS_Oscillator::calcRect(uint32_t phaseShift_u32, float pulseWidth_n)
+{
+	float val = (PhaseU32ToNorm(shiftedPhase_u32 + phaseShift_u32) < pulseWidth_n) ? amplitude_V : -amplitude_V;
+	return val + offset_V;
+} // end calcRect()
+//--------------------------------------------------------
+// calcTri()
+// Triangle wave (fixed point phase).
+// @phaseShift_u32 : (IN) Phase shift (fixed point).
+//--------------------------------------------------------
+float TS_Oscillator::calcTri(uint32_t phaseShift_u32)
+{
+	float p_n = PhaseU32ToNorm(shiftedPhase_u32 + phaseShift_u32);
+	float val = 0.0f;
+	if (p_n < 0.25f)
+		val = 4.0f * p_n; // 0 to 1 (positive slope)
+	else if (p_n < 0.75f)
+		val = 2.0f - 4.0f * p_n; // -1 to 0 (positive slope)
+	else
+		val = -4.0f + 4.f * p_n;
+	return amplitude_V * val + offset_V;
+} // end calcTri()
+//--------------------------------------------------------
+// calcSaw()
+// Sawtooth wave (fixed point phase).
+// @phaseShift_u32 : (IN) Phase shift (fixed point).
+// @posRamp: (IN) True for positive ramp, false for negative ramp.
+//--------------------------------------------------------
+float TS_Oscillator::calcSaw(uint32_t phaseShift_u32, bool posRamp)
+{
+	float p_n = PhaseU32ToNorm(shiftedPhase_u32 + phaseShift_u32);
+	float a_v = 2 * amplitude_V;
+	float val = (posRamp) ? -amplitude_V + a_v * p_n : amplitude_V - a_v * p_n;
+	return val + offset_V;
+} // end calcSaw()
+
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 //::::::::::::: multiOscillator :::::::::::::::::::::::::::
@@ -307,7 +388,6 @@ multiOscillator::multiOscillator(int numOscillators, int numOscillatorOutputs) :
 	this->numberOscillators = numOscillators;
 	this->oscillators = new TS_Oscillator[numberOscillators];
 	this->numOscillatorOutputs = numOscillatorOutputs;
-	this->isFirstRun = true;
 
 	//--------------------------
 	// * Configure Parameters *
@@ -501,13 +581,11 @@ void multiOscillator::dataFromJson(json_t *rootJ)
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 void multiOscillator::process(const ProcessArgs &args)
 {
+	TS_RT_CHECK_SCOPE("multiOscillator");
 	float dt = args.sampleTime;// engineGetSampleTime();
-	bool setParameterConfigs = false;
-	if (isFirstRun)
-	{
-		setParameterConfigs = true;
-		isFirstRun = false;
-	}
+	// Lights are only written every few samples
+	bool updateLights = lightClock.process();
+	float lightTauFrames = lightLambda * args.sampleRate;
 	
 	// Get Oscillator CV and User Inputs
 	for (int osc = 0; osc < numberOscillators; osc++)
@@ -523,15 +601,13 @@ void multiOscillator::process(const ProcessArgs &args)
 		//------------------------------
 		// Sync this oscillator
 		//------------------------------
-		if (lights[baseLightId + TS_Oscillator::BaseLightIds::OSCWF_SYNC_LED].value > 0)
-			lights[baseLightId + TS_Oscillator::BaseLightIds::OSCWF_SYNC_LED].value -= lights[baseLightId + TS_Oscillator::BaseLightIds::OSCWF_SYNC_LED].value / lightLambda * dt;
-		else if (lights[baseLightId + TS_Oscillator::BaseLightIds::OSCWF_SYNC_LED].value < 0)
-			lights[baseLightId + TS_Oscillator::BaseLightIds::OSCWF_SYNC_LED].value = 0;
 		if (theOscillator->synchTrigger.process(params[baseParamId + TS_Oscillator::BaseParamIds::OSCWF_SYNC_PARAM].getValue() + inputs[baseInputId + TS_Oscillator::BaseInputIds::OSCWF_SYNC_INPUT].getVoltage()))
 		{
-			lights[baseLightId + TS_Oscillator::BaseLightIds::OSCWF_SYNC_LED].value = 1.0f;
+			theOscillator->syncLight.trigger(lightClock.frame);
 			sync = true;
 		} // end if
+		if (updateLights)
+			lights[baseLightId + TS_Oscillator::BaseLightIds::OSCWF_SYNC_LED].value = theOscillator->syncLight.exponential(lightClock.frame, lightTauFrames);
 
 		//------------------------------
 		// Values In (Add Input + Knob)
@@ -598,7 +674,6 @@ void multiOscillator::process(const ProcessArgs &args)
 		{
 			//float type = clamp((int)rescale(params[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_OSC_TYPE_PARAM].getValue(), TROWA_MOSC_KNOB_MIN_V, TROWA_MOSC_KNOB_MAX_V, 0, WaveFormType::NUM_WAVEFORMS), 0, WaveFormType::NUM_WAVEFORMS - 1);
 			// [v1.0]- No longer -10 to 10 V from knob. Now just 0 to NUM_WAVEFORMS
-			WaveFormType lastType = theOscillator->outputWaveforms[i].waveFormType;
 			float type = (int) params[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_OSC_TYPE_PARAM].getValue();
 			theOscillator->outputWaveforms[i].ui_waveFormType = static_cast<WaveFormType>(type);
 			if (inputs[baseInputId + TS_OscillatorOutput::BaseInputIds::OUT_OSC_TYPE_INPUT].isConnected()) {
@@ -606,34 +681,6 @@ void multiOscillator::process(const ProcessArgs &args)
 					TROWA_MOSC_TYPE_INPUT_MIN_V, TROWA_MOSC_TYPE_INPUT_MAX_V, 0, WaveFormType::NUM_WAVEFORMS), 0, WaveFormType::NUM_WAVEFORMS - 1);
 			}
 			theOscillator->outputWaveforms[i].waveFormType = static_cast<WaveFormType>(type);
-			// Change the built-in param quantity labels for the 'Aux' based on waveform type:
-			if (lastType != theOscillator->outputWaveforms[i].waveFormType || setParameterConfigs)
-			{
-				switch (theOscillator->outputWaveforms[i].waveFormType)
-				{
-					case WAVEFORM_SAW:
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->label = std::string("Slope");
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->unit = std::string("");
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayMultiplier = 2.f/TROWA_MOSC_KNOB_AUX_MAX_V;
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayOffset = -1.0f; // -1 to 1
-						break;
-					case WAVEFORM_SQR:
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->label = std::string("Pulse Width");
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->unit = std::string("%");
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayMultiplier = 100.f/TROWA_MOSC_KNOB_AUX_MAX_V;
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayOffset = 0.0f; // 0 to 100
-						break;
-					case WAVEFORM_SIN:
-					case WAVEFORM_TRI:
-					default:
-						// No AUX
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->label = std::string("Aux");
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->unit = std::string(" N/A");
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayMultiplier = 100.f/TROWA_MOSC_KNOB_AUX_MAX_V;
-						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayOffset = 0.0f; // 0 to 100, doesn't really matter			
-						break;
-				} // end switch	
-			}
 
 			// *> Phase shift for this output
 			float phi = rescale(params[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_PHASE_SHIFT_PARAM].getValue(),
@@ -673,7 +720,11 @@ void multiOscillator::process(const ProcessArgs &args)
 			{
 				// Calculate the RAW output:
 				float rawOutput = 0.0f;
+#if TROWA_MOSC_FIXED_POINT_PHASE
+				uint32_t phi_n = theOscillator->outputWaveforms[i].phaseShift_u32;
+#else
 				float phi_n = theOscillator->outputWaveforms[i].phaseShift_norm;
+#endif
 				switch (theOscillator->outputWaveforms[i].waveFormType)
 				{
 				case WaveFormType::WAVEFORM_SIN:
@@ -699,17 +750,35 @@ void multiOscillator::process(const ProcessArgs &args)
 					float modOutput = 0.f;
 					float modulator = inputs[baseInputId + TS_OscillatorOutput::BaseInputIds::OUT_AM_INPUT].getVoltage();
 					float modWeight = params[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AM_MIX_PARAM].getValue(); //rescale(params[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AM_MIX_PARAM].getValue(), TROWA_MOSC_KNOB_MIN_V, TROWA_MOSC_KNOB_MAX_V, 0.f, 1.f)
-					if (theOscillator->outputWaveforms[i].amRingModulation)
+					TS_OscillatorOutput* outWave = &(theOscillator->outputWaveforms[i]);
+					if (outWave->amOversampler.factor != outWave->amOversample)
+						outWave->amOversampler.setFactor(outWave->amOversample);
+					if (outWave->amOversampler.factor > 1)
 					{
-						// Ring modulation
-						modOutput = theOscillator->ringModulator.ringMod(modulator, rawOutput);
+						// Oversampled: modulate and mix at the high rate (raw goes through the same filters so the mix stays in phase).
+						TS_Oversampler2In* os = &(outWave->amOversampler);
+						os->upsample(modulator, rawOutput);
+						for (int k = 0; k < os->factor; k++)
+						{
+							modOutput = (outWave->amRingModulation) ? theOscillator->ringModulator.ringMod(os->bufA[k], os->bufB[k]) : os->bufA[k] * os->bufB[k];
+							os->bufOut[k] = modWeight * modOutput + (1.0f - modWeight)*os->bufB[k];
+						}
+						outputs[baseOutputId + TS_OscillatorOutput::BaseOutputIds::OUT_MULTIPLIED_SIGNAL].setVoltage(os->downsample());
 					}
 					else
 					{
-						// Digital modulation (just mulitply)
-						modOutput = modulator * rawOutput;
+						if (outWave->amRingModulation)
+						{
+							// Ring modulation
+							modOutput = theOscillator->ringModulator.ringMod(modulator, rawOutput);
+						}
+						else
+						{
+							// Digital modulation (just mulitply)
+							modOutput = modulator * rawOutput;
+						}
+						outputs[baseOutputId + TS_OscillatorOutput::BaseOutputIds::OUT_MULTIPLIED_SIGNAL].setVoltage(modWeight * modOutput + (1.0f - modWeight)*rawOutput);
 					}
-					outputs[baseOutputId + TS_OscillatorOutput::BaseOutputIds::OUT_MULTIPLIED_SIGNAL].setVoltage(modWeight * modOutput + (1.0f - modWeight)*rawOutput);
 				} // end calculate the multiplied signal
 			} // end calculate the raw signal
 
@@ -722,6 +791,55 @@ void multiOscillator::process(const ProcessArgs &args)
 	return;
 } // end process()
 
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// updateAuxParamLabels()
+// [UI thread] Change the built-in param quantity labels for the 'Aux' based on waveform type.
+// (Not done in process() since assigning the std::strings allocates.)
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void multiOscillator::updateAuxParamLabels()
+{
+	for (int osc = 0; osc < numberOscillators; osc++)
+	{
+		TS_Oscillator* theOscillator = &(oscillators[osc]);
+		int baseParamId = ParamIds::OSC_PARAM_START + osc * (TS_Oscillator::BaseParamIds::OSCWF_NUM_PARAMS + numOscillatorOutputs * TS_OscillatorOutput::BaseParamIds::OUT_NUM_PARAMS)
+			+ TS_Oscillator::BaseParamIds::OSCWF_NUM_PARAMS;
+		for (int i = 0; i < theOscillator->numOutputWaveForms; i++)
+		{
+			WaveFormType waveFormType = theOscillator->outputWaveforms[i].waveFormType;
+			if (waveFormType != theOscillator->outputWaveforms[i].auxLabelWaveFormType)
+			{
+				theOscillator->outputWaveforms[i].auxLabelWaveFormType = waveFormType;
+				switch (waveFormType)
+				{
+					case WAVEFORM_SAW:
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->label = std::string("Slope");
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->unit = std::string("");
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayMultiplier = 2.f/TROWA_MOSC_KNOB_AUX_MAX_V;
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayOffset = -1.0f; // -1 to 1
+						break;
+					case WAVEFORM_SQR:
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->label = std::string("Pulse Width");
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->unit = std::string("%");
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayMultiplier = 100.f/TROWA_MOSC_KNOB_AUX_MAX_V;
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayOffset = 0.0f; // 0 to 100
+						break;
+					case WAVEFORM_SIN:
+					case WAVEFORM_TRI:
+					default:
+						// No AUX
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->label = std::string("Aux");
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->unit = std::string(" N/A");
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayMultiplier = 100.f/TROWA_MOSC_KNOB_AUX_MAX_V;
+						this->paramQuantities[baseParamId + TS_OscillatorOutput::BaseParamIds::OUT_AUX_PARAM]->displayOffset = 0.0f; // 0 to 100, doesn't really matter			
+						break;
+				} // end switch
+			}
+			baseParamId += TS_OscillatorOutput::BaseParamIds::OUT_NUM_PARAMS;
+		}
+	}
+	return;
+} // end updateAuxParamLabels()
+
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 //::::::::::::: TS_OscillatorOutput :::::::::::::::::::::::::::::
@@ -734,7 +852,9 @@ void TS_OscillatorOutput::initialize()
 {
 	phaseShift_deg = 0;
 	phaseShift_norm = 0;
+	phaseShift_u32 = 0;
 	amRingModulation = false;
+	amOversample = 1;
 	auxParam_norm = 0.5f;
 	return;
 }
@@ -744,8 +864,12 @@ void TS_OscillatorOutput::initialize()
 //--------------------------------------------------------
 void TS_OscillatorOutput::setPhaseShift_deg(float deg)
 {
-	phaseShift_deg = deg;
-	phaseShift_norm = deg / 360.0f;
+	if (deg != phaseShift_deg)
+	{
+		phaseShift_deg = deg;
+		phaseShift_norm = deg / 360.0f;
+		phaseShift_u32 = PhaseNorm2U32(phaseShift_norm);
+	}
 	return;
 }
 //--------------------------------------------------------
@@ -759,6 +883,7 @@ json_t* TS_OscillatorOutput::serialize()
 	json_object_set_new(rootJ, "phaseShift_deg", json_real(ui_phaseShift_deg));
 	json_object_set_new(rootJ, "auxParam_norm", json_real(auxParam_norm));
 	json_object_set_new(rootJ, "amRingMod", json_integer(amRingModulation));
+	json_object_set_new(rootJ, "amOversample", json_integer(amOversample));
 	return rootJ;
 } // end serialize()
 //--------------------------------------------------------
@@ -781,5 +906,8 @@ void TS_OscillatorOutput::deserialize(json_t* rootJ)
 		currJ = json_object_get(rootJ, "amRingMod");
 		if (currJ)
 			amRingModulation = json_integer_value(currJ) > 0;
+		currJ = json_object_get(rootJ, "amOversample");
+		if (currJ)
+			amOversample = clamp((int)json_integer_value(currJ), 1, TROWA_MOSC_MAX_OVERSAMPLE);
 	}
 } // end deserialize()
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <rack.hpp>
 using namespace rack;
 #include "trowaSoft.hpp"
+#include "TSLightEnvelope.hpp"
 //#include "dsp/digital.hpp"
 
 #define DEBUG_MOSC 1
@@ -53,6 +54,175 @@ extern Model* modelMultiOscillator;
 #define TROWA_MOSC_F_KNOB_MIN_V			   MOSC_FREQ_MIN_HZ // Frequency 
 #define TROWA_MOSC_F_KNOB_MAX_V			   MOSC_FREQ_MAX_HZ // Frequency
 #define TROWA_MOSC_FREQ_KNOB_NEEDS_CONVERSION		0 // If Knob value is same as the frequency values, then we don't need to convert.
+// Phase accumulator: 1 = 32-bit fixed point (wrap is integer overflow, phase shifts are integer adds), 0 = float.
+// Fixed point doesn't drift between oscillators running at the same frequency over long sessions.
+#define TROWA_MOSC_FIXED_POINT_PHASE			1
+#define TROWA_MOSC_PHASE_U32_SCALE				4294967296.0 // 2^32 (one full cycle)
+
+//--------------------------------------------------------
+// PhaseNorm2U32()
+// Normalized phase (any range, 1 = one cycle) to 32-bit fixed point [0, 2^32).
+// @phase_n : (IN) Normalized phase.
+//--------------------------------------------------------
+inline uint32_t PhaseNorm2U32(float phase_n)
+{
+	double p = (double)phase_n;
+	p -= floor(p);
+	// p == 1 (rounding) wraps to 0.
+	return (uint32_t)(uint64_t)(p * TROWA_MOSC_PHASE_U32_SCALE);
+}
+//--------------------------------------------------------
+// PhaseU32ToNorm()
+// 32-bit fixed point phase to normalized [0-1). Uses the top 24 bits so the result is exact in a float (never rounds up to 1).
+// @phase_u32 : (IN) Fixed point phase.
+//--------------------------------------------------------
+inline float PhaseU32ToNorm(uint32_t phase_u32)
+{
+	return (float)(phase_u32 >> 8) * (1.0f / 16777216.0f);
+}
+
+// AM/Ring Mod oversampling.
+#define TROWA_MOSC_HALFBAND_NUM_COEFS			8 // Allpass sections per half-band filter (4 per path).
+#define TROWA_MOSC_MAX_OVERSAMPLE_STAGES		3 // 2^3 = 8x max.
+#define TROWA_MOSC_MAX_OVERSAMPLE			(1 << TROWA_MOSC_MAX_OVERSAMPLE_STAGES)
+
+// Half-band coefficients (2 path polyphase IIR, ~100 dB stop band, transition 0.04 fs).
+// Even indices are path 0, odd are path 1.
+static const float TS_HalfBandCoefs[TROWA_MOSC_HALFBAND_NUM_COEFS] = {
+	0.040633461f, 0.150505129f, 0.300757056f, 0.460774505f, 0.609524315f, 0.738503841f, 0.849223810f, 0.949742784f
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TS_HalfBand2x
+// One 2x half-band stage (polyphase allpass pair). Both paths run at the lower
+// rate, so a 2x stage only costs TROWA_MOSC_HALFBAND_NUM_COEFS first order
+// allpasses per low rate sample.
+// One instance is either an upsampler or a downsampler (has state).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TS_HalfBand2x {
+	float x1[TROWA_MOSC_HALFBAND_NUM_COEFS];
+	float y1[TROWA_MOSC_HALFBAND_NUM_COEFS];
+
+	TS_HalfBand2x()
+	{
+		reset();
+		return;
+	}
+	void reset()
+	{
+		for (int i = 0; i < TROWA_MOSC_HALFBAND_NUM_COEFS; i++)
+		{
+			x1[i] = 0.0f;
+			y1[i] = 0.0f;
+		}
+		return;
+	}
+	// Run @x through the allpass chain of path @p (0 or 1).
+	inline float path(float x, int p)
+	{
+		for (int i = p; i < TROWA_MOSC_HALFBAND_NUM_COEFS; i += 2)
+		{
+			float y = TS_HalfBandCoefs[i] * (x - y1[i]) + x1[i];
+			x1[i] = x;
+			y1[i] = y;
+			x = y;
+		}
+		return x;
+	}
+	// 1 sample in, 2 out.
+	inline void up(float x, float* out)
+	{
+		out[0] = path(x, 0);
+		out[1] = path(x, 1);
+		return;
+	}
+	// 2 samples in, 1 out.
+	inline float down(const float* in)
+	{
+		return 0.5f * (path(in[1], 0) + path(in[0], 1));
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TS_Oversampler2In
+// 1x/2x/4x/8x oversampling for a 2 input, 1 output nonlinearity (cascaded
+// TS_HalfBand2x stages).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TS_Oversampler2In {
+	// Oversampling factor (1, 2, 4, 8).
+	int factor = 1;
+	// log2(factor).
+	int numStages = 0;
+	TS_HalfBand2x upA[TROWA_MOSC_MAX_OVERSAMPLE_STAGES];
+	TS_HalfBand2x upB[TROWA_MOSC_MAX_OVERSAMPLE_STAGES];
+	TS_HalfBand2x down[TROWA_MOSC_MAX_OVERSAMPLE_STAGES];
+	// Upsampled inputs.
+	float bufA[TROWA_MOSC_MAX_OVERSAMPLE];
+	float bufB[TROWA_MOSC_MAX_OVERSAMPLE];
+	// Output (at the high rate, filled in by the caller).
+	float bufOut[TROWA_MOSC_MAX_OVERSAMPLE];
+
+	//--------------------------------------------------------
+	// setFactor()
+	// Set the oversampling factor and clear the filters.
+	// @f : (IN) 1, 2, 4 or 8 (rounded down to a power of 2).
+	//--------------------------------------------------------
+	void setFactor(int f)
+	{
+		numStages = 0;
+		while (numStages < TROWA_MOSC_MAX_OVERSAMPLE_STAGES && (2 << numStages) <= f)
+			numStages++;
+		factor = 1 << numStages;
+		for (int s = 0; s < TROWA_MOSC_MAX_OVERSAMPLE_STAGES; s++)
+		{
+			upA[s].reset();
+			upB[s].reset();
+			down[s].reset();
+		}
+		return;
+	}
+	//--------------------------------------------------------
+	// upsample()
+	// Fill bufA and bufB with factor samples each.
+	// @a : (IN) Input A.
+	// @b : (IN) Input B.
+	//--------------------------------------------------------
+	void upsample(float a, float b)
+	{
+		bufA[0] = a;
+		bufB[0] = b;
+		int n = 1;
+		for (int s = 0; s < numStages; s++)
+		{
+			// Work backwards so we can expand in place.
+			for (int i = n - 1; i >= 0; i--)
+			{
+				upA[s].up(bufA[i], bufA + 2 * i);
+				upB[s].up(bufB[i], bufB + 2 * i);
+			}
+			n *= 2;
+		}
+		return;
+	}
+	//--------------------------------------------------------
+	// downsample()
+	// Decimate bufOut (factor samples) back to 1.
+	// @returns : The output at the base rate.
+	//--------------------------------------------------------
+	float downsample()
+	{
+		int n = factor;
+		for (int s = numStages - 1; s >= 0; s--)
+		{
+			n /= 2;
+			for (int i = 0; i < n; i++)
+			{
+				bufOut[i] = down[s].down(bufOut + 2 * i);
+			}
+		}
+		return bufOut[0];
+	}
+};
 
 
 // Wave form type (SINE, SQUARE, TRIANGLE, SAW).
@@ -122,11 +292,15 @@ struct TS_OscillatorOutput {
 	float phaseShift_deg = 0.0f;
 	// Phase shift (-1 to 1).
 	float phaseShift_norm = 0.0f;
+	// Phase shift (fixed point, 2^32 = 1 cycle).
+	uint32_t phaseShift_u32 = 0;
 	// Which wave form to output.
 	WaveFormType waveFormType = WaveFormType::WAVEFORM_SIN;
 
 	// Waveform from knob/ui control (not CV).
 	WaveFormType ui_waveFormType = WaveFormType::WAVEFORM_SIN;
+	// [UI] Waveform the Aux param quantity is labeled for (NUM_WAVEFORMS for none yet).
+	WaveFormType auxLabelWaveFormType = WaveFormType::NUM_WAVEFORMS;
 	// [Rectangle] Pulse width (normalized 0-1).
 	// [Ramp] Or >= 0.5f for positive Ramp, < 0.5f for negative Ramp.
 	float auxParam_norm = 0.5;
@@ -136,6 +310,10 @@ struct TS_OscillatorOutput {
 	bool amRingModulation = false;
 	// For AM mode (btn). Digital (false) or Ring Mod (true).
 	dsp::SchmittTrigger amRingModulationTrigger;
+	// AM/Ring Mod oversampling factor (1 = off, 2, 4, 8). Set from the UI.
+	int amOversample = 1;
+	// AM/Ring Mod oversampler (only used for the multiplied output).
+	TS_Oversampler2In amOversampler;
 
 #if DEBUG_MOSC
 	// For debugging:
@@ -291,6 +469,8 @@ struct TS_Oscillator {
 	float phaseShift_deg = 0.0f;
 	// Phase shift (-1 to 1).
 	float phaseShift_norm = 0.0f;
+	// Phase shift (fixed point, 2^32 = 1 cycle).
+	uint32_t phaseShift_u32 = 0;
 	// Phase shift (radians) (used value).
 	//float phaseShift_radians = 0.0f;
 	// Offset (V) (used value).
@@ -307,6 +487,16 @@ struct TS_Oscillator {
 	float phase = 0.0f;
 	// Shift phase from 0-1.
 	float shiftedPhase = 0.0f;
+	// Phase (fixed point, 2^32 = 1 cycle). Wraps by overflow.
+	uint32_t phase_u32 = 0;
+	// Shifted phase (fixed point).
+	uint32_t shiftedPhase_u32 = 0;
+	// Phase increment per sample (fixed point) for dPhaseFrequency_Hz and dPhaseDt.
+	uint32_t dPhase_u32 = 0;
+	// Frequency (Hz) dPhase_u32 was calculated for.
+	float dPhaseFrequency_Hz = -1.0f;
+	// Sample time dPhase_u32 was calculated for.
+	float dPhaseDt = -1.0f;
 	// The number of output waves.
 	int numOutputWaveForms = TROWA_MOSC_DEFAULT_NUM_OSC_OUTPUTS;
 	// The output waveforms
@@ -319,6 +509,8 @@ struct TS_Oscillator {
 	dsp::SchmittTrigger synchTrigger;
 	// Sync out
 	dsp::PulseGenerator synchPulse;
+	// Sync LED.
+	TSLightEnvelope syncLight;
 	//// If this oscillator should sync with another, the source oscillator index.
 	//int syncSrcOscillatorIx = -1;
 	//// If this step, the oscillator is restarted either by sync input or by reaching the end.
@@ -381,6 +573,12 @@ struct TS_Oscillator {
 	float calcRect(float phaseShift_n, float pulseWidth_n);
 	float calcTri(float phaseShift_n);
 	float calcSaw(float phaseShift_n, bool posRamp);
+
+	// Fixed point versions. @phaseShift_u32 : (IN) Output phase shift (fixed point).
+	float calcSin(uint32_t phaseShift_u32);
+	float calcRect(uint32_t phaseShift_u32, float pulseWidth_n);
+	float calcTri(uint32_t phaseShift_u32);
+	float calcSaw(uint32_t phaseShift_u32, bool posRamp);
 };
 
 
@@ -428,7 +626,8 @@ struct multiOscillator : Module {
 	// If this has it controls configured.
 	bool isInitialized = false;
 	const float lightLambda = 0.005f;
-	bool isFirstRun = true;
+	// Light frame counter/divider.
+	TSLightClock lightClock;
 
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// multiOscillator()
@@ -477,6 +676,11 @@ struct multiOscillator : Module {
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	void process(const ProcessArgs &args) override;
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// updateAuxParamLabels()
+	// [UI thread] Update the Aux param quantity label/unit for the current waveform types.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void updateAuxParamLabels();
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// reset(void)
 	// Initialize values.
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
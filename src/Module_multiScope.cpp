@@ -9,6 +9,7 @@
 #include "trowaSoftUtilities.hpp"
 //#include "dsp/digital.hpp"
 #include "Module_multiScope.hpp"
+#include "TSRealTimeCheck.hpp"
 #include "TSScopeBase.hpp"
 #include "Widget_multiScope.hpp"
 #include "TSColors.hpp"
@@ -59,7 +60,7 @@ multiScope::multiScope() // : Module(multiScope::NUM_PARAMS, multiScope::NUM_INP
 			/*label*/ "Rotation", /*unit*/ " degrees", /*displayBase*/ 0, /*displayMultiplier*/ 9.f/NVG_PI); // Abs: 18 = 180degrees/10V, Rate: 9/NVG_PI = 0.5radians/NVG_PI*180degrees/10V
 		configParam(/*id*/ multiScope::ROTATION_MODE_PARAM + wIx, 0, 1, 0, "Rotation Absolute");
 		configParam(/*id*/ multiScope::TIME_PARAM + wIx, TROWA_SCOPE_TIME_KNOB_MIN, TROWA_SCOPE_TIME_KNOB_MAX, TROWA_SCOPE_TIME_KNOB_DEF, "Time Scale");
-		configParam(/*id*/ multiScope::TRIG_PARAM + wIx, TROWA_SCOPE_TIME_KNOB_MIN, TROWA_SCOPE_TIME_KNOB_MAX, TROWA_SCOPE_TIME_KNOB_DEF);	 // Not really used			
+		configParam(/*id*/ multiScope::TRIG_PARAM + wIx, TROWA_SCOPE_TRIG_LEVEL_MIN, TROWA_SCOPE_TRIG_LEVEL_MAX, TROWA_SCOPE_TRIG_LEVEL_DEF, "Trigger Level", " V"); // No knob, set from the context menu
 		configParam(/*id*/ multiScope::X_POS_PARAM + wIx, /*minVal*/ TROWA_SCOPE_POS_KNOB_MIN, /*maxVal*/ TROWA_SCOPE_POS_KNOB_MAX, /*defVal*/ TROWA_SCOPE_POS_X_KNOB_DEF, /*label*/ "X-Position");
 		configParam(/*id*/ multiScope::X_SCALE_PARAM + wIx, /*minVal*/ TROWA_SCOPE_SCALE_KNOB_MIN, /*maxVal*/ TROWA_SCOPE_SCALE_KNOB_MAX, /*defVal*/ 1.0, /*label*/ "X-Scale");		
 		configParam(/*id*/ multiScope::Y_POS_PARAM + wIx, /*minVal*/ TROWA_SCOPE_POS_KNOB_MIN, /*maxVal*/ TROWA_SCOPE_POS_KNOB_MAX, /*defVal*/ TROWA_SCOPE_POS_Y_KNOB_DEF, /*label*/ "Y-Position");
@@ -96,6 +97,7 @@ multiScope::~multiScope()
 // [Previously step(void)]
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 void multiScope::process(const ProcessArgs &args) {
+	TS_RT_CHECK_SCOPE("multiScope");
 	if (!initialized)
 		return;
 
@@ -245,14 +247,24 @@ void multiScope::process(const ProcessArgs &args) {
 		// Compute time:
 		float deltaTime = powf(2.0, params[TIME_PARAM+wIx].getValue() + inputs[TIME_INPUT+wIx].getVoltage());
 		int frameCount = (int)ceilf(deltaTime * args.sampleRate);
+		if (waveForms[wIx]->triggerMode != waveForms[wIx]->activeTriggerMode || waveForms[wIx]->lissajous != waveForms[wIx]->activeLissajous)
+			waveForms[wIx]->resetCapture();
+		if (!waveForms[wIx]->lissajous && waveForms[wIx]->triggerMode != TSWaveform::TriggerOff)
+		{
+			// Triggered capture (pre-trigger ring)
+			waveForms[wIx]->processTriggered(inputs[X_INPUT+wIx].getVoltage(), inputs[Y_INPUT+wIx].getVoltage(),
+				(!inputs[PEN_ON_INPUT + wIx].isConnected() || inputs[PEN_ON_INPUT + wIx].getVoltage() > 0.1),
+				clamp(params[TRIG_PARAM+wIx].getValue(), TROWA_SCOPE_TRIG_LEVEL_MIN, TROWA_SCOPE_TRIG_LEVEL_MAX), frameCount, args.sampleRate);
+		}
 		// Add frame to buffer
-		if (waveForms[wIx]->bufferIndex < BUFFER_SIZE) {
+		else if (waveForms[wIx]->bufferIndex < BUFFER_SIZE) {
 			if (++(waveForms[wIx]->frameIndex) > frameCount) {
 				waveForms[wIx]->frameIndex = 0;
 				waveForms[wIx]->bufferX[waveForms[wIx]->bufferIndex] = inputs[X_INPUT+wIx].getVoltage();
 				waveForms[wIx]->bufferY[waveForms[wIx]->bufferIndex] = inputs[Y_INPUT+wIx].getVoltage();
 				waveForms[wIx]->bufferPenOn[waveForms[wIx]->bufferIndex] = (!inputs[PEN_ON_INPUT + wIx].isConnected() || inputs[PEN_ON_INPUT + wIx].getVoltage() > 0.1); // Allow some noise?
 				waveForms[wIx]->bufferIndex++;
+				waveForms[wIx]->sampleCount++;
 			}
 		}
 		else {
@@ -289,11 +301,14 @@ void multiScope::process(const ProcessArgs &args) {
 // @compositeOp: (IN) Some global effect if any
 // @flipX: (IN) Flip along x (at x=0)
 // @flipY: (IN) Flip along y
+// @firstIx: (IN) First point to draw.
+// @numPoints: (IN) Number of points to draw.
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 void multiScopeDisplay::drawWaveform(const DrawArgs &args, float *valX, float *valY, bool* penOn,
 	float rotRate, float lineThickness, NVGcolor lineColor,
 	bool doFill, NVGcolor fillColor,
-	NVGcompositeOperation compositeOp, bool flipX, bool flipY)
+	NVGcompositeOperation compositeOp, bool flipX, bool flipY,
+	int firstIx, int numPoints)
 {
 	if (!valX)
 		return;
@@ -349,7 +364,8 @@ void multiScopeDisplay::drawWaveform(const DrawArgs &args, float *valX, float *v
 	uint8_t lastLocCodeRaw = POINT_POS_INSIDE;
 	bool lastPointExists = false; // If the last point was actually calculated (i.e. false if pen is off)
 	uint8_t lastLocCode = POINT_POS_INSIDE;
-	for (int i = 0; i < BUFFER_SIZE; i++) {
+	tracePath.clear();
+	for (int i = firstIx; i < firstIx + numPoints; i++) {
 		if (penOn[i])
 		{
 			float x, y;
@@ -472,11 +488,11 @@ void multiScopeDisplay::drawWaveform(const DrawArgs &args, float *valX, float *v
 						// Last point was out of bounds, but is now not out of bounds
 						if (!lastPointStarted)
 						{
-							nvgMoveTo(args.vg, p1.x, p1.y);
+							tracePath.moveTo(p1.x, p1.y);
 						}
 						else
 						{
-							nvgLineTo(args.vg, p1.x, p1.y);
+							tracePath.lineTo(p1.x, p1.y);
 						}
 						lastPointStarted = true;
 					} // end if plot prev point
@@ -497,11 +513,11 @@ void multiScopeDisplay::drawWaveform(const DrawArgs &args, float *valX, float *v
 			{
 				if (!lastPointStarted)
 				{
-					nvgMoveTo(args.vg, p.x, p.y);
+					tracePath.moveTo(p.x, p.y);
 				}
 				else
 				{
-					nvgLineTo(args.vg, p.x, p.y);
+					tracePath.lineTo(p.x, p.y);
 				}
 				lastPointStarted = true;
 			}
@@ -519,7 +535,18 @@ void multiScopeDisplay::drawWaveform(const DrawArgs &args, float *valX, float *v
 			lastPointExists = false;
 		} // end else (pen off)
 	} // end loop through buffer
-    
+
+	// XY traces: drop points that would not show at this line thickness
+	if (valY && module->xyTraceQuality > TraceQualityFull && module->xyTraceQuality < TRACE_NUM_QUALITIES)
+		tracePath.simplify(lineThickness * TSScopeTraceQualityTolerance[module->xyTraceQuality]);
+	for (int i = 0; i < tracePath.numPoints; i++)
+	{
+		if (tracePath.start[i])
+			nvgMoveTo(args.vg, tracePath.x[i], tracePath.y[i]);
+		else
+			nvgLineTo(args.vg, tracePath.x[i], tracePath.y[i]);
+	}
+
 	nvgLineCap(args.vg, NVG_ROUND);
 	nvgMiterLimit(args.vg, 2.0);
 	nvgGlobalCompositeOperation(args.vg, compositeOp);
@@ -535,6 +562,292 @@ void multiScopeDisplay::drawWaveform(const DrawArgs &args, float *valX, float *v
 	nvgRestore(args.vg);
 	nvgGlobalCompositeOperation(args.vg, NVG_SOURCE_OVER); // Restore to normal
 	return;
-} // end drawWaveform()	  
+} // end drawWaveform()
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// getValues()
+// Offset/scaled values to draw (oldest first).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+bool multiScopeDisplay::getValues(float* valuesX, float* valuesY, bool* penOn)
+{
+	float gainX = ((int)(module->params[multiScope::X_SCALE_PARAM + wIx].getValue() * TROWA_SCOPE_ROUND_VALUE)) / (float)(TROWA_SCOPE_ROUND_VALUE);
+	float gainY = ((int)(module->params[multiScope::Y_SCALE_PARAM + wIx].getValue() * TROWA_SCOPE_ROUND_VALUE)) / (float)(TROWA_SCOPE_ROUND_VALUE);
+	float offsetX = ((int)(module->params[multiScope::X_POS_PARAM + wIx].getValue() * TROWA_SCOPE_ROUND_VALUE)) / (float)(TROWA_SCOPE_ROUND_VALUE);
+	float offsetY = ((int)(module->params[multiScope::Y_POS_PARAM + wIx].getValue() * TROWA_SCOPE_ROUND_VALUE)) / (float)(TROWA_SCOPE_ROUND_VALUE);
+
+	TSWaveform* waveForm = module->waveForms[wIx];
+	const float* srcX = waveForm->bufferX;
+	const float* srcY = waveForm->bufferY;
+	const bool* srcPenOn = waveForm->bufferPenOn;
+	bool newCapture = false;
+	if (!waveForm->lissajous && waveForm->triggerMode != TSWaveform::TriggerOff)
+	{
+		// Triggered: take a new capture if there is one (the module won't write another until we do)
+		uint32_t published = waveForm->capturePublished.load(std::memory_order_acquire);
+		if (published != waveForm->captureTaken.load(std::memory_order_relaxed))
+		{
+			memcpy(captureX, waveForm->bufferX, sizeof(captureX));
+			memcpy(captureY, waveForm->bufferY, sizeof(captureY));
+			memcpy(capturePenOn, waveForm->bufferPenOn, sizeof(capturePenOn));
+			waveForm->captureTaken.store(published, std::memory_order_release);
+			newCapture = true;
+		}
+		srcX = captureX;
+		srcY = captureY;
+		srcPenOn = capturePenOn;
+	}
+	float multX = gainX / 10.0;
+	float multY = gainY / 10.0;
+	for (int i = 0; i < BUFFER_SIZE; i++) {
+		int j = i;
+		// Lock display to buffer if buffer update deltaTime <= 2^-11
+		if (waveForm->lissajous)
+			j = (i + waveForm->bufferIndex) % BUFFER_SIZE;
+		valuesX[i] = (srcX[j] + offsetX) * multX;
+		valuesY[i] = (srcY[j] + offsetY) * multY;
+		penOn[i] = srcPenOn[j];
+	}
+	return newCapture;
+} // end getValues()
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// getRotationRate()
+// Sets the absolute rotation (if ABS is on) and returns the rotation rate.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+float multiScopeDisplay::getRotationRate()
+{
+	TSWaveform* waveForm = module->waveForms[wIx];
+	float rotRate = 0;
+	if (waveForm->rotMode)
+	{
+		// Absolute position:
+		rot = waveForm->rotAbsValue;
+	}
+	else
+	{
+		// Differential rotation
+		rotRate = waveForm->rotDiffValue;
+	}
+	return rotRate;
+} // end getRotationRate()
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// step()
+// Persistence: fade the raster and draw only the segments captured since the
+// last frame into it. Runs outside of the nanovg frame (like FramebufferWidget).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void multiScopeDisplay::step()
+{
+	TransparentWidget::step();
+	if (module == NULL || !module->initialized || module->persistence <= 0 || persistVg == NULL)
+	{
+		if (persistFb)
+		{
+			// Off: free the raster
+			nvgluDeleteFramebuffer(persistFb);
+			persistFb = NULL;
+		}
+		return;
+	}
+	TSWaveform* waveForm = module->waveForms[wIx];
+	float valuesX[BUFFER_SIZE];
+	float valuesY[BUFFER_SIZE];
+	bool penOn[BUFFER_SIZE];
+	bool newCapture = getValues(valuesX, valuesY, penOn);
+
+	// What is new since the last frame (in display order)
+	int firstIx = 0;
+	int numPoints = 0;
+	uint32_t sampleCount = waveForm->sampleCount;
+	if (!waveForm->lissajous && waveForm->triggerMode != TSWaveform::TriggerOff)
+	{
+		// Triggered: a whole new capture
+		if (newCapture)
+			numPoints = BUFFER_SIZE;
+	}
+	else
+	{
+		uint32_t numNew = sampleCount - persistSampleCount;
+		if (waveForm->lissajous)
+		{
+			// Newest are at the end
+			numPoints = (numNew < BUFFER_SIZE) ? (int)numNew : BUFFER_SIZE;
+			firstIx = BUFFER_SIZE - numPoints;
+		}
+		else
+		{
+			// Sweep in progress: up to the buffer index (anything before a restart is gone)
+			int endIx = clamp(waveForm->bufferIndex, 0, BUFFER_SIZE);
+			numPoints = (numNew < (uint32_t)endIx) ? (int)numNew : endIx;
+			firstIx = endIx - numPoints;
+		}
+		if (numPoints > 0 && firstIx > 0)
+		{
+			// Join to the last point we drew
+			firstIx--;
+			numPoints++;
+		}
+	}
+	persistSampleCount = sampleCount;
+
+	// Raster at screen resolution
+	int width = (int)ceilf(box.size.x * persistScale);
+	int height = (int)ceilf(box.size.y * persistScale);
+	if (width < 1 || height < 1)
+		return;
+	bool clearRaster = false;
+	if (persistFb == NULL || width != persistFbWidth || height != persistFbHeight)
+	{
+		if (persistFb)
+			nvgluDeleteFramebuffer(persistFb);
+		persistFb = nvgluCreateFramebuffer(persistVg, width, height, 0);
+		if (persistFb == NULL)
+			return;
+		persistFbWidth = width;
+		persistFbHeight = height;
+		clearRaster = true;
+	}
+	nvgluBindFramebuffer(persistFb);
+	glViewport(0, 0, width, height);
+	if (clearRaster)
+	{
+		glClearColor(0.0, 0.0, 0.0, 0.0);
+		glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	}
+	else
+	{
+		// 1. Fade what is there
+		nvgBeginFrame(persistVg, box.size.x, box.size.y, persistScale);
+		nvgBeginPath(persistVg);
+		nvgRect(persistVg, 0, 0, box.size.x, box.size.y);
+		nvgFillColor(persistVg, nvgRGBAf(0, 0, 0, SCOPE_PERSISTENCE_FADE[clamp(module->persistence, 0, TROWA_SCOPE_NUM_PERSISTENCE - 1)]));
+		nvgGlobalCompositeOperation(persistVg, NVG_DESTINATION_OUT);
+		nvgFill(persistVg);
+		nvgEndFrame(persistVg);
+		// 2. Subtract a little so faint trails actually reach 0
+		glBlendEquation(GL_FUNC_REVERSE_SUBTRACT);
+		nvgBeginFrame(persistVg, box.size.x, box.size.y, persistScale);
+		nvgBeginPath(persistVg);
+		nvgRect(persistVg, 0, 0, box.size.x, box.size.y);
+		nvgFillColor(persistVg, nvgRGBAf(1, 1, 1, TROWA_SCOPE_PERSISTENCE_FLOOR));
+		nvgGlobalCompositeBlendFunc(persistVg, NVG_ONE, NVG_ONE);
+		nvgFill(persistVg);
+		nvgEndFrame(persistVg);
+		glBlendEquation(GL_FUNC_ADD);
+	}
+
+	// 3. Draw the new segments
+	float rotRate = getRotationRate();
+	bool drawX = (waveForm->lissajous) ? (module->inputs[multiScope::X_INPUT + wIx].isConnected() || module->inputs[multiScope::Y_INPUT + wIx].isConnected())
+		: module->inputs[multiScope::X_INPUT + wIx].isConnected();
+	bool drawY = !waveForm->lissajous && module->inputs[multiScope::Y_INPUT + wIx].isConnected();
+	if (numPoints > 0 && (drawX || drawY))
+	{
+		NVGcolor waveColor = waveForm->waveColor;
+		waveColor.a = waveForm->waveOpacity;
+		if (waveForm->negativeImage)
+			waveColor = ColorInvertToNegative(waveColor);
+		DrawArgs fbArgs;
+		fbArgs.vg = persistVg;
+		fbArgs.clipBox = box.zeroPos();
+		fbArgs.fb = persistFb;
+		nvgBeginFrame(persistVg, box.size.x, box.size.y, persistScale);
+		if (waveForm->lissajous)
+		{
+			drawWaveform(fbArgs, valuesX, valuesY, penOn, rotRate, waveForm->lineThickness, waveColor, false, waveForm->fillColor, NVG_SOURCE_OVER, false, false, firstIx, numPoints);
+		}
+		else
+		{
+			if (drawY)
+				drawWaveform(fbArgs, valuesY, NULL, penOn, rotRate, waveForm->lineThickness, waveColor, false, waveForm->fillColor, NVG_SOURCE_OVER, false, false, firstIx, numPoints);
+			if (drawX)
+				drawWaveform(fbArgs, valuesX, NULL, penOn, rotRate, waveForm->lineThickness, waveColor, false, waveForm->fillColor, NVG_SOURCE_OVER, false, false, firstIx, numPoints);
+		}
+		nvgEndFrame(persistVg);
+	}
+	else
+	{
+		// Keep spinning
+		rot += rotRate;
+	}
+	nvgluBindFramebuffer(NULL);
+	return;
+} // end step()
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// draw()
+// Draw the trace (or with persistence, the raster).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void multiScopeDisplay::draw(const DrawArgs &args)
+{
+	if (module == NULL || !module->initialized)
+		return;
+	TSWaveform* waveForm = module->waveForms[wIx];
+	if (module->persistence > 0)
+	{
+		// Persistence: step() keeps the raster, we just put it on screen.
+		// Remember the context and the screen scale for the next step().
+		float t[6];
+		nvgCurrentTransform(args.vg, t);
+		persistScale = t[0] * APP->window->pixelRatio;
+		if (persistVg != args.vg && persistFb)
+		{
+			nvgluDeleteFramebuffer(persistFb);
+			persistFb = NULL;
+		}
+		persistVg = args.vg;
+		if (persistFb)
+		{
+			nvgSave(args.vg);
+			nvgGlobalCompositeOperation(args.vg, SCOPE_GLOBAL_EFFECTS[waveForm->gEffectIx]->compositeOperation);
+			nvgBeginPath(args.vg);
+			nvgRect(args.vg, 0, 0, box.size.x, box.size.y);
+			nvgFillPaint(args.vg, nvgImagePattern(args.vg, 0, 0, box.size.x, box.size.y, 0.0, persistFb->image, 1.0));
+			nvgFill(args.vg);
+			nvgRestore(args.vg);
+			nvgGlobalCompositeOperation(args.vg, NVG_SOURCE_OVER); // Restore to normal
+		}
+		return;
+	}
+
+	float valuesX[BUFFER_SIZE];
+	float valuesY[BUFFER_SIZE];
+	bool penOn[BUFFER_SIZE];
+	getValues(valuesX, valuesY, penOn);
+
+	// Draw waveforms
+	// 1. Line Color:
+	NVGcolor waveColor = waveForm->waveColor;
+	waveColor.a = waveForm->waveOpacity;
+	if (waveForm->negativeImage)
+		waveColor = ColorInvertToNegative(waveColor);
+	nvgStrokeColor(args.vg, waveColor); // Color has already been calculated by main module
+	// 2. Fill color:
+	NVGcolor fillColor = waveForm->fillColor;
+	if (waveForm->doFill)
+	{
+		fillColor.a = waveForm->fillOpacity;
+		nvgFillColor(args.vg, fillColor);
+	}
+	// 3. Rotation
+	float rotRate = getRotationRate();
+	if (waveForm->lissajous) {
+		// X x Y
+		if (module->inputs[multiScope::X_INPUT + wIx].isConnected() || module->inputs[multiScope::Y_INPUT + wIx].isConnected()) {
+			drawWaveform(args, valuesX, valuesY, penOn, rotRate, waveForm->lineThickness, waveColor, waveForm->doFill, fillColor, SCOPE_GLOBAL_EFFECTS[module->waveForms[wIx]->gEffectIx]->compositeOperation, false, false);
+		}
+	}
+	else {
+		// Y
+		if (module->inputs[multiScope::Y_INPUT + wIx].isConnected()) {
+			drawWaveform(args, valuesY, NULL, penOn, rotRate, waveForm->lineThickness, waveColor, waveForm->doFill, fillColor, SCOPE_GLOBAL_EFFECTS[module->waveForms[wIx]->gEffectIx]->compositeOperation, false, false);
+		}
+		// X
+		if (module->inputs[multiScope::X_INPUT + wIx].isConnected()) {
+			drawWaveform(args, valuesX, NULL, penOn, rotRate, waveForm->lineThickness, waveColor, waveForm->doFill, fillColor, SCOPE_GLOBAL_EFFECTS[module->waveForms[wIx]->gEffectIx]->compositeOperation, false, false);
+		}
+	}
+	return;
+} // end draw()	  
 
 #endif // end if use new scope
\ No newline at end of file
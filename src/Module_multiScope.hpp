@@ -12,6 +12,7 @@
 #include "trowaSoftUtilities.hpp"
 #include "TSColors.hpp"
 #include "TSScopeBase.hpp"
+#include "TSScopeTrace.hpp"
 
 // For now, the color picker is disabled in Apple because it will crash Rack & Eat your soul...
 // Linux & Windows seem fine though
@@ -118,6 +119,10 @@ struct multiScope : Module {
 
 	// Information about what we are plotting. In future may become dynamically allocated.
 	TSWaveform* waveForms[TROWA_SCOPE_NUM_WAVEFORMS];
+	// How closely XY (lissajous) traces follow the buffered points (TSScopeTraceQuality).
+	int xyTraceQuality = TraceQualityNormal;
+	// Persistence (phosphor) mode (index into SCOPE_PERSISTENCE_FADE, 0 is off).
+	int persistence = 0;
 
 	// Widget Values =====
 	// Widget width
@@ -148,6 +153,10 @@ struct multiScope : Module {
 		json_t* gEffectsIxJ = json_array();
 		json_t* waveColorJ = json_array();
 		json_t* waveFillColorJ = json_array();
+		json_t* trigModeJ = json_array();
+		json_t* trigOnXJ = json_array();
+		json_t* trigFallingJ = json_array();
+		json_t* trigPreJ = json_array();
 		//json_t* waveDoFillJ = json_array();
 		for (int wIx = 0; wIx < TROWA_SCOPE_NUM_WAVEFORMS; wIx++)
 		{
@@ -159,6 +168,10 @@ struct multiScope : Module {
 			json_array_append_new(fillHuesJ, json_real(waveForms[wIx]->fillHue));
 			json_array_append_new(fillOnJ, json_integer(waveForms[wIx]->doFill));
 			json_array_append_new(gEffectsIxJ, json_integer((int)waveForms[wIx]->gEffectIx));
+			json_array_append_new(trigModeJ, json_integer(waveForms[wIx]->triggerMode));
+			json_array_append_new(trigOnXJ, json_integer((int)waveForms[wIx]->triggerOnX));
+			json_array_append_new(trigFallingJ, json_integer((int)waveForms[wIx]->triggerFalling));
+			json_array_append_new(trigPreJ, json_integer(waveForms[wIx]->triggerPrePercent));
 
 			// itemJ = json_integer((int)waveForms[wIx]->doFill);
 			// json_array_append_new(waveDoFillJ, itemJ);
@@ -182,6 +195,10 @@ struct multiScope : Module {
 		json_object_set_new(rootJ, "gEffectsIx", gEffectsIxJ);
 		json_object_set_new(rootJ, "waveColor", waveColorJ);
 		json_object_set_new(rootJ, "waveFillColor", waveFillColorJ);
+		json_object_set_new(rootJ, "trigMode", trigModeJ);
+		json_object_set_new(rootJ, "trigOnX", trigOnXJ);
+		json_object_set_new(rootJ, "trigFalling", trigFallingJ);
+		json_object_set_new(rootJ, "trigPre", trigPreJ);
 		//json_object_set_new(rootJ, "waveDoFill", waveDoFillJ);
 
 		// Background color:
@@ -191,6 +208,8 @@ struct multiScope : Module {
 			json_array_append_new(bgColorJ, json_real(plotBackgroundColor.rgba[i]));
 		}
 		json_object_set_new(rootJ, "bgColor", bgColorJ);
+		json_object_set_new(rootJ, "xyQuality", json_integer(xyTraceQuality));
+		json_object_set_new(rootJ, "persistence", json_integer(persistence));
 //DEBUG("background color saved to json (rgb): %0.2f, %0.2f, %0.2f", plotBackgroundColor.r, plotBackgroundColor.g, plotBackgroundColor.b);
 		
 		// Widget values (v1 - Widgets do not get json saves
@@ -214,6 +233,10 @@ struct multiScope : Module {
 		json_t* fillOnJ = json_object_get(rootJ, "fillOn");
 		json_t* waveColorJ = json_object_get(rootJ, "waveColor");
 		json_t* waveFillColorJ = json_object_get(rootJ, "waveFillColor");
+		json_t* trigModeJ = json_object_get(rootJ, "trigMode");
+		json_t* trigOnXJ = json_object_get(rootJ, "trigOnX");
+		json_t* trigFallingJ = json_object_get(rootJ, "trigFalling");
+		json_t* trigPreJ = json_object_get(rootJ, "trigPre");
 		// json_t* waveDoFillJ = json_object_get(rootJ, "waveDoFill");
 
 		for (int wIx = 0; wIx < TROWA_SCOPE_NUM_WAVEFORMS; wIx++)
@@ -249,6 +272,27 @@ struct multiScope : Module {
 			if (itemJ)
 				waveForms[wIx]->gEffectIx = (int)clamp((int)json_integer_value(itemJ), 0, TROWA_SCOPE_NUM_EFFECTS - 1);
 			itemJ = NULL;
+			if (trigModeJ)
+			{
+				itemJ = json_array_get(trigModeJ, wIx);
+				if (itemJ)
+					waveForms[wIx]->triggerMode = clamp((int)json_integer_value(itemJ), 0, TSWaveform::NUM_TRIGGER_MODES - 1);
+				itemJ = json_array_get(trigOnXJ, wIx);
+				if (itemJ)
+					waveForms[wIx]->triggerOnX = (bool)json_integer_value(itemJ);
+				itemJ = json_array_get(trigFallingJ, wIx);
+				if (itemJ)
+					waveForms[wIx]->triggerFalling = (bool)json_integer_value(itemJ);
+				itemJ = json_array_get(trigPreJ, wIx);
+				if (itemJ)
+					waveForms[wIx]->triggerPrePercent = clamp((int)json_integer_value(itemJ), 0, TROWA_SCOPE_TRIG_PRE_MAX);
+				itemJ = NULL;
+			}
+			else
+			{
+				// Older patch: the trigger param was an unused time knob, start at the default level
+				params[TRIG_PARAM + wIx].setValue(TROWA_SCOPE_TRIG_LEVEL_DEF);
+			}
 
 			// itemJ = json_array_get(waveDoFillJ, wIx);
 			// if (itemJ)
@@ -283,6 +327,12 @@ struct multiScope : Module {
 		}
 		//INFO("BG COLOR loaded from json (rgb): %0.2f, %0.2f, %0.2f", plotBackgroundColor.r, plotBackgroundColor.g, plotBackgroundColor.b);
 		plotBackgroundColor.a = 1.0f;
+		json_t* xyQualityJ = json_object_get(rootJ, "xyQuality");
+		if (xyQualityJ)
+			xyTraceQuality = clamp((int)json_integer_value(xyQualityJ), 0, TRACE_NUM_QUALITIES - 1);
+		json_t* persistenceJ = json_object_get(rootJ, "persistence");
+		if (persistenceJ)
+			persistence = clamp((int)json_integer_value(persistenceJ), 0, TROWA_SCOPE_NUM_PERSISTENCE - 1);
 		
 		// Widget values (v1 - Widgets do not get json saves)
 		json_t* widgetJ = json_object_get(rootJ, "widget");
@@ -301,7 +351,13 @@ struct multiScope : Module {
 			waveForms[wIx]->linkXYScales = false; // Added
 			waveForms[wIx]->rotMode = false; // Added
 			waveForms[wIx]->lissajous = true;
+			waveForms[wIx]->triggerMode = TSWaveform::TriggerOff;
+			waveForms[wIx]->triggerOnX = false;
+			waveForms[wIx]->triggerFalling = false;
+			waveForms[wIx]->triggerPrePercent = TROWA_SCOPE_TRIG_PRE_DEF;
 		}
+		xyTraceQuality = TraceQualityNormal;
+		persistence = 0;
 	}
 };
 
@@ -496,11 +552,35 @@ struct multiScopeDisplay : TransparentWidget {
 	float rot = 0;
 	std::shared_ptr<Font> font;
 	int wIx = 0; // Waveform index
+	// Screen points of the trace being drawn.
+	TSScopeTracePath tracePath;
+	// Last triggered capture taken from the module.
+	float captureX[BUFFER_SIZE] = {};
+	float captureY[BUFFER_SIZE] = {};
+	bool capturePenOn[BUFFER_SIZE] = {};
+	// Persistence (phosphor) raster ::::::::::::::::::::::::::::::::::::::
+	// Offscreen image the new segments are drawn into (NULL if persistence is off).
+	NVGLUframebuffer* persistFb = NULL;
+	// Size of the raster [px].
+	int persistFbWidth = 0;
+	int persistFbHeight = 0;
+	// Raster pixels per widget unit (zoom * window pixel ratio), from the last draw().
+	float persistScale = 1.0f;
+	// Waveform sample count already in the raster.
+	uint32_t persistSampleCount = 0;
+	// Context the raster belongs to (the one we are drawn with).
+	NVGcontext* persistVg = NULL;
 	
 	multiScopeDisplay() {
 		//spoutInitSpout();
 		return;
 	}
+	~multiScopeDisplay() {
+		if (persistFb)
+			nvgluDeleteFramebuffer(persistFb);
+		persistFb = NULL;
+		return;
+	}
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// drawWaveform()
 	// @args.vg : (IN) NVGcontext
@@ -511,86 +591,46 @@ struct multiScopeDisplay : TransparentWidget {
 	// @compositeOp: (IN) Some global effect if any
 	// @flipX: (IN) Flip along x (at x=0)
 	// @flipY: (IN) Flip along y
+	// @firstIx: (IN) First point to draw.
+	// @numPoints: (IN) Number of points to draw.
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	void drawWaveform(const DrawArgs &args, float *valX, float *valY, bool* penOn,
 		float rotRate, float lineThickness, NVGcolor lineColor,
 		bool doFill, NVGcolor fillColor,
-		NVGcompositeOperation compositeOp, bool flipX, bool flipY);
-
-
-	void draw(const DrawArgs &args) override {
-		if (module == NULL || !module->initialized)
-			return;
-		float gainX = ((int)(module->params[multiScope::X_SCALE_PARAM + wIx].getValue() * TROWA_SCOPE_ROUND_VALUE)) / (float)(TROWA_SCOPE_ROUND_VALUE);
-		float gainY = ((int)(module->params[multiScope::Y_SCALE_PARAM + wIx].getValue() * TROWA_SCOPE_ROUND_VALUE)) / (float)(TROWA_SCOPE_ROUND_VALUE);
-		float offsetX = ((int)(module->params[multiScope::X_POS_PARAM + wIx].getValue() * TROWA_SCOPE_ROUND_VALUE)) / (float)(TROWA_SCOPE_ROUND_VALUE);
-		float offsetY = ((int)(module->params[multiScope::Y_POS_PARAM + wIx].getValue() * TROWA_SCOPE_ROUND_VALUE)) / (float)(TROWA_SCOPE_ROUND_VALUE);
-
-		TSWaveform* waveForm = module->waveForms[wIx];
-		float valuesX[BUFFER_SIZE];
-		float valuesY[BUFFER_SIZE];
-		bool penOn[BUFFER_SIZE];
-		float multX = gainX / 10.0;
-		float multY = gainY / 10.0;
-		for (int i = 0; i < BUFFER_SIZE; i++) {
-			int j = i;
-			// Lock display to buffer if buffer update deltaTime <= 2^-11
-			if (waveForm->lissajous)
-				j = (i + waveForm->bufferIndex) % BUFFER_SIZE;
-			valuesX[i] = (waveForm->bufferX[j] + offsetX) * multX;
-			valuesY[i] = (waveForm->bufferY[j] + offsetY) * multY;
-			penOn[i] = waveForm->bufferPenOn[j];
-		}
-
-		// Draw waveforms
-		// 1. Line Color:
-		NVGcolor waveColor = waveForm->waveColor;
-		waveColor.a = waveForm->waveOpacity;
-		if (waveForm->negativeImage)
-			waveColor = ColorInvertToNegative(waveColor);
-		nvgStrokeColor(args.vg, waveColor); // Color has already been calculated by main module
-		// 2. Fill color:
-		NVGcolor fillColor = waveForm->fillColor;
-		if (waveForm->doFill)
-		{
-			fillColor.a = waveForm->fillOpacity;
-			nvgFillColor(args.vg, fillColor);
-		}
-		// 3. Rotation
-		float rotRate = 0;
-		if (waveForm->rotMode)
-		{
-			// Absolute position:
-			rot = waveForm->rotAbsValue;
-		}
-		else
-		{
-			// Differential rotation
-			rotRate = waveForm->rotDiffValue;
-		}
-		if (waveForm->lissajous) {
-			// X x Y
-			if (module->inputs[multiScope::X_INPUT + wIx].isConnected() || module->inputs[multiScope::Y_INPUT + wIx].isConnected()) {
-				drawWaveform(args, valuesX, valuesY, penOn, rotRate, waveForm->lineThickness, waveColor, waveForm->doFill, fillColor, SCOPE_GLOBAL_EFFECTS[module->waveForms[wIx]->gEffectIx]->compositeOperation, false, false);
-			}
-		}
-		else {
-			// Y
-			if (module->inputs[multiScope::Y_INPUT + wIx].isConnected()) {
-				drawWaveform(args, valuesY, NULL, penOn, rotRate, waveForm->lineThickness, waveColor, waveForm->doFill, fillColor, SCOPE_GLOBAL_EFFECTS[module->waveForms[wIx]->gEffectIx]->compositeOperation, false, false);
-			}
-			// X
-			if (module->inputs[multiScope::X_INPUT + wIx].isConnected()) {
-				drawWaveform(args, valuesX, NULL, penOn, rotRate, waveForm->lineThickness, waveColor, waveForm->doFill, fillColor, SCOPE_GLOBAL_EFFECTS[module->waveForms[wIx]->gEffectIx]->compositeOperation, false, false);
-			}
-		}
-		return;
-	} // end draw()
+		NVGcompositeOperation compositeOp, bool flipX, bool flipY,
+		int firstIx = 0, int numPoints = BUFFER_SIZE);
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// getValues()
+	// Offset/scaled values to draw (oldest first). Takes a new triggered capture
+	// from the module if there is one.
+	// @valuesX : (OUT) X values (BUFFER_SIZE).
+	// @valuesY : (OUT) Y values (BUFFER_SIZE).
+	// @penOn : (OUT) Pen on (BUFFER_SIZE).
+	// @returns : True if a new triggered capture was taken.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	bool getValues(float* valuesX, float* valuesY, bool* penOn);
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// getRotationRate()
+	// Sets the absolute rotation (if ABS is on).
+	// @returns : The rotation rate (0 if ABS is on).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	float getRotationRate();
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// step()
+	// Persistence: fade the raster and draw the segments captured since last frame
+	// into it (outside of the nanovg frame, like FramebufferWidget).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void step() override;
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// draw()
+	// Draw the trace (or with persistence, the raster).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void draw(const DrawArgs &args) override;
 }; // end multiScopeDisplay
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // TSScopeLabelArea
-// Draw labels on our scope.
+// Draw labels on our scope (static, drawn in a cached layer).
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 struct TSScopeLabelArea : TransparentWidget {
 	multiScope *module;
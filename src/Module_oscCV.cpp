@@ -1,4 +1,5 @@
 #include "Module_oscCV.hpp"
+#include "TSRealTimeCheck.hpp"
 #include <rack.hpp>
 using namespace rack;
 #include "TSOSCCV_Common.hpp"
@@ -36,10 +37,16 @@ oscCV::oscCV(int numChannels, bool cv2osc, bool osc2cv) // : Module(NUM_PARAMS +
 	}
 	if (doOSC2CVPort)
 	{
-		outputChannels = new TSOSCCVChannel[numberChannels];
+		outputChannels = new TSOSCCVOutputChannel[numberChannels];
 		pulseGens = new dsp::PulseGenerator[numberChannels];
 	}
 	initialChannels();
+	onSampleRateChange();
+	// The input expanders pass us their messages (they send to our left side).
+	leftExpander.producerMessage = &(expTxMessages[0]);
+	leftExpander.consumerMessage = &(expTxMessages[1]);
+	// The audio thread copies the namespace here, so make sure it never has to grow.
+	txNamespace.reserve(TROWA_OSCCV_MSG_ADDRESS_SIZE);
 	
 	// Configure parameters:
 	// id, min, max, def
@@ -96,6 +103,22 @@ oscCV::~oscCV()
 	return;
 } // end destructor
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// onSampleRateChange()
+// Recalculate the value history decimation.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void oscCV::onSampleRateChange()
+{
+	float sampleRate = APP->engine->getSampleRate();
+	for (int c = 0; c < numberChannels; c++)
+	{
+		if (inputChannels != NULL)
+			inputChannels[c].valHistory.setSampleRate(sampleRate);
+		if (outputChannels != NULL)
+			outputChannels[c].valHistory.setSampleRate(sampleRate);
+	}
+	return;
+} // end onSampleRateChange()
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // reset(void)
 // Initialize values.
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -112,12 +135,17 @@ void oscCV::onReset() {
 	this->currentOSCSettings.oscTxIpAddress = OSC_ADDRESS_DEF;
 	this->currentOSCSettings.oscTxPort = OSC_OUTPORT_DEF;
 	this->currentOSCSettings.oscRxPort = OSC_INPORT_DEF;
+	this->currentOSCSettings.multicastTtl = OSC_MULTICAST_TTL_DEF;
+	this->currentOSCSettings.multicastLoopback = true;
+	this->currentOSCSettings.localTransport = false;
 	oscMutex.unlock();
 
 	this->oscShowConfigurationScreen = false;
 
 	sendDt = 0.0f;
 	sendFrequency_Hz = TROWA_OSCCV_DEFAULT_SEND_HZ;
+	rxScheduler.jitterBuffer_ms = 0.0f;
+	rxScheduler.reset();
 	return;
 } // end reset()
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -160,20 +188,28 @@ void oscCV::initOSC(const char* ipAddress, int outputPort, int inputPort)
 			}
 			if (doCVPort2OSC) {
 				// CV Port -> OSC Tx
-				if (oscTxSocket == NULL)
+				if (oscTxQueue == NULL)
 				{
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
-					DEBUG("oscCV::initOSC() - Create TRANS socket at %s, port %d.", ipAddress, outputPort);
+					DEBUG("oscCV::initOSC() - Register with shared transmitter at %s, port %d.", ipAddress, outputPort);
 #endif
-					oscTxSocket = new UdpTransmitSocket(IpEndpointName(ipAddress, outputPort));
+#if TROWA_OSC_LOCAL_TRANSPORT
+					if (currentOSCSettings.localTransport)
+						oscTxQueue = TSOSCTxService::RegisterLocalSender(outputPort);
+					else
+#endif
+					oscTxQueue = TSOSCTxService::RegisterSender(ipAddress, outputPort, currentOSCSettings.multicastTtl, currentOSCSettings.multicastLoopback);
 					this->currentOSCSettings.oscTxPort = outputPort;
+					if (oscTxQueue == NULL)
+						oscError = true;
 				}
 			}
-			oscInitialized = true;			
-			if (doOSC2CVPort) 
+			oscInitialized = !oscError;
+			if (doOSC2CVPort && oscInitialized) 
 			{
-				// OSC Rx -> CV Port
-				oscInitialized = OscCVRxConnector::StartListener(inputPort, this);
+				// OSC Rx -> CV Port (if the address is a multicast group, join it on the Rx port, or listen on the local socket)
+				oscLocalConnected = TROWA_OSC_LOCAL_TRANSPORT && currentOSCSettings.localTransport;
+				oscInitialized = OscCVRxConnector::StartListener(inputPort, this, ipAddress, oscLocalConnected);
 				this->currentOSCSettings.oscRxPort = inputPort;
 			}
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
@@ -217,17 +253,17 @@ void oscCV::cleanupOSC()
 #endif
 		if (doOSC2CVPort)
 		{
-			OscCVRxConnector::StopListener(currentOSCSettings.oscRxPort, this);
+			OscCVRxConnector::StopListener(currentOSCSettings.oscRxPort, this, currentOSCSettings.oscTxIpAddress.c_str(), oscLocalConnected);
 		}
 
 
-		if (oscTxSocket != NULL)
+		if (oscTxQueue != NULL)
 		{
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
-			DEBUG("oscCV::cleanupOSC() - Cleanup TRANS socket.");
+			DEBUG("oscCV::cleanupOSC() - Unregister from shared transmitter.");
 #endif
-			delete oscTxSocket;
-			oscTxSocket = NULL;
+			TSOSCTxService::UnregisterSender(oscTxQueue);
+			oscTxQueue = NULL;
 		}
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
 		DEBUG("oscCV::cleanupOSC() - OSC cleaned");
@@ -257,7 +293,12 @@ json_t *oscCV::dataToJson() {
 	json_object_set_new(oscJ, "IpAddress", json_string(this->currentOSCSettings.oscTxIpAddress.c_str()));
 	json_object_set_new(oscJ, "TxPort", json_integer(this->currentOSCSettings.oscTxPort));
 	json_object_set_new(oscJ, "RxPort", json_integer(this->currentOSCSettings.oscRxPort));
+	json_object_set_new(oscJ, "MulticastTtl", json_integer(this->currentOSCSettings.multicastTtl));
+	json_object_set_new(oscJ, "MulticastLoopback", json_boolean(this->currentOSCSettings.multicastLoopback));
+	json_object_set_new(oscJ, "LocalTransport", json_boolean(this->currentOSCSettings.localTransport));
 	json_object_set_new(oscJ, "Namespace", json_string(this->oscNamespace.c_str()));
+	json_object_set_new(oscJ, "MaxPacketSize", json_integer(this->oscMaxPacketSize));
+	json_object_set_new(oscJ, "RxJitterBufferMs", json_real(this->rxScheduler.jitterBuffer_ms));
 	json_object_set_new(oscJ, "AutoReconnectAtLoad", json_boolean(oscReconnectAtLoad)); // [v11, v0.6.3]
 	json_object_set_new(oscJ, "Initialized", json_boolean(oscInitialized)); // [v11, v0.6.3] We know the settings are good at least at the time of save
 	json_object_set_new(rootJ, "osc", oscJ);
@@ -298,9 +339,24 @@ void oscCV::dataFromJson(json_t *rootJ) {
 		currJ = json_object_get(oscJ, "RxPort");
 		if (currJ)
 			this->currentOSCSettings.oscRxPort = (uint16_t)(json_integer_value(currJ));
+		currJ = json_object_get(oscJ, "MulticastTtl");
+		if (currJ)
+			this->currentOSCSettings.multicastTtl = (uint8_t)clamp(static_cast<int>(json_integer_value(currJ)), 1, OSC_MULTICAST_TTL_MAX);
+		currJ = json_object_get(oscJ, "MulticastLoopback");
+		if (currJ)
+			this->currentOSCSettings.multicastLoopback = json_is_true(currJ);
+		currJ = json_object_get(oscJ, "LocalTransport");
+		if (currJ)
+			this->currentOSCSettings.localTransport = json_is_true(currJ) && TROWA_OSC_LOCAL_TRANSPORT;
 		currJ = json_object_get(oscJ, "Namespace");
 		if (currJ)
 			setOscNamespace( json_string_value(currJ) );
+		currJ = json_object_get(oscJ, "MaxPacketSize");
+		if (currJ)
+			this->oscMaxPacketSize = clamp(static_cast<int>(json_integer_value(currJ)), 0, OSC_CV_OUTPUT_BUFFER_SIZE);
+		currJ = json_object_get(oscJ, "RxJitterBufferMs");
+		if (currJ)
+			this->rxScheduler.jitterBuffer_ms = clamp(static_cast<float>(json_number_value(currJ)), 0.0f, TROWA_OSCCV_MAX_JITTER_BUFFER_MS);
 		currJ = json_object_get(oscJ, "AutoReconnectAtLoad");
 		if (currJ)
 			oscReconnectAtLoad = json_boolean_value(currJ);
@@ -361,31 +417,51 @@ void oscCV::dataFromJson(json_t *rootJ) {
 } // end dataFromJson() 
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
-// process()
-// [Previously step(void)]
+// processOSCAction()
+// [UI thread] Enable/disable OSC if requested (oscCurrentAction).
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
-void oscCV::process(const ProcessArgs &args)
+void oscCV::processOSCAction()
 {
-	//bool oscStarted = false; // If OSC just started to a new address this step.
-	switch (this->oscCurrentAction)
+	OSCAction action = this->oscCurrentAction;
+	this->oscCurrentAction = OSCAction::None;
+	switch (action)
 	{
 	case OSCAction::Disable:
 		this->cleanupOSC(); // Try to clean up OSC
 		break;
 	case OSCAction::Enable:
-		this->cleanupOSC(); // Try to clean up OSC if we already have something		
+		this->cleanupOSC(); // Try to clean up OSC if we already have something
 		this->initOSC(this->oscNewSettings.oscTxIpAddress.c_str(), this->oscNewSettings.oscTxPort, this->oscNewSettings.oscRxPort);
-		//oscStarted = this->oscInitialized;
 		break;
 	case OSCAction::None:
 	default:
 		break;
 	}
-	this->oscCurrentAction = OSCAction::None;
-	
+	return;
+} // end processOSCAction()
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// process()
+// [Previously step(void)]
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void oscCV::process(const ProcessArgs &args)
+{
+	TS_RT_CHECK_SCOPE("oscCV");
+	// OSC is connected/disconnected on the UI thread (processOSCAction()).
+
+	// Expanders (only walked again if the chains changed)
+	bool inputChainChanged = expInputChain.update(this, /*left*/ true, modelOscCVExpanderInput);
+	bool outputChainChanged = expOutputChain.update(this, /*left*/ false, modelOscCVExpanderOutput);
+	if ((inputChainChanged || outputChainChanged) && expCurrentEditExpanderIx != 0)
+	{
+		// Don't hold on to an expander that may be gone
+		expCurrentEditExpander = getCachedExpansionModule(expCurrentEditExpanderIx);
+		if (expCurrentEditExpander == NULL)
+			expCurrentEditExpanderIx = 0;
+	}
 	// Handle inputs:
-	int numExpandersLeft = getNumExpansionModulesInput();
-	int numExpandersRight = getNumExpansionModulesOutput();
+	int numExpandersLeft = expInputChain.length;
+	int numExpandersRight = expOutputChain.length;
 	// 1. Main configuration button:
 	if (this->oscConfigTrigger.process(this->params[oscCV::ParamIds::OSC_SHOW_CONF_PARAM].getValue()))
 	{
@@ -402,7 +478,7 @@ void oscCV::process(const ProcessArgs &args)
 	{
 		// Previous button hit
 		expCurrentEditExpanderIx--;
-		expCurrentEditExpander = getExpansionModule(expCurrentEditExpanderIx);
+		expCurrentEditExpander = getCachedExpansionModule(expCurrentEditExpanderIx);
 		if (expCurrentEditExpander)
 		{
 			this->oscShowConfigurationScreen = true;
@@ -412,7 +488,7 @@ void oscCV::process(const ProcessArgs &args)
 			if (expCurrentEditExpanderIx < 0)
 			{
 				expCurrentEditExpanderIx = -numExpandersLeft; // Last one
-				expCurrentEditExpander = getExpansionModule(expCurrentEditExpanderIx);				
+				expCurrentEditExpander = getCachedExpansionModule(expCurrentEditExpanderIx);				
 			}
 			else
 			{
@@ -426,7 +502,7 @@ void oscCV::process(const ProcessArgs &args)
 	{
 		// Previous button hit
 		expCurrentEditExpanderIx++;
-		expCurrentEditExpander = getExpansionModule(expCurrentEditExpanderIx);
+		expCurrentEditExpander = getCachedExpansionModule(expCurrentEditExpanderIx);
 		if (expCurrentEditExpander)
 		{
 			this->oscShowConfigurationScreen = true;
@@ -436,7 +512,7 @@ void oscCV::process(const ProcessArgs &args)
 			if (expCurrentEditExpanderIx > 0)
 			{
 				expCurrentEditExpanderIx = numExpandersRight; // Last one
-				expCurrentEditExpander = getExpansionModule(expCurrentEditExpanderIx);				
+				expCurrentEditExpander = getCachedExpansionModule(expCurrentEditExpanderIx);				
 			}
 			else
 			{
@@ -479,9 +555,18 @@ void oscCV::process(const ProcessArgs &args)
 		//------------------------------------------------------------
 		// Look for inputs from Rack --> Send Out OSC
 		//------------------------------------------------------------
-		bool packetOpened = false;
-		osc::OutboundPacketStream oscStream(oscBuffer, OSC_CV_OUTPUT_BUFFER_SIZE);
-		char addressBuffer[512];
+		// Only re-read the namespace (locks) if it has changed. Channels rebuild their pre-encoded messages when this changes.
+		uint32_t nsVersion = oscNamespaceVersion;
+		if (nsVersion != txNamespaceVersion && oscMutex.try_lock())
+		{
+			txNamespace.assign(oscNamespace, 0, TROWA_OSCCV_MSG_ADDRESS_SIZE - 1); // Capacity is reserved in the constructor (no allocation here)
+			txNamespaceVersion = nsVersion;
+			oscMutex.unlock();
+		}
+		oscTxBundle.buffer = oscBuffer;
+		oscTxBundle.capacity = (oscBuffer != NULL) ? OSC_CV_OUTPUT_BUFFER_SIZE : 0;
+		oscTxBundle.maxPacketSize = oscMaxPacketSize;
+		oscTxBundle.clear();
 		// ### Our own channels ###
 		for (int c = 0; c < this->numberChannels; c++)
 		{			
@@ -511,126 +596,79 @@ void oscCV::process(const ProcessArgs &args)
 				} // end if trigger is active
 				else
 				{
-					// See if value has changed enough 
-					if (!inputChannels[c].doSend) {
-						// Only send if changed enough. Maybe about 0.01 V? Defined on channel.
-						// 1. Check for change:
-						sendVal = inputChannels[c].valChanged();
-						// 2. Mark channel as needing to output
-						if (sendVal) {
-							inputChannels[c].doSend = true;
-						}
-					}
-					// 3. Check if it is time to send out
-					sendVal = sendTime && inputChannels[c].doSend;
+					// See if value has changed enough (channel deadband) and if it is time to send (send tick, channel rate / significant change policy)
+					sendVal = inputChannels[c].checkSend(sendTime, args.sampleTime);
 				} // end else check if value has changed enough
 				
 				if (sendVal)
 				{
-					lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL].value = 1.0f;
-					oscMutex.lock();
-					try
-					{
-						if (!packetOpened)
-						{
-							oscStream << osc::BeginBundleImmediate;
-							packetOpened = true;
-						}
-						if (oscNamespace.empty()) // Allow empty namespaces
-						{
-							sprintf(addressBuffer, "%s", inputChannels[c].getPath().c_str());														
-						}
-						else
-						{
-							sprintf(addressBuffer, "/%s%s", oscNamespace.c_str(), inputChannels[c].getPath().c_str());							
-						}
-						oscStream << osc::BeginMessage(addressBuffer);
-						
-						for (int j = 0; j < inputChannels[c].numVals; j++)
-						{
-							if (inputChannels[c].convertVals)
-							{
-								// Enforce Data Type:
-								switch (inputChannels[c].dataType)
-								{
-								case TSOSCCVChannel::ArgDataType::OscInt:
-									oscStream << static_cast<int>(inputChannels[c].translatedVals[j]);
-									//outVal = static_cast<float>(static_cast<int>(inputChannels[c].translatedVal[j]));
-									break;
-								case TSOSCCVChannel::ArgDataType::OscBool:
-									oscStream << static_cast<bool>(inputChannels[c].translatedVals[j]);
-									//outVal = static_cast<float>(static_cast<bool>(inputChannels[c].translatedVals[j]));
-									break;
-								case TSOSCCVChannel::ArgDataType::OscFloat:
-								default:
-									oscStream << inputChannels[c].translatedVals[j];
-									break;
-								}
-#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
-								DEBUG("SEND OSC[%d,%d]: %s %7.3f", c, j, addressBuffer, inputChannels[c].translatedVals[j]);
-#endif													
-							}
-							else
-							{
-								// Raw value out
-								oscStream << inputChannels[c].vals[j];
+					inputChannels[c].light.trigger(lightClock.frame);
+					// Pre-encoded address + type tags, just patch in the values.
+					TSOSCCVMsgTemplate* msgTemplate = inputChannels[c].getMsgTemplate(txNamespace, txNamespaceVersion);
+					if (!oscTxBundle.addMessage(msgTemplate, inputChannels[c].getSendVals()))
+						oscTxDropCount.fetch_add(1, std::memory_order_relaxed); // No room in output buffer
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
-								DEBUG("SEND OSC[%d]: %s %7.3f", c, addressBuffer, inputChannels[c].vals[j]);
-#endif													
-							}							
-						} // end loop through values.				
-						oscStream << osc::EndMessage;						
-					}
-					catch (const std::exception& e)
-					{
-						WARN("Error %s.", e.what());
-					}
-					oscMutex.unlock();
-					// Save our last sent values
-					//inputChannels[c].lastTranslatedVal = outVal;
-					//inputChannels[c].lastVal = inputChannels[c].val;
-					inputChannels[c].storeLastValues();
-					inputChannels[c].doSend = false; // Reset
+					DEBUG("SEND OSC[%d]: %s %7.3f", c, msgTemplate->header, inputChannels[c].getSendVals()[0]);
+#endif
+					// Save our last sent values and reset
+					inputChannels[c].onSent();
 				} // end if send value 
 			} // end if oscInitialied
-
-			if (lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL].value > 0 && !sendVal) {
-				lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL].value -= lightLambda;
-			}
 		} // end for loop
 		
 		// ### Expansion Modules ###		
-		// Expansion CV -> OSC:
-		try
+		// Expansion CV -> OSC: The input expanders read their own CV (in their own process()) and pass us their messages.
+		if (leftExpander.module != NULL && leftExpander.module->model == modelOscCVExpanderInput)
 		{
-			// Input
-			Expander* exp = &(this->leftExpander);
-			while (exp != NULL && exp->module && exp->module->model == modelOscCVExpanderInput)
-			{				
-				dynamic_cast<oscCVExpander*>(exp->module)->processInputs(oscNamespace, oscInitialized, sendTime, packetOpened, oscMutex, oscStream);			
-				exp = &(exp->module->leftExpander); // Go to next so we can see if that's another expander.
+			TSOSCCVExpanderTxMessage* expMessages = reinterpret_cast<TSOSCCVExpanderTxMessage*>(leftExpander.consumerMessage);
+			if (oscInitialized)
+			{
+				int nDropped = expMessages->addTo(oscTxBundle);
+				if (nDropped > 0)
+					oscTxDropCount.fetch_add(nDropped, std::memory_order_relaxed); // No room in output buffer
 			}
-		}
-		catch (const std::exception& expansionEx)
-		{
-			WARN("Error with Expansion Module Input: %s.", expansionEx.what());
+			expMessages->clear(); // Don't send them again if the expander stops sending
+			// Our state for the input expanders (passed down the chain)
+			expState.oscInitialized = oscInitialized;
+			expState.sendTime = sendTime;
+			if (expState.nsVersion != txNamespaceVersion)
+			{
+				expState.nsVersion = txNamespaceVersion;
+				expState.setNamespace(txNamespace.c_str());
+			}
+			expState.sendTo(leftExpander.module->rightExpander);
 		}
 		
 		
-		if (packetOpened)
+		if (oscTxBundle.isOpen())
 		{
-			oscMutex.lock();
+			// Never block the audio thread (if the UI thread is (re)initializing OSC, drop this bundle).
+			bool oscLocked = oscMutex.try_lock();
 			try
 			{
-				oscStream << osc::EndBundle;
-				oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+				if (oscLocked && oscTxQueue != NULL)
+				{
+					// One datagram per bundle (each should fit in oscMaxPacketSize). Queue them for the Tx thread (no network I/O here).
+					for (int p = 0; p < oscTxBundle.numPackets; p++)
+					{
+						int packetSize = oscTxBundle.getPacketSize(p);
+						if (oscTxQueue->push(oscTxBundle.getPacketData(p), packetSize))
+						{
+							oscTxPacketCount++;
+							oscTxByteCount += packetSize;
+						}
+					}
+					oscTxQueue->signal();
+				}
 			}
 			catch (const std::exception& e)
 			{
 				WARN("Error %s.", e.what());
 			}
-			oscMutex.unlock();
-		} // end if packet opened (close it)
+			if (oscLocked)
+				oscMutex.unlock();
+			oscTxBundle.clear();
+		} // end if packet(s) opened (send them)
 		
 	} // end Rack Input Ports ==> OSC Output
 
@@ -642,13 +680,20 @@ void oscCV::process(const ProcessArgs &args)
 		//------------------------------------------------------------
 		// Look for OSC Rx messages --> Output to Rack
 		//------------------------------------------------------------
+		rxScheduler.step(args.sampleTime);
 		while (rxMsgQueue.size() > 0)
 		{
 			try
 			{
+#if USE_MODULE_STATIC_RX
+				TSOSCCVSimpleMessage* rxOscMsg = rxMsgQueue.front(); // Lock free
+#else
 				rxMsgMutex.lock();				
 				TSOSCCVSimpleMessage* rxOscMsg = rxMsgQueue.front();
 				rxMsgMutex.unlock();
+#endif
+				if (rxOscMsg != NULL && !rxScheduler.isDue(rxOscMsg))
+					break; // Not time yet (jitter buffer / time tag). Leave it (and anything after it) in the queue.
 				if (rxOscMsg != NULL)
 				{
 					int chIx = rxOscMsg->channelNum - 1;
@@ -659,7 +704,7 @@ void oscCV::process(const ProcessArgs &args)
 						//outputChannels[chIx].setValue(rxOscMsg.rxVal);
 						//outputChannels[chIx].setOSCInValue(rxOscMsg->rxVals);
 						outputChannels[chIx].setOSCInValue(rxOscMsg->rxVals, rxOscMsg->rxLength);							
-						lights[LightIds::CH_LIGHT_START + chIx * 2 + 1].value = 1.0f;
+						outputChannels[chIx].light.trigger(lightClock.frame);
 					} // end if valid channel
 					
 #if DEBUG_MAC_OS_POINTER			
@@ -676,47 +721,60 @@ void oscCV::process(const ProcessArgs &args)
 			{
 				WARN("Error accessing received message.\n%s", rxEx.what());
 			}
+#if USE_MODULE_STATIC_RX
+			rxMsgQueue.pop();
+#else
 			rxMsgMutex.lock();				
 			rxMsgQueue.pop();
 			rxMsgMutex.unlock();			
+#endif
 		} // end while (loop through message queue)
 		// ::: OUTPUTS :::
 		float dt = args.sampleTime; //1.0 / engineGetSampleRate();
 		for (int c = 0; c < numberChannels; c++)
 		{
+			// Latest-value channels: newest snapshot (once, however many were received)
+			if (outputChannels[c].readMailbox())
+			{
+				pulseGens[c].trigger(TROWA_PULSE_WIDTH);
+				outputChannels[c].light.trigger(lightClock.frame);
+			}
 			// Output the value first
 			// We should limit this value (-10V to +10V). Rack says nothing should be higher than +/- 12V.
 			// Polyphonic output :::::::::::::::::::::::
+			outputChannels[c].process(dt); // Smoothing (if any)
 			outputs[OutputIds::CH_OUTPUT_START + c * 2 + 1].setChannels(outputChannels[c].numVals);
 			for (int j = 0; j < outputChannels[c].numVals; j++)
 			{
-				outputs[OutputIds::CH_OUTPUT_START + c * 2 + 1].setVoltage(/*v*/clamp(outputChannels[c].translatedVals[j], TROWA_OSCCV_MIN_VOLTAGE, TROWA_OSCCV_MAX_VOLTAGE), /*channel*/ j);				
+				outputs[OutputIds::CH_OUTPUT_START + c * 2 + 1].setVoltage(/*v*/clamp(outputChannels[c].outVals[j], TROWA_OSCCV_MIN_VOLTAGE, TROWA_OSCCV_MAX_VOLTAGE), /*channel*/ j);				
 			}
-			outputChannels[c].addValToBuffer(outputChannels[c].translatedVals[0]);
+			outputChannels[c].addValToBuffer(outputChannels[c].outVals[0]);
 			
 			// Then trigger if needed.
 			bool trigger = pulseGens[c].process(dt);
 			outputs[OutputIds::CH_OUTPUT_START + c * 2].setVoltage((trigger) ? TROWA_OSCCV_TRIGGER_ON_V : TROWA_OSCCV_TRIGGER_OFF_V);
-			lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL + 1].value = clamp(lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL + 1].value - lightLambda, 0.0f, 1.0f);			
 		}
 		
 		// ### Expansion Modules ###		
-		// Expansion OSC->CV:
-		try
+		// Expansion OSC->CV: The output expanders write their own outputs (in their own process()), they just need our Rx clock.
+		if (rightExpander.module != NULL && rightExpander.module->model == modelOscCVExpanderOutput)
 		{
-			// Input
-			Module::Expander* exp = &(this->rightExpander);
-			while (exp != NULL && exp->module && exp->module->model == modelOscCVExpanderOutput)
-			{				
-				dynamic_cast<oscCVExpander*>(exp->module)->processOutputs(dt);			
-				exp = &(exp->module->rightExpander); // Go to next so we can see if that's another expander.
-			}
+			expState.oscInitialized = oscInitialized;
+			expState.rxClock = rxScheduler;
+			expState.sendTo(rightExpander.module->leftExpander);
 		}
-		catch (const std::exception& expansionEx)
-		{
-			WARN("Error with Expansion Module Output: %s.", expansionEx.what());
-		}				
 	} // end OSC->CV
+	// Channel lights
+	if (lightClock.process())
+	{
+		for (int c = 0; c < numberChannels; c++)
+		{
+			if (inputChannels != NULL)
+				lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL].value = inputChannels[c].light.linear(lightClock.frame, lightLambda);
+			if (outputChannels != NULL)
+				lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL + 1].value = outputChannels[c].light.linear(lightClock.frame, lightLambda);
+		}
+	}
 	return;
 } // end step()
 
@@ -732,6 +790,7 @@ void oscCV::setOscNamespace(std::string oscNs)
 		this->oscNamespace = oscNs.substr(1);
 	else
 		this->oscNamespace = oscNs;
+	oscNamespaceVersion = TSOSCCVNextNamespaceVersion();
 	return;
 } // end setOscNamespace()
 
@@ -795,17 +854,54 @@ oscCVExpander* oscCV::getExpansionModule(int index)
 	}			
 	return item;
 }
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// setInputSendPolicy()
+// Set the send policy on all CV->OSC channels (ours and the input expanders').
+// @adaptiveDeadband : (IN) If the deadband should grow with the signal's noise.
+// @significantSendWithin_ms : (IN) Send significant changes within this many ms (negative to disable).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-		
+void oscCV::setInputSendPolicy(bool adaptiveDeadband, float significantSendWithin_ms)
+{
+	if (!doCVPort2OSC)
+		return;
+	for (int c = 0; c < numberChannels; c++)
+	{
+		inputChannels[c].adaptiveDeadband = adaptiveDeadband;
+		inputChannels[c].significantSendWithin_ms = significantSendWithin_ms;
+	}
+	Module::Expander* exp = &(this->leftExpander);
+	while (exp != NULL && exp->module && exp->module->model == modelOscCVExpanderInput)
+	{
+		oscCVExpander* expander = dynamic_cast<oscCVExpander*>(exp->module);
+		for (int c = 0; c < expander->numberChannels; c++)
+		{
+			expander->inputChannels[c].adaptiveDeadband = adaptiveDeadband;
+			expander->inputChannels[c].significantSendWithin_ms = significantSendWithin_ms;
+		}
+		exp = &(exp->module->leftExpander);
+	}
+	return;
+} // end setInputSendPolicy()
 #if USE_MODULE_STATIC_RX
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // addRxMsgToQueue()
 // Adds the message to the queue.
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-void oscCV::addRxMsgToQueue(int chNum, float val)
+void oscCV::addRxMsgToQueue(int chNum, float val, uint64_t timeTag, double arrivalTime)
 {
-	rxMsgMutex.lock();	
-	TSOSCCVSimpleMessage* item = getRxMsgObj();
-	item->SetValues(chNum, val);
-	rxMsgQueue.push(item);
+	rxMsgMutex.lock(); // Producers only (never the audio thread)
+	if (outputChannels != NULL && chNum > 0 && chNum <= numberChannels && outputChannels[chNum - 1].offerToMailbox(&val, 1))
+	{
+		rxMsgMutex.unlock(); // Latest value only
+		return;
+	}
+	TSOSCCVSimpleMessage* item = rxMsgQueue.getWriteSlot();
+	if (item != NULL)
+	{
+		item->SetValues(chNum, val);
+		item->SetTiming(timeTag, arrivalTime);
+		rxMsgQueue.push();
+	}
 	rxMsgMutex.unlock();
 	return;
 }
@@ -813,12 +909,22 @@ void oscCV::addRxMsgToQueue(int chNum, float val)
 // addRxMsgToQueue()
 // Adds the message to the queue.
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-void oscCV::addRxMsgToQueue(int chNum, std::vector<float> vals)
+void oscCV::addRxMsgToQueue(int chNum, std::vector<float> vals, uint64_t timeTag, double arrivalTime)
 {
-	rxMsgMutex.lock();	
-	TSOSCCVSimpleMessage* item = getRxMsgObj();
-	item->SetValues(chNum, vals);
-	rxMsgQueue.push(item);
+	rxMsgMutex.lock(); // Producers only (never the audio thread)
+	if (!vals.empty() && outputChannels != NULL && chNum > 0 && chNum <= numberChannels
+		&& outputChannels[chNum - 1].offerToMailbox(vals.data(), static_cast<int>(vals.size())))
+	{
+		rxMsgMutex.unlock(); // Latest value only
+		return;
+	}
+	TSOSCCVSimpleMessage* item = rxMsgQueue.getWriteSlot();
+	if (item != NULL)
+	{
+		item->SetValues(chNum, vals);
+		item->SetTiming(timeTag, arrivalTime);
+		rxMsgQueue.push();
+	}
 	rxMsgMutex.unlock();
 	return;
 }
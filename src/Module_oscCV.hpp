@@ -11,6 +11,7 @@ using namespace rack;
 #include "Module_oscCVExpander.hpp"
 #include <thread> // std::thread
 #include <mutex>
+#include <atomic>
 #include <string>
 #include <queue>
 #include <vector>
@@ -90,24 +91,23 @@ struct oscCV : Module {
 	// Input CV (from Rack) ==> Needs to be output to OSC
 	TSOSCCVInputChannel* inputChannels = NULL;
 	// Input OSC (from External) ==> Needs to be translated to Rack output port CV
-	TSOSCCVChannel* outputChannels = NULL;
+	TSOSCCVOutputChannel* outputChannels = NULL;
 	dsp::PulseGenerator* pulseGens = NULL;
 	// The received messages.
+#if USE_MODULE_STATIC_RX
+	// The received messages (lock free for the audio thread).
+	TSOSCCVRxQueue rxMsgQueue;
+#else
 	std::queue<TSOSCCVSimpleMessage*> rxMsgQueue;
+#endif
 	dsp::SchmittTrigger* inputTriggers;
 	std::mutex rxMsgMutex;
-#if USE_MODULE_STATIC_RX	
-	// Add static buffer (debug MAC OSC issues)
-	TSOSCCVSimpleMessage rxMsgBuffer[OSC_RX_MSG_BUFFER_SIZE];
-	int rxMsgBufferIx = 0;
-#endif	
-		
 	int oscId;
 	/// TODO: OSC members should be dumped into an OSC base class....
 	// Mutex for osc messaging.
 	std::mutex oscMutex;
 	// Current OSC IP address and port settings.
-	TSOSCConnectionInfo currentOSCSettings = { OSC_ADDRESS_DEF,  OSC_OUTPORT_DEF , OSC_INPORT_DEF };
+	TSOSCConnectionInfo currentOSCSettings = { OSC_ADDRESS_DEF,  OSC_OUTPORT_DEF , OSC_INPORT_DEF, OSC_MULTICAST_TTL_DEF, true, false };
 	// OSC Configure trigger
 	dsp::SchmittTrigger oscConfigTrigger;
 	dsp::SchmittTrigger oscConnectTrigger;
@@ -121,6 +121,14 @@ struct oscCV : Module {
 	int expCurrentEditExpanderIx = 0;
 	// [Expander] Current edit name.
 	std::string expCurrentEditExpanderName;
+	// [Expander] Cached input expanders (left).
+	TSOSCCVModuleChain expInputChain;
+	// [Expander] Cached output expanders (right).
+	TSOSCCVModuleChain expOutputChain;
+	// [Expander] Messages from the input expanders (Rack expander message buffers for our left side).
+	TSOSCCVExpanderTxMessage expTxMessages[2];
+	// [Expander] What we send the expanders every sample.
+	TSOSCCVExpanderState expState;
 	
 	// Configure - Previous (goes Left or towards Inputs).
 	dsp::SchmittTrigger oscConfigPrevTrigger;
@@ -140,8 +148,28 @@ struct oscCV : Module {
 	char* oscBuffer = NULL;
 	// OSC namespace to use. Without the '/'.
 	std::string oscNamespace = TROWA_OSCCV_DEFAULT_NAMESPACE;
-	// Sending OSC socket
-	UdpTransmitSocket* oscTxSocket = NULL;
+	// New (process-wide unique) version every time the namespace changes (so channels know to rebuild their pre-encoded messages).
+	std::atomic<uint32_t> oscNamespaceVersion { 0 };
+	// [Audio thread] Copy of the namespace used for building pre-encoded messages.
+	std::string txNamespace = TROWA_OSCCV_DEFAULT_NAMESPACE;
+	// [Audio thread] The namespace version that txNamespace is.
+	uint32_t txNamespaceVersion = 0;
+	// Writes the outgoing bundle(s) into oscBuffer.
+	TSOSCCVBundleWriter oscTxBundle;
+	// Max UDP payload size per datagram (bundle). 0 for no limit (everything in one bundle).
+	int oscMaxPacketSize = TROWA_OSCCV_DEFAULT_MAX_PACKET_SIZE;
+	// Number of datagrams sent.
+	std::atomic<uint32_t> oscTxPacketCount { 0 };
+	// Number of bytes sent.
+	std::atomic<uint64_t> oscTxByteCount { 0 };
+	// Number of messages dropped because the output buffer was full (counted, not logged, it's the audio thread).
+	std::atomic<uint32_t> oscTxDropCount { 0 };
+	// Schedules received messages (time tags / jitter buffer) onto our sample clock.
+	TSOSCCVRxScheduler rxScheduler;
+	// Our queue in the shared OSC transmitter (the Tx thread does the actual sending).
+	TSOSCTxQueue* oscTxQueue = NULL;
+	// If the current connection uses the local transport (the setting may change before cleanupOSC()).
+	bool oscLocalConnected = false;
 	// OSC message listener
 	//TSOSCCVSimpleMsgListener* oscListener = NULL;
 	// Receiving OSC socket
@@ -151,18 +179,21 @@ struct oscCV : Module {
 	// Prev step that was last turned off (when going to a new step).
 	int oscLastPrevStepUpdated = TROWA_INDEX_UNDEFINED;
 	// Settings for new OSC.
-	TSOSCInfo oscNewSettings = { OSC_ADDRESS_DEF,  OSC_OUTPORT_DEF , OSC_INPORT_DEF };
+	TSOSCInfo oscNewSettings = { OSC_ADDRESS_DEF,  OSC_OUTPORT_DEF , OSC_INPORT_DEF, OSC_MULTICAST_TTL_DEF, true, false };
 	// OSC Mode action (i.e. Enable, Disable)
 	enum OSCAction {
 		None,
 		Disable,
 		Enable
 	};
-	// Flag for our module to either enable or disable osc.
+	// Flag for our module to either enable or disable osc (done by processOSCAction() on the UI thread).
 	OSCAction oscCurrentAction = OSCAction::None;
 	// If this has it controls configured.
 	bool isInitialized = false;
+	// Channel light decay (per frame).
 	const float lightLambda = 0.005f;
+	// Light frame counter/divider.
+	TSLightClock lightClock;
 
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// oscCV()
@@ -212,6 +243,12 @@ struct oscCV : Module {
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	void cleanupOSC();
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// processOSCAction()
+	// [UI thread] Enable/disable OSC if requested (oscCurrentAction). Opening and
+	// closing sockets/threads blocks, so it isn't done in process().
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void processOSCAction();
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// setOscNamespace()
 	// @oscNamespace : (IN) The namespace (without /).
 	// Set the OSC namespace (thread safe-ish).
@@ -223,11 +260,27 @@ struct oscCV : Module {
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	std::string getOscNamespace();	
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// resetTxCounters()
+	// Reset the sent packet, byte and dropped counters.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void resetTxCounters()
+	{
+		oscTxPacketCount = 0;
+		oscTxByteCount = 0;
+		oscTxDropCount = 0;
+		return;
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// process()
 	// [Previously step(void)]
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	void process(const ProcessArgs &args) override;
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// onSampleRateChange()
+	// Recalculate the value history decimation.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void onSampleRateChange() override;
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// reset(void)
 	// Initialize values.
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -265,29 +318,37 @@ struct oscCV : Module {
 	// @index: 0 is this master module (invalid). Negative to the left. Positive to the right.
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-		
 	oscCVExpander* getExpansionModule(int index);
-#if USE_MODULE_STATIC_RX	
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
-	// getRxMsgObj()
-	// Gets next msg object in circular buffer. 
-	// RxConnector should use these objects.
-	// Will overwrite if we are not fast enough reading. 
-	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-	TSOSCCVSimpleMessage* getRxMsgObj()
+	// getCachedExpansionModule()
+	// (Audio thread) Get the expander from the cached chains (see process()).
+	// @index: 0 is this master module (invalid). Negative to the left. Positive to the right.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	oscCVExpander* getCachedExpansionModule(int index)
 	{
-		if (rxMsgBufferIx >= OSC_RX_MSG_BUFFER_SIZE)
-			rxMsgBufferIx = 0;
-		return &(rxMsgBuffer[rxMsgBufferIx++]);
+		if (index < 0 && -index <= expInputChain.length)
+			return static_cast<oscCVExpander*>(expInputChain.modules[-index - 1]);
+		else if (index > 0 && index <= expOutputChain.length)
+			return static_cast<oscCVExpander*>(expOutputChain.modules[index - 1]);
+		return NULL;
 	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// setInputSendPolicy()
+	// Set the send policy on all CV->OSC channels (ours and the input expanders').
+	// @adaptiveDeadband : (IN) If the deadband should grow with the signal's noise.
+	// @significantSendWithin_ms : (IN) Send significant changes within this many ms (negative to disable).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-		
+	void setInputSendPolicy(bool adaptiveDeadband, float significantSendWithin_ms);
+#if USE_MODULE_STATIC_RX	
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// addRxMsgToQueue()
-	// Adds the message to the queue.
+	// Adds the message to the queue (with the bundle time tag and arrival time for scheduling).
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-	void addRxMsgToQueue(int chNum, float val);
+	void addRxMsgToQueue(int chNum, float val, uint64_t timeTag = TROWA_OSCCV_TIMETAG_IMMEDIATE, double arrivalTime = 0.0);
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// addRxMsgToQueue()
-	// Adds the message to the queue.
+	// Adds the message to the queue (with the bundle time tag and arrival time for scheduling).
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-	void addRxMsgToQueue(int chNum, std::vector<float> vals);	
+	void addRxMsgToQueue(int chNum, std::vector<float> vals, uint64_t timeTag = TROWA_OSCCV_TIMETAG_IMMEDIATE, double arrivalTime = 0.0);	
 #endif	
 };
 
@@ -7,6 +7,7 @@ using namespace rack;
 #include <stdio.h>
 #include "TSOSCCV_Common.hpp"
 #include "Module_oscCVExpander.hpp"
+#include "TSRealTimeCheck.hpp"
 #include "Module_oscCV.hpp"
 #include "Widget_oscCVExpander.hpp"
 #include "Widget_oscCV.hpp"
@@ -38,11 +39,22 @@ oscCVExpander::oscCVExpander(int numChannels, TSOSCCVExpanderDirection direction
 	{
 		numOutputs = numChannels * 2;
 		this->expanderType = TSOSCCVExpanderDirection::Output;		
-		outputChannels = new TSOSCCVChannel[numberChannels];
+		outputChannels = new TSOSCCVOutputChannel[numberChannels];
 		pulseGens = new dsp::PulseGenerator[numberChannels];		
 	}
 	
 	config(NUM_PARAMS, NUM_INPUTS + numInputs, NUM_OUTPUTS + numOutputs, NUM_LIGHTS + numChannels * 2);
+	// Rack expander messages: the master side sends us its state. Inputs also get the messages of the expanders past them.
+	Expander* masterSide = (direction == TSOSCCVExpanderDirection::Input) ? &rightExpander : &leftExpander;
+	masterSide->producerMessage = &(expStateMessages[0]);
+	masterSide->consumerMessage = &(expStateMessages[1]);
+	if (direction == TSOSCCVExpanderDirection::Input)
+	{
+		expTxMessages = new TSOSCCVExpanderTxMessage[2];
+		leftExpander.producerMessage = &(expTxMessages[0]);
+		leftExpander.consumerMessage = &(expTxMessages[1]);
+	}
+	txNamespace.reserve(TROWA_OSCCV_MSG_ADDRESS_SIZE);
 	
 	// Can we see how far away a master is right now?	
 	int lvlFromMaster = findMaster(0, masterModuleId);
@@ -52,6 +64,7 @@ oscCVExpander::oscCVExpander(int numChannels, TSOSCCVExpanderDirection direction
 		baseChannels += (lvlFromMaster - 1)*this->numberChannels; // Other expanders should have the same # of channels as we do.
 	}
 	initChannels(baseChannels);
+	onSampleRateChange();
 	
 	_expID = (direction == TSOSCCVExpanderDirection::Input) ? "I" : "O";
 	char buff[4]; 
@@ -75,6 +88,8 @@ oscCVExpander::~oscCVExpander()
 		delete[] inputChannels;
 	if (outputChannels != NULL)
 		delete[] outputChannels;
+	if (expTxMessages != NULL)
+		delete[] expTxMessages;
 	
 
 #if !USE_MODULE_STATIC_RX	
@@ -111,6 +126,22 @@ void oscCVExpander::initChannels(int baseChannel) {
 	return;
 }
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// onSampleRateChange()
+// Recalculate the value history decimation.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void oscCVExpander::onSampleRateChange()
+{
+	float sampleRate = APP->engine->getSampleRate();
+	for (int c = 0; c < numberChannels; c++)
+	{
+		if (inputChannels != NULL)
+			inputChannels[c].valHistory.setSampleRate(sampleRate);
+		if (outputChannels != NULL)
+			outputChannels[c].valHistory.setSampleRate(sampleRate);
+	}
+	return;
+} // end onSampleRateChange()
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // reset(void)
 // Initialize values.
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -233,12 +264,26 @@ int oscCVExpander::findMaster(int n, Module* &master)
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 void oscCVExpander::process(const ProcessArgs &args)
 {
+	TS_RT_CHECK_SCOPE("oscCVExpander");
+	// Path to the master: expanders like us, then the master (only walked again if it changed)
 	oscCV* master = NULL;
-	Module* mod = NULL;
-	lvlFromMaster = findMaster(0, mod);
-	if (mod)
+	bool masterOnLeft = this->expanderType == TSOSCCVExpanderDirection::Output;
+	if (masterChain.update(this, /*left*/ masterOnLeft, this->model))
+	{
+		// We may have a new master, copy its namespace again (no matter what version it is)
+		txNamespaceVersion = 0;
+	}
+	Model* endModel = NULL;
+	int chainLength = 0;
+	Module* end = masterChain.findEnd(/*left*/ masterOnLeft, this->model, &endModel, &chainLength);
+	if (end != NULL && endModel == modelOscCV)
+	{
+		master = static_cast<oscCV*>(end);
+		lvlFromMaster = chainLength + 1;
+	}
+	else
 	{
-		master = dynamic_cast<oscCV*>(mod);
+		lvlFromMaster = -1;
 	}
 	if (lvlFromMaster > 0 && master != NULL)
 	{
@@ -270,6 +315,41 @@ void oscCVExpander::process(const ProcessArgs &args)
 		{
 			WARN("Error searching for master module.\n%s", e.what());
 		}
+
+		//------- CV <==> OSC --------
+		// We do our own channels. The master's state comes down the chain (Rack expander messages, a sample per hop)
+		// and input expanders pass their messages back up to the master.
+		bool input = this->expanderType == TSOSCCVExpanderDirection::Input;
+		Expander* masterSide = (input) ? &rightExpander : &leftExpander;
+		Expander* farSide = (input) ? &leftExpander : &rightExpander;
+		TSOSCCVExpanderState* state = reinterpret_cast<TSOSCCVExpanderState*>(masterSide->consumerMessage);
+		bool farExpander = farSide->module != NULL && farSide->module->model == this->model;
+		if (farExpander)
+		{
+			// Pass it on
+			state->sendTo((input) ? farSide->module->rightExpander : farSide->module->leftExpander);
+		}
+		if (input)
+		{
+			// Build our messages right in the next module's buffer
+			Expander* dst = &(masterSide->module->leftExpander);
+			TSOSCCVExpanderTxMessage* txMessage = reinterpret_cast<TSOSCCVExpanderTxMessage*>(dst->producerMessage);
+			txMessage->clear();
+			processInputs(master, state, args.sampleTime, txMessage);
+			if (farExpander)
+			{
+				TSOSCCVExpanderTxMessage* farMessages = reinterpret_cast<TSOSCCVExpanderTxMessage*>(leftExpander.consumerMessage);
+				if (!txMessage->append(farMessages))
+					master->oscTxDropCount.fetch_add(farMessages->numMessages, std::memory_order_relaxed); // No room in output buffer
+				farMessages->clear(); // Don't send them again if that expander stops sending
+			}
+			dst->messageFlipRequested = true;
+		}
+		else
+		{
+			processOutputs(state, args.sampleTime);
+		}
+		state->sendTime = false; // Once (in case the master side stops sending)
 	}
 	else 
 	{
@@ -280,22 +360,43 @@ void oscCVExpander::process(const ProcessArgs &args)
 		lights[LightIds::LEFT_CONNECTED_LIGHT].value = 0.0f;		
 		lights[LightIds::RIGHT_CONNECTED_LIGHT].value = 0.0f;
 	}
+	// Channel lights
+	if (lightClock.process())
+	{
+		for (int c = 0; c < numberChannels; c++)
+		{
+			if (inputChannels != NULL)
+				lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL].value = inputChannels[c].light.linear(lightClock.frame, lightLambda);
+			if (outputChannels != NULL)
+				lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL + 1].value = outputChannels[c].light.linear(lightClock.frame, lightLambda);
+		}
+	}
 	return;
 } // end step()
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // processInputs()
 // Process CV->OSC.
+// @master : (IN) The master (counts our dropped messages).
+// @state : (IN) The master's state (namespace, send tick, etc.).
+// @sampleTime : (IN) Sample time (s).
+// @txMessage : (IN/OUT) Where to add our messages (toward the master, which sends them).
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-		
-void oscCVExpander::processInputs(std::string oscNamespace, bool oscInitialized, bool sendTime, bool& packetOpened, std::mutex& sendMutex, osc::OutboundPacketStream& oscStream)
+void oscCVExpander::processInputs(oscCV* master, const TSOSCCVExpanderState* state, float sampleTime, TSOSCCVExpanderTxMessage* txMessage)
 {
 	/// TODO: If we make some osc base class, this could be built-in for oscCV and these expanders.
 	try
 	{
 		if (this->expanderType == TSOSCCVExpanderDirection::Input) // doCVPort2OSC
 		{
+			// Channels rebuild their pre-encoded messages when this changes.
+			if (state->nsVersion != txNamespaceVersion)
+			{
+				txNamespace.assign(state->oscNamespace); // Capacity is reserved in the constructor (no allocation here)
+				txNamespaceVersion = state->nsVersion;
+			}
+			bool oscInitialized = state->oscInitialized;
 			// Read the channels and output to OSC
-			char addressBuffer[512];
 			for (int c = 0; c < this->numberChannels; c++)
 			{		
 				bool sendVal = false;
@@ -322,116 +423,24 @@ void oscCVExpander::processInputs(std::string oscNamespace, bool oscInitialized,
 					} // end if trigger is active
 					else
 					{
-						if (!inputChannels[c].doSend) {
-							// Only send if changed enough. Maybe about 0.01 V? Defined on channel.
-							// 1. Check for change:
-							sendVal = inputChannels[c].valChanged();
-							// 2. Mark channel as needing to output
-							if (sendVal) {
-								inputChannels[c].doSend = true;
-							}
-						}
-						// 3. Check if it is time to send out
-						sendVal = sendTime && inputChannels[c].doSend;
+						// See if value has changed enough (channel deadband) and if it is time to send (send tick, channel rate / significant change policy)
+						sendVal = inputChannels[c].checkSend(state->sendTime, sampleTime);
 					}
 					//float outVal = inputChannels[c].translatedVal;
 					if (sendVal)
 					{
-						lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL].value = 1.0f;
-						sendMutex.lock();
-						try
-						{
-							if (!packetOpened)
-							{
-								oscStream << osc::BeginBundleImmediate;
-								packetOpened = true;
-							}
-							if (oscNamespace.empty()) // Allow empty namespaces
-							{
-								sprintf(addressBuffer, "%s", inputChannels[c].getPath().c_str());														
-							}
-							else
-							{
-								sprintf(addressBuffer, "/%s%s", oscNamespace.c_str(), inputChannels[c].getPath().c_str());							
-							}
-							oscStream << osc::BeginMessage(addressBuffer);							
-							for (int j = 0; j < inputChannels[c].numVals; j++)
-							{
-								if (inputChannels[c].convertVals)
-								{
-									// Enforce Data Type:
-									switch (inputChannels[c].dataType)
-									{
-									case TSOSCCVChannel::ArgDataType::OscInt:
-										oscStream << static_cast<int>(inputChannels[c].translatedVals[j]);
-										//outVal = static_cast<float>(static_cast<int>(inputChannels[c].translatedVal[j]));
-										break;
-									case TSOSCCVChannel::ArgDataType::OscBool:
-										oscStream << static_cast<bool>(inputChannels[c].translatedVals[j]);
-										//outVal = static_cast<float>(static_cast<bool>(inputChannels[c].translatedVals[j]));
-										break;
-									case TSOSCCVChannel::ArgDataType::OscFloat:
-									default:
-										oscStream << inputChannels[c].translatedVals[j];
-										break;
-									}
+						inputChannels[c].light.trigger(lightClock.frame);
+						// Pre-encoded address + type tags, just patch in the values.
+						TSOSCCVMsgTemplate* msgTemplate = inputChannels[c].getMsgTemplate(txNamespace, txNamespaceVersion);
+						if (!txMessage->addMessage(msgTemplate, inputChannels[c].getSendVals()))
+							master->oscTxDropCount.fetch_add(1, std::memory_order_relaxed); // No room in output buffer
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
-									DEBUG("SEND OSC[%d,%d]: %s %7.3f", c, j, addressBuffer, inputChannels[c].translatedVals[j]);
-#endif													
-								}
-								else
-								{
-									// Raw value out
-									oscStream << inputChannels[c].vals[j];
-#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
-									DEBUG("SEND OSC[%d]: %s %7.3f", c, addressBuffer, inputChannels[c].vals[j]);
+						DEBUG("SEND OSC[%d] (Expander): %s %7.3f", c, msgTemplate->header, inputChannels[c].getValCV2OSC());
 #endif
-								}							
-							} // end loop through values.	
-							// if (inputChannels[c].convertVals)
-							// {
-								// // Enforce Data Type:
-								// switch (inputChannels[c].dataType)
-								// {
-								// case TSOSCCVChannel::ArgDataType::OscInt:
-									// oscStream << static_cast<int>(inputChannels[c].translatedVal);
-									// outVal = static_cast<float>(static_cast<int>(inputChannels[c].translatedVal));
-									// break;
-								// case TSOSCCVChannel::ArgDataType::OscBool:
-									// oscStream << static_cast<bool>(inputChannels[c].translatedVal);
-									// outVal = static_cast<float>(static_cast<bool>(inputChannels[c].translatedVal));
-									// break;
-								// case TSOSCCVChannel::ArgDataType::OscFloat:
-								// default:
-									// oscStream << inputChannels[c].translatedVal;
-									// break;
-								// }
-							// }
-							// else
-							// {
-								// // Raw value out
-								// oscStream << inputChannels[c].val;
-							// }
-							oscStream << osc::EndMessage;
-							
-#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
-						DEBUG("SEND OSC[%d] (Expander): %s %7.3f", c, addressBuffer, inputChannels[c].getValCV2OSC());
-#endif
-						}
-						catch (const std::exception& e)
-						{
-							WARN("Error %s.", e.what());
-						}
-						sendMutex.unlock();
 						// Save our last sent values
-						inputChannels[c].storeLastValues();
-						inputChannels[c].doSend = false; // Reset
+						inputChannels[c].onSent();
 					} // end if send value 
 				} // end if oscInitialied
-
-				if (lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL].value > 0 && !sendVal) {
-					lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL].value -= lightLambda;
-				}
 			} // end for loop				
 		}
 	}
@@ -444,22 +453,32 @@ void oscCVExpander::processInputs(std::string oscNamespace, bool oscInitialized,
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // processOutputs()
+// @state : (IN) The master's state (Rx clock).
+// @sampleTime : (IN) Sample time (s).
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
-void oscCVExpander::processOutputs(float sampleTime)
+void oscCVExpander::processOutputs(const TSOSCCVExpanderState* state, float sampleTime)
 {
 	//--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--
 	// OSC ==> Rack Output Ports
 	//--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--%--
 	if (expanderType == TSOSCCVExpanderDirection::Output)
 	{
+		// The master's clock is a sample old for every module between us.
+		rxScheduler.followClock(state->rxClock, lvlFromMaster * sampleTime);
 		//------------------------------------------------------------
 		// Look for OSC Rx messages --> Output to Rack
 		//------------------------------------------------------------
 		while (rxMsgQueue.size() > 0)
 		{
+#if USE_MODULE_STATIC_RX
+			TSOSCCVSimpleMessage* rxOscMsg = rxMsgQueue.front(); // Lock free
+#else
 			rxMsgMutex.lock();			
 			TSOSCCVSimpleMessage* rxOscMsg = rxMsgQueue.front();
 			rxMsgMutex.unlock();				
+#endif
+			if (!rxScheduler.isDue(rxOscMsg))
+				break; // Not time yet (jitter buffer / time tag)
 			int chIx = rxOscMsg->channelNum - 1;
 			if (chIx > -1 && chIx < numberChannels)
 			{
@@ -468,12 +487,14 @@ void oscCVExpander::processOutputs(float sampleTime)
 				//outputChannels[chIx].setOSCInValue(rxOscMsg.rxVal);
 				// Now we are using float array not vector for rxVals
 				outputChannels[chIx].setOSCInValue(rxOscMsg->rxVals, rxOscMsg->rxLength);
-				lights[LightIds::CH_LIGHT_START + chIx * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL + 1].value = 1.0f;
+				outputChannels[chIx].light.trigger(lightClock.frame);
 			} // end if valid channel			
+#if USE_MODULE_STATIC_RX
+			rxMsgQueue.pop();
+#else
 			rxMsgMutex.lock();			
 			rxMsgQueue.pop();
 			rxMsgMutex.unlock();	
-#if !USE_MODULE_STATIC_RX			
 			delete rxOscMsg;
 #endif	
 		} // end while (loop through message queue)
@@ -481,22 +502,28 @@ void oscCVExpander::processOutputs(float sampleTime)
 		float dt = sampleTime;
 		for (int c = 0; c < numberChannels; c++)
 		{
+			// Latest-value channels: newest snapshot (once, however many were received)
+			if (outputChannels[c].readMailbox())
+			{
+				pulseGens[c].trigger(TROWA_PULSE_WIDTH);
+				outputChannels[c].light.trigger(lightClock.frame);
+			}
 			// Output the value first
 			// We should limit this value (-10V to +10V). Rack says nothing should be higher than +/- 12V.
 			// float outVal = outputChannels[c].getValOSC2CV();
 			// outputs[OutputIds::CH_OUTPUT_START + c * 2 + 1].setVoltage(clamp(outVal, TROWA_OSCCV_MIN_VOLTAGE, TROWA_OSCCV_MAX_VOLTAGE));
 			// outputChannels[c].addValToBuffer(outVal);
 			// Polyphonic output :::::::::::::::::::::::
+			outputChannels[c].process(dt); // Smoothing (if any)
 			outputs[OutputIds::CH_OUTPUT_START + c * 2 + 1].setChannels(outputChannels[c].numVals);
 			for (int j = 0; j < outputChannels[c].numVals; j++)
 			{
-				outputs[OutputIds::CH_OUTPUT_START + c * 2 + 1].setVoltage(/*v*/clamp(outputChannels[c].translatedVals[j], TROWA_OSCCV_MIN_VOLTAGE, TROWA_OSCCV_MAX_VOLTAGE), /*channel*/ j);				
+				outputs[OutputIds::CH_OUTPUT_START + c * 2 + 1].setVoltage(/*v*/clamp(outputChannels[c].outVals[j], TROWA_OSCCV_MIN_VOLTAGE, TROWA_OSCCV_MAX_VOLTAGE), /*channel*/ j);				
 			}
-			outputChannels[c].addValToBuffer(outputChannels[c].translatedVals[0]);			
+			outputChannels[c].addValToBuffer(outputChannels[c].outVals[0]);			
 			// Then trigger if needed.
 			bool trigger = pulseGens[c].process(dt);
 			outputs[OutputIds::CH_OUTPUT_START + c * 2].setVoltage((trigger) ? TROWA_OSCCV_TRIGGER_ON_V : TROWA_OSCCV_TRIGGER_OFF_V);
-			lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL + 1].value = clamp(lights[LightIds::CH_LIGHT_START + c * TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL + 1].value - lightLambda, 0.0f, 1.0f);
 		}
 	}
 	return;
@@ -614,12 +641,21 @@ void oscCVExpander::dataFromJson(json_t *rootJ) {
 // addRxMsgToQueue()
 // Adds the message to the queue.
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-void oscCVExpander::addRxMsgToQueue(int chNum, float val)
+void oscCVExpander::addRxMsgToQueue(int chNum, float val, uint64_t timeTag, double arrivalTime)
 {
-	rxMsgMutex.lock();	
-	TSOSCCVSimpleMessage* item = getRxMsgObj();
-	item->SetValues(chNum, val);
-	rxMsgQueue.push(item);
+	rxMsgMutex.lock(); // Producers only (never the audio thread)
+	if (outputChannels != NULL && chNum > 0 && chNum <= numberChannels && outputChannels[chNum - 1].offerToMailbox(&val, 1))
+	{
+		rxMsgMutex.unlock(); // Latest value only
+		return;
+	}
+	TSOSCCVSimpleMessage* item = rxMsgQueue.getWriteSlot();
+	if (item != NULL)
+	{
+		item->SetValues(chNum, val);
+		item->SetTiming(timeTag, arrivalTime);
+		rxMsgQueue.push();
+	}
 	rxMsgMutex.unlock();
 	return;
 }
@@ -627,12 +663,22 @@ void oscCVExpander::addRxMsgToQueue(int chNum, float val)
 // addRxMsgToQueue()
 // Adds the message to the queue.
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-void oscCVExpander::addRxMsgToQueue(int chNum, std::vector<float> vals)
+void oscCVExpander::addRxMsgToQueue(int chNum, std::vector<float> vals, uint64_t timeTag, double arrivalTime)
 {
-	rxMsgMutex.lock();	
-	TSOSCCVSimpleMessage* item = getRxMsgObj();
-	item->SetValues(chNum, vals);
-	rxMsgQueue.push(item);
+	rxMsgMutex.lock(); // Producers only (never the audio thread)
+	if (!vals.empty() && outputChannels != NULL && chNum > 0 && chNum <= numberChannels
+		&& outputChannels[chNum - 1].offerToMailbox(vals.data(), static_cast<int>(vals.size())))
+	{
+		rxMsgMutex.unlock(); // Latest value only
+		return;
+	}
+	TSOSCCVSimpleMessage* item = rxMsgQueue.getWriteSlot();
+	if (item != NULL)
+	{
+		item->SetValues(chNum, vals);
+		item->SetTiming(timeTag, arrivalTime);
+		rxMsgQueue.push();
+	}
 	rxMsgMutex.unlock();
 	return;
 }
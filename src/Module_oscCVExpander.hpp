@@ -19,6 +19,8 @@ extern Model* modelOscCVExpanderOutput;
 #include "TSOSCCV_Common.hpp"
 #include "TSColors.hpp"
 
+struct oscCV;
+
 //=== DEBUG MacOS ====
 //#define USE_MODULE_STATIC_RX					1 // Debug MAC OS issues. Start keeping a static buffer of msg objects for each module.
 //#define OSC_RX_MSG_BUFFER_SIZE				   40 // Debug MAC OS issues. Start keeping a static buffer of msg objects for each module.
@@ -85,18 +87,21 @@ struct oscCVExpander : Module
 	// Input CV (from Rack) ==> Needs to be output to OSC
 	TSOSCCVInputChannel* inputChannels = NULL;
 	// Input OSC (from External) ==> Needs to be translated to Rack output port CV
-	TSOSCCVChannel* outputChannels = NULL;	
+	TSOSCCVOutputChannel* outputChannels = NULL;	
 	dsp::SchmittTrigger* inputTriggers;	
 	dsp::PulseGenerator* pulseGens = NULL;
 	// The received messages.
+#if USE_MODULE_STATIC_RX
+	// The received messages (lock free for the audio thread).
+	TSOSCCVRxQueue rxMsgQueue;
+#else
 	std::queue<TSOSCCVSimpleMessage*> rxMsgQueue;
+#endif
 	std::mutex rxMsgMutex; // Msg queue mutex
-#if USE_MODULE_STATIC_RX	
-	// Add static buffer (debug MAC OSC issues)
-	TSOSCCVSimpleMessage rxMsgBuffer[OSC_RX_MSG_BUFFER_SIZE];
-	int rxMsgBufferIx = 0;
-#endif	
-	const float lightLambda = 0.005f;	
+	// Channel light decay (per frame).
+	const float lightLambda = 0.005f;
+	// Light frame counter/divider.
+	TSLightClock lightClock;
 	// Mutex for osc messaging.
 	std::mutex oscMutex;		
 	
@@ -104,6 +109,18 @@ struct oscCVExpander : Module
 	int masterModuleId = -1;
 	// 1 is right next to master, 2 is 2 away.
 	int lvlFromMaster = 0;
+	// Cached expanders between us and the master (the master is past the end).
+	TSOSCCVModuleChain masterChain;
+	// The master's state (Rack expander message buffers for the master side).
+	TSOSCCVExpanderState expStateMessages[2];
+	// (Input) Messages from the expanders past us (Rack expander message buffers for the far side).
+	TSOSCCVExpanderTxMessage* expTxMessages = NULL;
+	// [Audio thread] The namespace our messages are built for.
+	std::string txNamespace;
+	// [Audio thread] The namespace version that txNamespace is (reset when the path to the master changes).
+	uint32_t txNamespaceVersion = 0;
+	// Our copy of the master's Rx clock (when to apply received messages).
+	TSOSCCVRxScheduler rxScheduler;
 	// Some kind of somewhat unique id for a master module to identify it.
 	std::string _expID;
 	// Some user defined name.
@@ -116,11 +133,6 @@ struct oscCVExpander : Module
 	
 	// The expander type (INPUT/OUTPUT). Maybe we'll have 'both' someday? 
 	TSOSCCVExpanderDirection expanderType = TSOSCCVExpanderDirection::Unknown;
-	// Messaging has delay so chaining will get crazy.
-	// // Right message. If this is INPUT, then a master should be on the right.
-	// TSOSCCVExpanderMessage* rightMessage[2];
-	// // Left message. If this is OUTPUT, then a master should be on the left.
-	// TSOSCCVExpanderMessage* leftMessage[2];
 
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// oscCVExpander()
@@ -137,6 +149,11 @@ struct oscCVExpander : Module
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
 	void initChannels(int baseChannel);
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// onSampleRateChange()
+	// Recalculate the value history decimation.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void onSampleRateChange() override;
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// reset(void)
 	// Initialize values.
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -176,14 +193,14 @@ struct oscCVExpander : Module
 	void process(const ProcessArgs &args) override;	
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// processInputs()
-	// Process CV->OSC.
+	// Process CV->OSC (from our process()).
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-		
-	void processInputs(std::string oscNamespace, bool oscInitialized, bool sendTime, bool& packetOpened, std::mutex& sendMutex, osc::OutboundPacketStream& oscStream);
+	void processInputs(oscCV* master, const TSOSCCVExpanderState* state, float sampleTime, TSOSCCVExpanderTxMessage* txMessage);
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// processOutputs()
-	// Process OSC->CV (from msg queue).
+	// Process OSC->CV (from msg queue, from our process()). Messages are applied when the master's clock says they are due.
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-		
-	void processOutputs(float sampleTime);
+	void processOutputs(const TSOSCCVExpanderState* state, float sampleTime);
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// getColor()
 	// Get the color based on the position.
@@ -200,27 +217,15 @@ struct oscCVExpander : Module
 #if USE_MODULE_STATIC_RX	
 	// This should really go into another class.
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
-	// getRxMsgObj()
-	// Gets next msg object in circular buffer. 
-	// RxConnector should use these objects.
-	// Will overwrite if we are not fast enough reading. 
-	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-	TSOSCCVSimpleMessage* getRxMsgObj()
-	{
-		if (rxMsgBufferIx >= OSC_RX_MSG_BUFFER_SIZE)
-			rxMsgBufferIx = 0;
-		return &(rxMsgBuffer[rxMsgBufferIx++]);
-	}
-	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// addRxMsgToQueue()
-	// Adds the message to the queue.
+	// Adds the message to the queue (with the bundle time tag and arrival time for scheduling).
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-	void addRxMsgToQueue(int chNum, float val);
+	void addRxMsgToQueue(int chNum, float val, uint64_t timeTag = TROWA_OSCCV_TIMETAG_IMMEDIATE, double arrivalTime = 0.0);
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// addRxMsgToQueue()
-	// Adds the message to the queue.
+	// Adds the message to the queue (with the bundle time tag and arrival time for scheduling).
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
-	void addRxMsgToQueue(int chNum, std::vector<float> vals);	
+	void addRxMsgToQueue(int chNum, std::vector<float> vals, uint64_t timeTag = TROWA_OSCCV_TIMETAG_IMMEDIATE, double arrivalTime = 0.0);	
 #endif		
 };
 
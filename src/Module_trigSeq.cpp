@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <exception>
 #include "TSSequencerModuleBase.hpp"
+#include "TSRealTimeCheck.hpp"
 #include "trowaSoft.hpp"
 //#include "dsp/digital.hpp"
 #include "trowaSoftComponents.hpp"
@@ -64,6 +65,7 @@ float trigSeq::getPlayingStepValue(int step, int pattern)
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 void trigSeq::process(const ProcessArgs &args) 
 {
+	TS_RT_CHECK_SCOPE("trigSeq");
 	if (!initialized)
 		return;	
 	bool gOn = true;
@@ -95,10 +97,14 @@ void trigSeq::process(const ProcessArgs &args)
 	int gridRow, gridCol; // for touchOSC grids
 	if (reloadMatrix)
 	{
+		// Bulk clients get the whole channel in one message instead of a message per step.
+		bool bulkOSC = this->oscCurrentClient == OSCClient::BulkClient;
 		reloadEditMatrix = false;		
-		oscMutex.lock();
+		// Don't block the audio thread: skip OSC for this sample if the UI thread is (re)initializing it.
+		bool oscLocked = oscMutex.try_lock();
+		bool sendNow = sendOSC && oscInitialized && oscLocked;
 		osc::OutboundPacketStream oscStream(oscBuffer, OSC_OUTPUT_BUFFER_SIZE);
-		if (sendOSC && oscInitialized)
+		if (sendNow)
 		{
 			
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
@@ -106,7 +112,6 @@ void trigSeq::process(const ProcessArgs &args)
 #endif
 			oscStream << osc::BeginBundleImmediate;
 		}
-		oscMutex.unlock();
 		// Load this gate and/or pattern into our 4x4 matrix
 		for (int s = 0; s < maxSteps; s++) 
 		{
@@ -116,7 +121,7 @@ void trigSeq::process(const ProcessArgs &args)
 			padLightPtrs[r][c]->setColor(voiceColors[currentChannelEditingIx]);
 			if (triggerState[currentPatternEditingIx][currentChannelEditingIx][s])
 			{
-				gateLights[r][c] = 1.0f - stepLights[r][c];
+				gateLights[r][c] = 1.0f - getStepLight(s);
 				gateTriggers[s].state = TriggerSignal::HIGH;
 				paramQuantities[ParamIds::CHANNEL_PARAM + s]->setValue(1.0f);// Not momentary anymore
 			} 
@@ -126,14 +131,13 @@ void trigSeq::process(const ProcessArgs &args)
 				gateTriggers[s].state = TriggerSignal::LOW;
 				paramQuantities[ParamIds::CHANNEL_PARAM + s]->setValue(0.0f);// Not momentary anymore
 			}
-			oscMutex.lock();
-			if (sendOSC && oscInitialized)
+			if (sendNow && !bulkOSC)
 			{
 				if (s > 0 && s % 16 == 0) // There is a limit to client buffer size, so let's not make the bundles too large. Hopefully they can take 16-steps at a time.
 				{
 					// Send this bundle and then start a new one
 					oscStream << osc::EndBundle;
-					oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+					oscSend(oscStream.Data(), oscStream.Size());
 					oscStream.Clear();
 					// Start new bundle:
 					oscStream << osc::BeginBundleImmediate;
@@ -159,11 +163,11 @@ void trigSeq::process(const ProcessArgs &args)
 					<< triggerState[currentPatternEditingIx][currentChannelEditingIx][s]
 					<< osc::EndMessage;
 			}
-			oscMutex.unlock();
 		} // end for
-		oscMutex.lock();
-		if (sendOSC && oscInitialized)
+		if (sendNow)
 		{
+			if (bulkOSC)
+				addOSCBulkChannelSteps(oscStream, currentPatternEditingIx, currentChannelEditingIx);
 			// Send color of grid:
 			if (this->oscCurrentClient == OSCClient::touchOSCClient)
 			{
@@ -178,20 +182,22 @@ void trigSeq::process(const ProcessArgs &args)
 			}
 			// End last bundle and send:
 			oscStream << osc::EndBundle;
-			oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+			oscSend(oscStream.Data(), oscStream.Size());
 		}
-		oscMutex.unlock();
+		if (oscLocked)
+			oscMutex.unlock();
 	}
 	//-- * Read the buttons
 	else if (!valuesChanging) // Only read in if another thread isn't changing the values
 	{		
-		oscMutex.lock();
+		// Don't block the audio thread: skip OSC for this sample if the UI thread is (re)initializing it.
+		bool oscLocked = oscMutex.try_lock();
+		bool sendNow = sendOSC && oscInitialized && oscLocked;
 		osc::OutboundPacketStream oscStream(oscBuffer, OSC_OUTPUT_BUFFER_SIZE);
-		if (sendOSC && oscInitialized)
+		if (sendNow)
 		{
 			oscStream << osc::BeginBundleImmediate;
 		}
-		oscMutex.unlock();
 		int numChanged = 0;
 
 		// Step buttons/pads (for this one Channel/gate) - Read Inputs
@@ -205,16 +211,17 @@ void trigSeq::process(const ProcessArgs &args)
 				triggerState[currentPatternEditingIx][currentChannelEditingIx][s] = !triggerState[currentPatternEditingIx][currentChannelEditingIx][s];
 				sendLightVal = sendOSC; // Value has changed.
 			}
-			r = s / this->numCols; // TROWA_SEQ_STEP_NUM_COLS;
-			c = s % this->numCols; // TROWA_SEQ_STEP_NUM_COLS;
-			stepLights[r][c] -= stepLights[r][c] / lightLambda / args.sampleRate;
-			
-			gateLights[r][c] = (triggerState[currentPatternEditingIx][currentChannelEditingIx][s]) ? 1.0 - stepLights[r][c] : stepLights[r][c];
-			lights[PAD_LIGHTS + s].value = gateLights[r][c];
+			if (updateLights)
+			{
+				r = s / this->numCols; // TROWA_SEQ_STEP_NUM_COLS;
+				c = s % this->numCols; // TROWA_SEQ_STEP_NUM_COLS;
+				float stepLight = getStepLight(s);
+				gateLights[r][c] = (triggerState[currentPatternEditingIx][currentChannelEditingIx][s]) ? 1.0 - stepLight : stepLight;
+				lights[PAD_LIGHTS + s].value = gateLights[r][c];
+			}
 
-			oscMutex.lock();
 			// This step has changed and we are doing OSC
-			if (sendLightVal && oscInitialized)
+			if (sendLightVal && sendNow)
 			{
 				// Send the step value
 				if (this->oscCurrentClient == OSCClient::touchOSCClient)
@@ -234,15 +241,14 @@ void trigSeq::process(const ProcessArgs &args)
 					<< osc::EndMessage;
 				numChanged++;
 			} // end if send the value over OSC
-			oscMutex.unlock();
 		} // end loop through step buttons
-		oscMutex.lock();
-		if (sendOSC && oscInitialized && numChanged > 0)
+		if (sendNow && numChanged > 0)
 		{			
 			oscStream << osc::EndBundle;
-			oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+			oscSend(oscStream.Data(), oscStream.Size());
 		}
-		oscMutex.unlock();
+		if (oscLocked)
+			oscMutex.unlock();
 	} // end else (read buttons)
 	
 	// Set Outputs (16 Channels)	
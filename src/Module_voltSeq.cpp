@@ -6,6 +6,7 @@
 #include "trowaSoftComponents.hpp"
 #include "trowaSoftUtilities.hpp"
 #include "TSSequencerModuleBase.hpp"
+#include "TSRealTimeCheck.hpp"
 #include "Module_voltSeq.hpp"
 
 #define TROWA_VOLTSEQ_OSC_ROUND_VAL					 100   // Mult & Divisor for rounding.
@@ -151,7 +152,7 @@ void voltSeq::setStepValue(int step, float val, int channel, int pattern)
 	{
 		if (triggerState[pattern][channel][step])
 		{
-			gateLights[r][c] = 1.0f - stepLights[r][c];
+			gateLights[r][c] = 1.0f - getStepLight(step);
 			if (gateTriggers != NULL)
 				gateTriggers[step].state = TriggerSignal::HIGH;
 		}
@@ -162,8 +163,9 @@ void voltSeq::setStepValue(int step, float val, int channel, int pattern)
 				gateTriggers[step].state = TriggerSignal::LOW;
 		}
 	}
-	oscMutex.lock();
-	if (useOSC && oscInitialized)
+	// Called from the audio thread (control messages), so don't block on the OSC mutex.
+	bool oscLocked = oscMutex.try_lock();
+	if (useOSC && oscInitialized && oscLocked)
 	{
 		// Send the result back
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
@@ -187,9 +189,10 @@ void voltSeq::setStepValue(int step, float val, int channel, int pattern)
 			<< valOutputBuffer // String version of the value (touchOSC needs this)
 			<< osc::EndMessage
 			<< osc::EndBundle;
-		oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+		oscSend(oscStream.Data(), oscStream.Size());
 	}
-	oscMutex.unlock();
+	if (oscLocked)
+		oscMutex.unlock();
 
 	// Set our knobs
 	if (pattern == currentPatternEditingIx && channel == currentChannelEditingIx)
@@ -281,6 +284,7 @@ void voltSeq::shiftValues(/*in*/ int patternIx, /*in*/ int channelIx, /*in*/ flo
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 void voltSeq::process(const ProcessArgs &args)
 {
+	TS_RT_CHECK_SCOPE("voltSeq");
 	if (!initialized)
 		return;
 	bool gOn = true;
@@ -324,39 +328,44 @@ void voltSeq::process(const ProcessArgs &args)
 	// This is what we are showing not what we playing
 	char valOutputBuffer[20] = { 0 };
 	char addrBuff[TROWA_SEQ_BUFF_SIZE] = { 0 };
-	std::string stepStringAddr = std::string(oscAddrBuffer[SeqOSCOutputMsg::EditStepString]);
 	if (reloadMatrix || reloadEditMatrix || valueModeChanged)
 	{
+		// Bulk clients get the whole channel in one message instead of messages per step.
+		bool bulkOSC = oscCurrentClient == OSCClient::BulkClient;
 		reloadEditMatrix = false;
-		oscMutex.lock();
+		// Don't block the audio thread: skip OSC for this sample if the UI thread is (re)initializing it.
+		bool oscLocked = oscMutex.try_lock();
+		bool sendNow = sendOSC && oscInitialized && oscLocked;
 		osc::OutboundPacketStream oscStream(oscBuffer, OSC_OUTPUT_BUFFER_SIZE);
-		if (sendOSC && oscInitialized)
+		if (sendNow)
 		{
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
 			DEBUG("Sending reload matrix: %s.", oscAddrBuffer[SeqOSCOutputMsg::EditStep]);
 #endif
 			oscStream << osc::BeginBundleImmediate;
 		}
-		oscMutex.unlock();
 		// Load this channel into our 4x4 matrix
 		for (int s = 0; s < maxSteps; s++) 
 		{
 			r = s / this->numCols; // TROWA_SEQ_STEP_NUM_COLS;
 			c = s % this->numCols; // TROWA_SEQ_STEP_NUM_COLS;
 			padLightPtrs[r][c]->setColor(voiceColors[currentChannelEditingIx]);
-			gateLights[r][c] = 1.0 - stepLights[r][c];
+			gateLights[r][c] = 1.0 - getStepLight(s);
 			this->params[CHANNEL_PARAM + s].setValue(this->triggerState[currentPatternEditingIx][currentChannelEditingIx][s]);
 			knobStepMatrix[r][c]->setKnobValue(this->triggerState[currentPatternEditingIx][currentChannelEditingIx][s]);			
 			lights[PAD_LIGHTS + s].value = gateLights[r][c];
-			oscMutex.lock();
-			if (sendOSC && oscInitialized)
+			if (bulkOSC && sendNow)
+			{
+				oscLastSentVals[s] = roundValForOSC(triggerState[currentPatternEditingIx][currentChannelEditingIx][s]);
+			}
+			else if (sendNow)
 			{
 				// Each step may have up to 4-ish messages, so send 4 or 8 steps at a time.
 				if (s > 0 && s % 8 == 0) // There is a limit to client buffer size, so let's not make the bundles too large. Hopefully they can take this many steps at a time.
 				{
 					// Send this bundle and then start a new one
 					oscStream << osc::EndBundle;
-					oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+					oscSend(oscStream.Data(), oscStream.Size());
 					oscStream.Clear();
 					// Start new bundle:
 					oscStream << osc::BeginBundleImmediate;
@@ -388,11 +397,11 @@ void voltSeq::process(const ProcessArgs &args)
 					<< valOutputBuffer // String version of the value (touchOSC needs this)
 					<< osc::EndMessage;
 			}
-			oscMutex.unlock();
 		} // end for
-		oscMutex.lock();
-		if (sendOSC && oscInitialized)
+		if (sendNow)
 		{
+			if (bulkOSC)
+				addOSCBulkChannelSteps(oscStream, currentPatternEditingIx, currentChannelEditingIx);
 			if (oscCurrentClient == OSCClient::touchOSCClient)
 			{
 				// Also change color on the Channel control:
@@ -404,20 +413,22 @@ void voltSeq::process(const ProcessArgs &args)
 
 			// End last bundle and send:
 			oscStream << osc::EndBundle;
-			oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+			oscSend(oscStream.Data(), oscStream.Size());
 		}
-		oscMutex.unlock();
+		if (oscLocked)
+			oscMutex.unlock();
 	} // end if reload edit matrix
 	//-- * Read the buttons
 	else if (!valuesChanging) // Only read in if another thread isn't changing the values
 	{		
-		oscMutex.lock();
+		// Don't block the audio thread: skip OSC for this sample if the UI thread is (re)initializing it.
+		bool oscLocked = oscMutex.try_lock();
+		bool sendNow = sendOSC && oscInitialized && oscLocked;
 		osc::OutboundPacketStream oscStream(oscBuffer, OSC_OUTPUT_BUFFER_SIZE);
-		if (sendOSC && oscInitialized)
+		if (sendNow)
 		{
 			oscStream << osc::BeginBundleImmediate;
 		}
-		oscMutex.unlock();
 
 		int numChanged = 0;
 		const float threshold = TROWA_VOLTSEQ_KNOB_CHANGED_THRESHOLD;
@@ -428,15 +439,16 @@ void voltSeq::process(const ProcessArgs &args)
 			this->triggerState[currentPatternEditingIx][currentChannelEditingIx][s] = this->params[ParamIds::CHANNEL_PARAM + s].getValue();
 			float dv = roundValForOSC(this->triggerState[currentPatternEditingIx][currentChannelEditingIx][s]) - oscLastSentVals[s];
 			sendLightVal = sendOSC && (dv > threshold || -dv > threshold); // Let's not send super tiny changes
-			r = s / this->numCols;
-			c = s % this->numCols;			
-			stepLights[r][c] -= stepLights[r][c] / lightLambda / args.sampleRate;
-			gateLights[r][c] = stepLights[r][c];			
-			lights[PAD_LIGHTS + s].value = gateLights[r][c];
+			if (updateLights)
+			{
+				r = s / this->numCols;
+				c = s % this->numCols;
+				gateLights[r][c] = getStepLight(s);
+				lights[PAD_LIGHTS + s].value = gateLights[r][c];
+			}
 
-			oscMutex.lock();
 			// This step has changed and we are doing OSC
-			if (sendLightVal && oscInitialized)
+			if (sendLightVal && sendNow)
 			{		
 				oscLastSentVals[s] = roundValForOSC(triggerState[currentPatternEditingIx][currentChannelEditingIx][s]);
 				// voltSeq should send the actual values.
@@ -461,15 +473,14 @@ void voltSeq::process(const ProcessArgs &args)
 					<< osc::EndMessage;
 				numChanged++;
 			} // end if send the value over OSC
-			oscMutex.unlock();
 		} // end loop through step buttons
-		oscMutex.lock();
-		if (sendOSC && oscInitialized && numChanged > 0)
+		if (sendNow && numChanged > 0)
 		{
 			oscStream << osc::EndBundle;
-			oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+			oscSend(oscStream.Data(), oscStream.Size());
 		}
-		oscMutex.unlock();
+		if (oscLocked)
+			oscMutex.unlock();
 	} // end else (read button matrix)
 	
 	// Set Outputs (16 triggers)	
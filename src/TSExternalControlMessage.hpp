@@ -126,6 +126,11 @@ struct TSExternalControlMessage {
 		// /edit/module/init
 		// Parameters: -NONE-
 		InitializeEditModule,
+		// Bulk write of step values (always a write, even in performance mode)
+		// /edit/ch/steps or /edit/pat/steps
+		// Parameters: int pattern, (ch only) int channel, blob or float values
+		// (mode is the index of the values block in the queue, see TSExternalControlQueue::acquireBulk())
+		SetEditStepValues,
 		// Total # message types
 		NUM_MESSAGE_TYPES
 	};
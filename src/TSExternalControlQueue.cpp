@@ -0,0 +1,168 @@
+#include "TSExternalControlQueue.hpp"
+#include <string.h>
+
+// Coalescing key families (top bits of the key).
+#define TROWA_EXT_CTL_KEY_STEP		1u
+#define TROWA_EXT_CTL_KEY_TEMPO		2u
+#define TROWA_EXT_CTL_KEY_SHIFT		28
+
+TSExternalControlQueue::TSExternalControlQueue()
+{
+	for (int i = 0; i < TROWA_EXT_CTL_QUEUE_SIZE; i++)
+		cells[i].sequence.store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+	memset(coalesceTable, 0, sizeof(coalesceTable));
+	for (int i = 0; i < TROWA_EXT_CTL_BULK_BLOCKS; i++)
+		bulkInUse[i].store(false, std::memory_order_relaxed);
+	return;
+}
+
+// Get a free bulk block (any thread).
+TSExternalControlQueue::BulkValues* TSExternalControlQueue::acquireBulk(int* ix)
+{
+	for (int i = 0; i < TROWA_EXT_CTL_BULK_BLOCKS; i++)
+	{
+		bool expected = false;
+		if (!bulkInUse[i].load(std::memory_order_relaxed) && bulkInUse[i].compare_exchange_strong(expected, true, std::memory_order_acquire))
+		{
+			*ix = i;
+			bulk[i].numVals = 0;
+			bulk[i].wholePattern = false;
+			return &(bulk[i]);
+		}
+	}
+	// All waiting
+	receivedCount.fetch_add(1, std::memory_order_relaxed);
+	overflowCount.fetch_add(1, std::memory_order_relaxed);
+	return NULL;
+}
+
+// Queue a message (any thread).
+bool TSExternalControlQueue::push(const TSExternalControlMessage& msg)
+{
+	receivedCount.fetch_add(1, std::memory_order_relaxed);
+	uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+	Cell* cell = NULL;
+	while (cell == NULL)
+	{
+		Cell* c = &(cells[pos & (TROWA_EXT_CTL_QUEUE_SIZE - 1)]);
+		int32_t diff = static_cast<int32_t>(c->sequence.load(std::memory_order_acquire) - pos);
+		if (diff == 0)
+		{
+			// Our turn, claim it
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				cell = c;
+		}
+		else if (diff < 0)
+		{
+			// Full
+			overflowCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			// Another producer got it
+			pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+	cell->msg = msg;
+	cell->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+// Pop the oldest message (consumer).
+bool TSExternalControlQueue::pop(TSExternalControlMessage* msg)
+{
+	Cell* cell = &(cells[dequeuePos & (TROWA_EXT_CTL_QUEUE_SIZE - 1)]);
+	if (static_cast<int32_t>(cell->sequence.load(std::memory_order_acquire) - (dequeuePos + 1)) < 0)
+		return false; // Empty (or the producer has not finished writing it)
+	*msg = cell->msg;
+	cell->sequence.store(dequeuePos + TROWA_EXT_CTL_QUEUE_SIZE, std::memory_order_release);
+	dequeuePos++;
+	return true;
+}
+
+// Nothing before this may be coalesced with anything after.
+void TSExternalControlQueue::barrier()
+{
+	generation++;
+	if (generation == 0)
+	{
+		// Wrapped, clear the old stamps
+		memset(coalesceTable, 0, sizeof(coalesceTable));
+		generation = 1;
+	}
+	stepAddressing = -1;
+	return;
+}
+
+// Key of the state an absolute write sets.
+bool TSExternalControlQueue::getCoalesceKey(const TSExternalControlMessage& msg, uint32_t* key, int* addressing)
+{
+	switch (msg.messageType)
+	{
+	case TSExternalControlMessage::MessageType::SetEditStepValue:
+		*key = (TROWA_EXT_CTL_KEY_STEP << TROWA_EXT_CTL_KEY_SHIFT) | ((static_cast<uint32_t>(msg.pattern) & 0xFF) << 16)
+			| ((static_cast<uint32_t>(msg.channel) & 0xFF) << 8) | (static_cast<uint32_t>(msg.step) & 0xFF);
+		*addressing = ((msg.pattern < 0) ? 1 : 0) | ((msg.channel < 0) ? 2 : 0);
+		return true;
+	case TSExternalControlMessage::MessageType::SetPlayBPM:
+	case TSExternalControlMessage::MessageType::SetPlayTempo:
+		*key = TROWA_EXT_CTL_KEY_TEMPO << TROWA_EXT_CTL_KEY_SHIFT;
+		*addressing = 0;
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Drain into the batch, coalescing by key (consumer).
+int TSExternalControlQueue::drain()
+{
+	TSExternalControlMessage msg;
+	if (!pop(&msg))
+		return 0;
+	barrier(); // Never coalesce with the last block
+	int count = 0;
+	do
+	{
+		uint32_t key = 0;
+		int addressing = 0;
+		if (!getCoalesceKey(msg, &key, &addressing))
+		{
+			// Relative or other message: keep the order around it
+			barrier();
+			batch[count++] = msg;
+			continue;
+		}
+		if ((key >> TROWA_EXT_CTL_KEY_SHIFT) == TROWA_EXT_CTL_KEY_STEP)
+		{
+			// Current pattern/channel and explicit ones may be the same step: don't mix them
+			if (stepAddressing > -1 && stepAddressing != addressing)
+				barrier();
+			stepAddressing = addressing;
+		}
+		uint32_t h = (key * 2654435761u) & (TROWA_EXT_CTL_COALESCE_SIZE - 1);
+		while (coalesceTable[h].generation == generation && coalesceTable[h].key != key)
+			h = (h + 1) & (TROWA_EXT_CTL_COALESCE_SIZE - 1);
+		CoalesceEntry* entry = &(coalesceTable[h]);
+		if (entry->generation == generation)
+		{
+			if (batch[entry->batchIx].messageType == msg.messageType)
+			{
+				// Same write: last value wins (in the place of the first)
+				batch[entry->batchIx] = msg;
+				coalescedCount.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+			// Same state but a different kind of write (i.e. BPM then tempo): keep both in order
+			barrier();
+			h = (key * 2654435761u) & (TROWA_EXT_CTL_COALESCE_SIZE - 1);
+			entry = &(coalesceTable[h]);
+		}
+		entry->key = key;
+		entry->generation = generation;
+		entry->batchIx = count;
+		batch[count++] = msg;
+	} while (count < TROWA_EXT_CTL_QUEUE_SIZE && pop(&msg));
+	return count;
+}
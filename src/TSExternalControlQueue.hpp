@@ -0,0 +1,121 @@
+#ifndef TSEXTERNALCONTROLQUEUE_HPP
+#define TSEXTERNALCONTROLQUEUE_HPP
+
+#include <atomic>
+#include <stdint.h>
+#include "TSExternalControlMessage.hpp"
+
+// Max external control messages waiting (power of 2).
+#define TROWA_EXT_CTL_QUEUE_SIZE			2048
+// Size of the coalescing table (power of 2, larger than the queue).
+#define TROWA_EXT_CTL_COALESCE_SIZE		4096
+// Max values in one bulk write (a whole trigSeq64 pattern, 16 channels x 64 steps).
+#define TROWA_EXT_CTL_BULK_MAX_VALS		1024
+// Number of bulk writes that can be waiting at once.
+#define TROWA_EXT_CTL_BULK_BLOCKS			4
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSExternalControlQueue
+// Bounded lock-free multi-producer, single-consumer queue of external control
+// messages (OSC listener -> audio thread). Producers never block: if the queue is
+// full the message is dropped and counted.
+// The consumer drains everything waiting once per block into a batch. Absolute
+// writes to the same key (a step value, the BPM/tempo) collapse into the last
+// value, as long as no other kind of message sits between them (order is kept).
+// Bulk writes (i.e. a whole pattern) are one message; the values go in a
+// preallocated block (acquireBulk()) that the consumer hands back (releaseBulk()).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+class TSExternalControlQueue
+{
+public:
+	TSExternalControlQueue();
+
+	// Values of a bulk write.
+	struct BulkValues {
+		// Number of values.
+		int numVals;
+		// If the values are the whole pattern (channel after channel), else one channel.
+		bool wholePattern;
+		// The values (step after step).
+		float vals[TROWA_EXT_CTL_BULK_MAX_VALS];
+	};
+
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// push()
+	// (Producer, any thread) Queue a message.
+	// @msg : (IN) The message.
+	// @returns : False if the queue is full (message dropped).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	bool push(const TSExternalControlMessage& msg);
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// drain()
+	// (Consumer) Move everything waiting into the batch, coalescing by key.
+	// @returns : The number of messages in the batch (see at()).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	int drain();
+	// (Consumer) Message @ix from the last drain().
+	const TSExternalControlMessage& at(int ix) const { return batch[ix]; }
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// acquireBulk()
+	// (Producer, any thread) Get a free bulk block. Fill it, then push() the
+	// message with its index in mode (or releaseBulk() it if the push fails).
+	// @ix : (OUT) The block index.
+	// @returns : The block, NULL if they are all waiting (write dropped and counted).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	BulkValues* acquireBulk(int* ix);
+	// (Consumer) The bulk block of a message.
+	const BulkValues* getBulk(int ix) const { return &(bulk[ix]); }
+	// (Consumer, or producer if push() failed) Done with the bulk block.
+	void releaseBulk(int ix) { bulkInUse[ix].store(false, std::memory_order_release); }
+
+	// Messages received (queued or dropped).
+	uint32_t getReceivedCount() const { return receivedCount.load(std::memory_order_relaxed); }
+	// Messages replaced by a later write to the same key.
+	uint32_t getCoalescedCount() const { return coalescedCount.load(std::memory_order_relaxed); }
+	// Messages dropped because the queue was full.
+	uint32_t getOverflowCount() const { return overflowCount.load(std::memory_order_relaxed); }
+private:
+	// Queue slot (sequence tells producers/consumer whose turn it is).
+	struct Cell {
+		std::atomic<uint32_t> sequence;
+		TSExternalControlMessage msg;
+	};
+	// Coalescing table entry (valid if generation is the current one).
+	struct CoalesceEntry {
+		uint32_t key;
+		uint32_t generation;
+		int batchIx;
+	};
+	Cell cells[TROWA_EXT_CTL_QUEUE_SIZE];
+	std::atomic<uint32_t> enqueuePos { 0 };
+	// Consumer only.
+	uint32_t dequeuePos = 0;
+	// Last drain.
+	TSExternalControlMessage batch[TROWA_EXT_CTL_QUEUE_SIZE];
+	CoalesceEntry coalesceTable[TROWA_EXT_CTL_COALESCE_SIZE];
+	// Bulk write blocks and which ones are taken.
+	BulkValues bulk[TROWA_EXT_CTL_BULK_BLOCKS];
+	std::atomic<bool> bulkInUse[TROWA_EXT_CTL_BULK_BLOCKS];
+	// Current coalescing generation (bumped at each barrier, 0 is never valid).
+	uint32_t generation = 1;
+	// How step writes in this generation are addressed (current/explicit pattern/channel, -1 for none).
+	int stepAddressing = -1;
+	std::atomic<uint32_t> receivedCount { 0 };
+	std::atomic<uint32_t> coalescedCount { 0 };
+	std::atomic<uint32_t> overflowCount { 0 };
+
+	// (Consumer) Pop the oldest message. False if empty.
+	bool pop(TSExternalControlMessage* msg);
+	// (Consumer) Nothing before this point may be coalesced with anything after.
+	void barrier();
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// getCoalesceKey()
+	// @msg : (IN) The message.
+	// @key : (OUT) Key of the state it writes.
+	// @addressing : (OUT) For step writes, if pattern/channel are the current ones.
+	// @returns : True if the message is an absolute write that can be coalesced.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	static bool getCoalesceKey(const TSExternalControlMessage& msg, uint32_t* key, int* addressing);
+};
+
+#endif // !TSEXTERNALCONTROLQUEUE_HPP
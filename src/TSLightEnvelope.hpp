@@ -0,0 +1,107 @@
+#ifndef TSLIGHTENVELOPE_HPP
+#define TSLIGHTENVELOPE_HPP
+
+#include <rack.hpp>
+using namespace rack;
+#include <stdint.h>
+#include <math.h>
+
+// Frames between light updates (lights are evaluated at this control rate, not every sample).
+#define TROWA_LIGHT_ENV_DIVISION		32
+// Level under which a decaying light is off.
+#define TROWA_LIGHT_ENV_MIN_LEVEL		0.001f
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSLightEnvelope
+// A decaying light. Only the level and the frame of the last trigger are kept;
+// the decayed value is worked out when the light is updated (see TSLightClock)
+// instead of decrementing every light every sample.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSLightEnvelope
+{
+	// Level at the trigger (0 is off).
+	float level = 0.0f;
+	// Frame of the trigger.
+	uint32_t triggerFrame = 0;
+
+	// Light to @lvl at @frame.
+	void trigger(uint32_t frame, float lvl = 1.0f)
+	{
+		level = lvl;
+		triggerFrame = frame;
+		return;
+	}
+	// Turn off.
+	void reset()
+	{
+		level = 0.0f;
+		return;
+	}
+	// If the light has not fully decayed.
+	bool isActive() const { return level > 0.0f; }
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// exponential()
+	// Exponential decay (what v -= v / tau * dt every sample does).
+	// @frame : (IN) The current frame.
+	// @tauFrames : (IN) Time constant in frames (tau * sample rate).
+	// @returns : The light value now.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	float exponential(uint32_t frame, float tauFrames)
+	{
+		if (level <= 0.0f)
+			return 0.0f;
+		float v = level * expf(-static_cast<float>(frame - triggerFrame) / tauFrames);
+		if (v < TROWA_LIGHT_ENV_MIN_LEVEL)
+		{
+			// Done. Stop evaluating (also so the frame counter wrapping never relights it).
+			level = 0.0f;
+			v = 0.0f;
+		}
+		return v;
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// linear()
+	// Linear decay (what v -= step every sample does).
+	// @frame : (IN) The current frame.
+	// @stepPerFrame : (IN) Amount to lose every frame.
+	// @returns : The light value now.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	float linear(uint32_t frame, float stepPerFrame)
+	{
+		if (level <= 0.0f)
+			return 0.0f;
+		float v = level - static_cast<float>(frame - triggerFrame) * stepPerFrame;
+		if (v <= 0.0f)
+		{
+			level = 0.0f;
+			v = 0.0f;
+		}
+		return v;
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSLightClock
+// Frame counter for a module's light envelopes and the divider that says when
+// to write the lights.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSLightClock
+{
+	// Current frame.
+	uint32_t frame = 0;
+	dsp::ClockDivider divider;
+
+	TSLightClock()
+	{
+		divider.setDivision(TROWA_LIGHT_ENV_DIVISION);
+		return;
+	}
+	// Advance one frame. Returns true if the lights should be written this frame.
+	bool process()
+	{
+		frame++;
+		return divider.process();
+	}
+};
+
+#endif // !TSLIGHTENVELOPE_HPP
@@ -2,6 +2,7 @@
 #define TSOSCCV_BASELISTENER_HPP
 
 #include "TSOSCCV_Common.hpp"
+#include "TSOSCCommunicator.hpp"
 #include <mutex>
 #include <map>
 #include <vector>
@@ -85,8 +86,12 @@ protected:
 template<class T>
 struct OscRxDetails
 {
-	// Receiving OSC socket.
-	UdpListeningReceiveSocket* oscRxSocket = NULL;
+	// Receiving OSC socket (may also be in multicast groups).
+	TSOSCListeningSocket* oscRxSocket = NULL;
+#if TROWA_OSC_LOCAL_TRANSPORT
+	// Receiving local socket (instead of oscRxSocket for the local transport).
+	TSOSCLocalListeningSocket* localRxSocket = NULL;
+#endif
 	// The port.
 	uint16_t port;
 	// The message router.
@@ -114,6 +119,17 @@ struct OscRxDetails
 			
 			delete router;
 		}					
+#if TROWA_OSC_LOCAL_TRANSPORT
+		if (localRxSocket != NULL)
+		{
+			localRxSocket->AsynchronousBreak();
+			oscListenerThread.join();
+			delete localRxSocket;
+			localRxSocket = NULL;
+
+			delete router;
+		}
+#endif
 	}
 };
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -134,6 +150,8 @@ private:
 	static TSOSCRxConnector<T, R>* _instance;
 	// The ports that are receiving messages.
 	std::map<uint16_t, OscRxDetails<T>*> _portMap;
+	// The local transport ports that are receiving messages.
+	std::map<uint16_t, OscRxDetails<T>*> _localPortMap;
 	// Clean up thread and everything.
 	//void cleanUpListener(OscRxDetails<T>* details);
 	// Port mutex.
@@ -145,14 +163,24 @@ public:
 			TSOSCRxConnector<T, R>::_instance = new TSOSCRxConnector<T, R>();
 		return _instance;	
 	}
-	bool startListener(uint16_t rxPort, T* module)
+	//--------------------------------------------------------
+	// startListener()
+	// @rxPort : (IN) The port.
+	// @module : (IN) The module that wants the messages.
+	// @multicastGroup : (IN) (Opt) Multicast group to join on the port.
+	// @local : (IN) (Opt) Use the local transport (unix domain socket named by the port) instead of UDP.
+	// @returns : True if listening.
+	//--------------------------------------------------------
+	bool startListener(uint16_t rxPort, T* module, const char* multicastGroup = NULL, bool local = false)
 	{
 		std::lock_guard<std::mutex> lock(_mutex);
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
 		DEBUG("TSOSCRxConnector::startListener(port %d) - Starting for module id %d.", rxPort,  module->id);
 #endif	
 		bool success = false;
-		OscRxDetails<T>* item = (_portMap.count(rxPort) < 1) ? NULL : _portMap[rxPort];
+		std::map<uint16_t, OscRxDetails<T>*>& portMap = (local) ? _localPortMap : _portMap;
+		OscRxDetails<T>* item = (portMap.count(rxPort) < 1) ? NULL : portMap[rxPort];
+		bool isNew = item == NULL;
 		if (item == NULL)
 		{
 			item = new OscRxDetails<T>(rxPort);
@@ -168,28 +196,66 @@ public:
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
 		DEBUG("TSOSCRxConnector::startListener(port %d) - Add module to router module list. Now it has %d items.", rxPort, item->router->modules.size());
 #endif	
-		if (item->oscRxSocket == NULL)
+		try
 		{
+#if TROWA_OSC_LOCAL_TRANSPORT
+			if (local)
+			{
+				if (item->localRxSocket == NULL)
+				{
+					item->localRxSocket = new TSOSCLocalListeningSocket(rxPort, item->router);
+					item->oscListenerThread = std::thread(&TSOSCLocalListeningSocket::Run, item->localRxSocket);
+				}
+			}
+			else
+#endif
+			if (item->oscRxSocket == NULL)
+			{
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
-			DEBUG("TSOSCRxConnector::startListener(port %d) - Creating Rx socket and starting listener thread.", rxPort);
+				DEBUG("TSOSCRxConnector::startListener(port %d) - Creating Rx socket and starting listener thread.", rxPort);
 #endif		
-			item->oscRxSocket = new UdpListeningReceiveSocket(IpEndpointName(IpEndpointName::ANY_ADDRESS, rxPort), item->router);
-			// Start the thread
-			item->oscListenerThread = std::thread(&UdpListeningReceiveSocket::Run, item->oscRxSocket);
+				item->oscRxSocket = new TSOSCListeningSocket(rxPort, item->router, multicastGroup);
+				// Start the thread
+				item->oscListenerThread = std::thread(&TSOSCListeningSocket::Run, item->oscRxSocket);
+			}
+			else if (multicastGroup != NULL)
+			{
+				// Already listening on this port, just join (the listener thread is blocked in select(), this is safe)
+				item->oscRxSocket->joinGroup(multicastGroup);
+			}
+			portMap[rxPort] = item;
+			success = true;
+		}
+		catch (const std::exception& ex)
+		{
+			WARN("TSOSCRxConnector::startListener(port %d) - Error listening: %s.", rxPort, ex.what());
+			item->router->removeModule(module);
+			if (isNew)
+			{
+				delete item->router;
+				delete item;
+			}
 		}
-		_portMap[rxPort] = item;
-		success = true;
 		return success;		
 	} // end startListener()
-	bool stopListener(uint16_t rxPort, T* module)
+	//--------------------------------------------------------
+	// stopListener()
+	// @rxPort : (IN) The port.
+	// @module : (IN) The module that no longer wants the messages.
+	// @multicastGroup : (IN) (Opt) Multicast group the module joined in startListener().
+	// @local : (IN) (Opt) The module used the local transport.
+	// @returns : True if the port was found.
+	//--------------------------------------------------------
+	bool stopListener(uint16_t rxPort, T* module, const char* multicastGroup = NULL, bool local = false)
 	{
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
 		DEBUG("TSOSCRxConnector::stopListener(port %d, id=%d) - Stopping listener for module id %d.", rxPort, module->id, module->id);
 #endif			
 		std::lock_guard<std::mutex> lock(_mutex);	
 		bool success = false;
-		typename std::map<uint16_t, OscRxDetails<T>*>::iterator it = _portMap.find(rxPort);
-		OscRxDetails<T>* item = (it == _portMap.end()) ? NULL : it->second;
+		std::map<uint16_t, OscRxDetails<T>*>& portMap = (local) ? _localPortMap : _portMap;
+		typename std::map<uint16_t, OscRxDetails<T>*>::iterator it = portMap.find(rxPort);
+		OscRxDetails<T>* item = (it == portMap.end()) ? NULL : it->second;
 		if (item != NULL)
 		{
 			if (item->router != NULL)
@@ -199,6 +265,10 @@ public:
 #endif					
 				item->router->removeModule(module); // Remove this module from the list.
 			}		
+			if (item->oscRxSocket != NULL && multicastGroup != NULL)
+			{
+				item->oscRxSocket->leaveGroup(multicastGroup);
+			}
 			if (item->router == NULL || item->router->modules.size() < 1)
 			{
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
@@ -208,7 +278,7 @@ public:
 				// No more registered, remove.
 				item->cleanUp();
 				delete it->second;			
-				_portMap.erase(it);
+				portMap.erase(it);
 			}
 			success = true;
 		}
@@ -221,13 +291,13 @@ public:
 		return success;			
 	} // end stopListener()
 	
-	static bool StartListener(uint16_t rxPort, T* module)
+	static bool StartListener(uint16_t rxPort, T* module, const char* multicastGroup = NULL, bool local = false)
 	{
-		return Connector()->startListener(rxPort, module);
+		return Connector()->startListener(rxPort, module, multicastGroup, local);
 	}
-	static bool StopListener(uint16_t rxPort, T* module)
+	static bool StopListener(uint16_t rxPort, T* module, const char* multicastGroup = NULL, bool local = false)
 	{
-		return Connector()->stopListener(rxPort, module);
+		return Connector()->stopListener(rxPort, module, multicastGroup, local);
 	}	
 };
 
@@ -1,32 +1,253 @@
 
 #include "TSOSCCV_Common.hpp"
+#include <cstring>
+
+// Last namespace version handed out (all masters).
+static std::atomic<uint32_t> lastNamespaceVersion { 0 };
+
+// Next namespace version (process-wide, never 0).
+uint32_t TSOSCCVNextNamespaceVersion()
+{
+	uint32_t ver = ++lastNamespaceVersion;
+	if (ver == 0)
+		ver = ++lastNamespaceVersion; // Wrapped
+	return ver;
+}
+
+// Write 32-bit value in network (big endian) order.
+static inline void writeOscUInt32(char* p, uint32_t x)
+{
+	p[0] = static_cast<char>((x >> 24) & 0xFF);
+	p[1] = static_cast<char>((x >> 16) & 0xFF);
+	p[2] = static_cast<char>((x >> 8) & 0xFF);
+	p[3] = static_cast<char>(x & 0xFF);
+}
+// Round up to the next multiple of 4 (OSC alignment).
+static inline int roundUp4(int x)
+{
+	return (x + 3) & ~0x03;
+}
+
+//--------------------------------------------------------
+// build()
+// @oscNamespace : (IN) The namespace (without '/').
+// @path : (IN) The channel path.
+// @argTag : (IN) The type tag for the arguments.
+// @nArgs : (IN) The number of arguments.
+// Encode the address and type tags.
+//--------------------------------------------------------
+void TSOSCCVMsgTemplate::build(const std::string& oscNamespace, const std::string& path, char argTag, int nArgs)
+{
+	std::memset(header, 0, TROWA_OSCCV_MSG_TEMPLATE_SIZE);
+	// Address ('/' + namespace + path). Allow empty namespaces. Truncate if too long (leave room for the null).
+	int len = 0;
+	if (!oscNamespace.empty())
+	{
+		header[len++] = '/';
+		int n = std::min(static_cast<int>(oscNamespace.length()), TROWA_OSCCV_MSG_ADDRESS_SIZE - 1 - len);
+		std::memcpy(header + len, oscNamespace.c_str(), n);
+		len += n;
+	}
+	int n = std::min(static_cast<int>(path.length()), TROWA_OSCCV_MSG_ADDRESS_SIZE - 1 - len);
+	std::memcpy(header + len, path.c_str(), n);
+	len += n;
+	len = roundUp4(len + 1);
+	// Type tags
+	nArgs = clamp(nArgs, 0, TROWA_OSCCV_VECTOR_MAX_SIZE);
+	header[len] = ',';
+	typeTagsIx = len + 1;
+	for (int i = 0; i < nArgs; i++)
+	{
+		header[typeTagsIx + i] = argTag;
+	}
+	headerSize = len + roundUp4(nArgs + 2); // ',' + tags + null
+	numArgs = nArgs;
+	argTypeTag = argTag;
+	return;
+} // end build()
+
+//--------------------------------------------------------
+// write()
+// @buffer : (OUT) Where to write the message. Must have getMessageSize() bytes.
+// @vals : (IN) The argument values (numArgs of them).
+// @returns : The number of bytes written.
+//--------------------------------------------------------
+int TSOSCCVMsgTemplate::write(char* buffer, const float* vals)
+{
+	std::memcpy(buffer, header, headerSize);
+	char* argPtr = buffer + headerSize;
+	for (int i = 0; i < numArgs; i++)
+	{
+		switch (argTypeTag)
+		{
+		case 'T':
+			// Bools have no argument data, just the type tag.
+			buffer[typeTagsIx + i] = (static_cast<bool>(vals[i])) ? 'T' : 'F';
+			break;
+		case 'i':
+			writeOscUInt32(argPtr, static_cast<uint32_t>(static_cast<int32_t>(vals[i])));
+			argPtr += 4;
+			break;
+		case 'f':
+		default:
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &(vals[i]), 4);
+			writeOscUInt32(argPtr, bits);
+			argPtr += 4;
+			break;
+		}
+		}
+	}
+	return static_cast<int>(argPtr - buffer);
+} // end write()
 
 //--------------------------------------------------------
-// addValToBuffer()
-// Add a value to the buffer.
-// @buffVal : (IN) The value to possibly add.
+// addMessage()
+// @msgTemplate : (IN) The pre-encoded message.
+// @vals : (IN) The argument values.
+// @returns : True if added, false if there is no room.
+// Adds the message to the current bundle (opens the bundle if needed).
+// If the message would make the bundle larger than maxPacketSize, a new bundle is started.
 //--------------------------------------------------------
-void TSOSCCVChannel::addValToBuffer(float buffVal)
+bool TSOSCCVBundleWriter::addMessage(TSOSCCVMsgTemplate* msgTemplate, const float* vals)
 {
-	float deltaTime = powf(2.0, -12.0);
-	int frameCount = (int)ceilf(deltaTime * APP->engine->getSampleRate());
-	// Add frame to buffer
-	if (valBuffIx < TROWA_OSCCV_VAL_BUFFER_SIZE) {
-		if (++frameIx > frameCount) {
-			frameIx = 0;
-			valBuffer[valBuffIx++] = buffVal;
+	if (msgTemplate->headerSize < 1)
+		return true; // Not built yet (path being edited), nothing to send
+	char* msg = beginElement(msgTemplate->getMessageSize());
+	if (msg == NULL)
+		return false;
+	msgTemplate->write(msg, vals);
+	return true;
+} // end addMessage()
+//--------------------------------------------------------
+// addEncodedMessage()
+// @msg : (IN) An encoded message (i.e. from an expander).
+// @msgSize : (IN) The size of the message.
+// @returns : True if added, false if there is no room.
+//--------------------------------------------------------
+bool TSOSCCVBundleWriter::addEncodedMessage(const char* msg, int msgSize)
+{
+	char* dst = beginElement(msgSize);
+	if (dst == NULL)
+		return false;
+	std::memcpy(dst, msg, msgSize);
+	return true;
+} // end addEncodedMessage()
+//--------------------------------------------------------
+// beginElement()
+// Make room for a message of @msgSize in the current bundle (opens/starts a bundle if needed).
+// @returns : Where to write the message, NULL if there is no room.
+//--------------------------------------------------------
+char* TSOSCCVBundleWriter::beginElement(int msgSize)
+{
+	int elementSize = 4 + msgSize; // Size + message
+	bool newPacket = numPackets < 1;
+	if (!newPacket && maxPacketSize > 0 && size - packetStart + elementSize > maxPacketSize)
+		newPacket = true; // Won't fit in this datagram, start another bundle
+	int required = size + elementSize + ((newPacket) ? TROWA_OSCCV_BUNDLE_HEADER_SIZE : 0);
+	if (buffer == NULL || required > capacity || (newPacket && numPackets >= TROWA_OSCCV_MAX_TX_PACKETS))
+		return NULL;
+	if (newPacket)
+	{
+		// Begin (immediate) bundle
+		packetStart = size;
+		std::memcpy(buffer + size, "#bundle\0", 8);
+		writeOscUInt32(buffer + size + 8, 0);
+		writeOscUInt32(buffer + size + 12, 1);
+		size += TROWA_OSCCV_BUNDLE_HEADER_SIZE;
+		numPackets++;
+	}
+	writeOscUInt32(buffer + size, static_cast<uint32_t>(msgSize));
+	char* msg = buffer + size + 4;
+	size += elementSize;
+	packetEnds[numPackets - 1] = size;
+	return msg;
+} // end beginElement()
+
+//--------------------------------------------------------
+// updateChart()
+// [UI thread] Rebuild the chart points if needed (oldest on the left, one min/max pair per column).
+// Works from a snapshot of the completed buckets; the bucket the audio thread writes next is never read.
+// @width : (IN) Chart width (px).
+// @height : (IN) Chart height (px).
+// @minV : (IN) Value at the bottom.
+// @maxV : (IN) Value at the top.
+// @returns : The chart.
+//--------------------------------------------------------
+const TSOSCCVValueHistory::ChartCache& TSOSCCVValueHistory::updateChart(int width, int height, float minV, float maxV)
+{
+	uint32_t n = writeCount.load(std::memory_order_acquire);
+	ChartCache& cache = chartCache;
+	if (cache.valid && cache.writeCount == n && cache.width == width && cache.height == height && cache.minV == minV && cache.maxV == maxV)
+		return cache; // Nothing new
+	// Snapshot the buckets, oldest first. Slot n is the next one to be written (skip it).
+	const int numBuckets = TROWA_OSCCV_VAL_BUFFER_SIZE - 1;
+	for (int i = 0; i < numBuckets; i++)
+	{
+		int ix = (n + 1 + i) % TROWA_OSCCV_VAL_BUFFER_SIZE;
+		cache.snapMin[i] = minVals[ix];
+		cache.snapMax[i] = maxVals[ix];
+	}
+	// If the audio thread wrote m buckets while we copied, our first m (and the one it may be on) are newer
+	// than the rest. Treat them as the oldest value we have.
+	uint32_t overrun = writeCount.load(std::memory_order_acquire) - n;
+	if (overrun > 0)
+	{
+		int k = (overrun < static_cast<uint32_t>(numBuckets)) ? static_cast<int>(overrun) : numBuckets - 1;
+		for (int i = 0; i < k; i++)
+		{
+			cache.snapMin[i] = cache.snapMin[k];
+			cache.snapMax[i] = cache.snapMax[k];
 		}
 	}
-	else {
-		frameIx++;
-		const float holdTime = 0.1;
-		if (frameIx >= APP->engine->getSampleRate() * holdTime) {
-			valBuffIx = 0;
-			frameIx = 0;
+	int numCols = clamp(width, 1, numBuckets);
+	if (static_cast<int>(cache.xs.size()) < numCols * 2)
+	{
+		cache.xs.resize(numCols * 2);
+		cache.ys.resize(numCols * 2);
+	}
+	float dx = static_cast<float>(width) / numCols;
+	float range = (maxV != minV) ? maxV - minV : 1.0f;
+	float prevY = static_cast<float>(height);
+	int nPts = 0;
+	for (int col = 0; col < numCols; col++)
+	{
+		// Buckets in this column
+		int b0 = col * numBuckets / numCols;
+		int b1 = (col + 1) * numBuckets / numCols;
+		float lo = cache.snapMin[b0];
+		float hi = cache.snapMax[b0];
+		for (int b = b0 + 1; b < b1; b++)
+		{
+			if (cache.snapMin[b] < lo)
+				lo = cache.snapMin[b];
+			if (cache.snapMax[b] > hi)
+				hi = cache.snapMax[b];
 		}
+		float yLo = height - (lo - minV) / range * height;
+		float yHi = height - (hi - minV) / range * height;
+		float x = col * dx;
+		// Go to the closer end first so the line stays continuous
+		bool hiFirst = std::abs(yHi - prevY) < std::abs(yLo - prevY);
+		cache.xs[nPts] = x;
+		cache.ys[nPts++] = (hiFirst) ? yHi : yLo;
+		if (yLo != yHi)
+		{
+			cache.xs[nPts] = x;
+			cache.ys[nPts++] = (hiFirst) ? yLo : yHi;
+		}
+		prevY = cache.ys[nPts - 1];
 	}
-	return;
-} // end addValToBuffer()
+	cache.numPoints = nPts;
+	cache.writeCount = n;
+	cache.width = width;
+	cache.height = height;
+	cache.minV = minV;
+	cache.maxV = maxV;
+	cache.valid = true;
+	return cache;
+} // end updateChart()
 
 //--------------------------------------------------------
 // serialize()
@@ -88,6 +309,11 @@ json_t* TSOSCCVInputChannel::serialize()
 {
 	json_t* channelJ = this->TSOSCCVChannel::serialize();
 	json_object_set_new(channelJ, "channelSensitivity", json_real(channelSensitivity));
+	json_object_set_new(channelJ, "maxSendRate", json_real(maxSendRate_Hz));
+	json_object_set_new(channelJ, "adaptiveDeadband", json_boolean(adaptiveDeadband));
+	json_object_set_new(channelJ, "adaptiveDeadbandMult", json_real(adaptiveDeadbandMult));
+	json_object_set_new(channelJ, "significantChange", json_real(significantChange));
+	json_object_set_new(channelJ, "significantSendWithinMs", json_real(significantSendWithin_ms));
 	return channelJ;
 } // end serialize()
 //--------------------------------------------------------
@@ -101,6 +327,169 @@ void TSOSCCVInputChannel::deserialize(json_t* rootJ) {
 		currJ = json_object_get(rootJ, "channelSensitivity");
 		if (currJ)
 			channelSensitivity = json_number_value(currJ);
+		currJ = json_object_get(rootJ, "maxSendRate");
+		if (currJ)
+			maxSendRate_Hz = clamp(static_cast<float>(json_number_value(currJ)), 0.0f, static_cast<float>(TROWA_OSCCV_MAX_SEND_HZ));
+		currJ = json_object_get(rootJ, "adaptiveDeadband");
+		if (currJ)
+			adaptiveDeadband = json_boolean_value(currJ);
+		currJ = json_object_get(rootJ, "adaptiveDeadbandMult");
+		if (currJ)
+			adaptiveDeadbandMult = json_number_value(currJ);
+		currJ = json_object_get(rootJ, "significantChange");
+		if (currJ)
+			significantChange = json_number_value(currJ);
+		currJ = json_object_get(rootJ, "significantSendWithinMs");
+		if (currJ)
+			significantSendWithin_ms = json_number_value(currJ);
 	}
 	return;
-} // end deserialize()
\ No newline at end of file
+} // end deserialize()
+//--------------------------------------------------------
+// onReceived()
+// Update the interval estimate and start the next segment.
+//--------------------------------------------------------
+void TSOSCCVOutputChannel::onReceived()
+{
+	// Estimate how often values come in (ignore long gaps, the controller probably just stopped moving).
+	if (timeSinceRx > 0.0f && timeSinceRx <= TROWA_OSCCV_MAX_RX_INTERVAL)
+	{
+		float measured = std::max(timeSinceRx, TROWA_OSCCV_MIN_RX_INTERVAL);
+		rxInterval = (rxInterval > 0.0f) ? rxInterval + (measured - rxInterval) * 0.25f : measured;
+	}
+	timeSinceRx = 0.0f;
+	bool interpolate = (smoothMode == SmoothMode::SmoothLinear || smoothMode == SmoothMode::SmoothCubic) && rxInterval > 0.0f;
+	for (int i = 0; i < numVals; i++)
+	{
+		if (i >= segNumVals)
+		{
+			// New poly channel, nothing to smooth from
+			outVals[i] = translatedVals[i];
+			targetVals[i] = translatedVals[i];
+			startSlopes[i] = 0.0f;
+		}
+		if (smoothMode == SmoothMode::SmoothCubic && segPhase < 1.0f && segDuration > 0.0f)
+		{
+			// Slope where we are now on the current curve, so the next one joins smoothly.
+			float t = segPhase;
+			float m0 = startSlopes[i] * segDuration;
+			float m1 = targetVals[i] - prevTargetVals[i];
+			float dp = (6.0f * t * t - 6.0f * t) * startVals[i] + (3.0f * t * t - 4.0f * t + 1.0f) * m0
+				+ (-6.0f * t * t + 6.0f * t) * targetVals[i] + (3.0f * t * t - 2.0f * t) * m1;
+			startSlopes[i] = dp / segDuration;
+		}
+		else if (smoothMode == SmoothMode::SmoothCubic)
+		{
+			startSlopes[i] = 0.0f; // We were holding
+		}
+		prevTargetVals[i] = targetVals[i];
+		startVals[i] = outVals[i];
+		targetVals[i] = translatedVals[i];
+		if (!interpolate && smoothMode != SmoothMode::SmoothSlew)
+			outVals[i] = targetVals[i];
+	}
+	segNumVals = numVals;
+	segDuration = clamp(rxInterval, TROWA_OSCCV_MIN_RX_INTERVAL, TROWA_OSCCV_MAX_RX_INTERVAL);
+	segPhase = (interpolate) ? 0.0f : 1.0f;
+	return;
+} // end onReceived()
+
+//--------------------------------------------------------
+// process()
+// @dt : (IN) Sample time (s).
+// Calculate outVals for this sample.
+//--------------------------------------------------------
+void TSOSCCVOutputChannel::process(float dt)
+{
+	timeSinceRx += dt;
+	switch (smoothMode)
+	{
+	case SmoothMode::SmoothLinear:
+	case SmoothMode::SmoothCubic:
+		if (segPhase < 1.0f)
+		{
+			segPhase = std::min(segPhase + dt / segDuration, 1.0f);
+			float t = segPhase;
+			if (smoothMode == SmoothMode::SmoothLinear)
+			{
+				for (int i = 0; i < numVals; i++)
+					outVals[i] = startVals[i] + (targetVals[i] - startVals[i]) * t;
+			}
+			else
+			{
+				// Hermite basis
+				float t2 = t * t;
+				float t3 = t2 * t;
+				float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+				float h10 = t3 - 2.0f * t2 + t;
+				float h01 = -2.0f * t3 + 3.0f * t2;
+				float h11 = t3 - t2;
+				for (int i = 0; i < numVals; i++)
+				{
+					float m0 = startSlopes[i] * segDuration;
+					float m1 = targetVals[i] - prevTargetVals[i];
+					outVals[i] = h00 * startVals[i] + h10 * m0 + h01 * targetVals[i] + h11 * m1;
+				}
+			}
+		}
+		else
+		{
+			for (int i = 0; i < numVals; i++)
+				outVals[i] = targetVals[i];
+		}
+		break;
+	case SmoothMode::SmoothSlew:
+	{
+		float tau = (slewTime_ms > 0.0f) ? slewTime_ms * 0.001f : rxInterval * 0.5f;
+		if (tau != slewCoeffTau || dt != slewCoeffDt)
+		{
+			// Only recalculate when the time constant or sample rate changes
+			slewCoeff = (tau > 0.0f) ? 1.0f - std::exp(-dt / tau) : 1.0f;
+			slewCoeffTau = tau;
+			slewCoeffDt = dt;
+		}
+		for (int i = 0; i < numVals; i++)
+			outVals[i] += (targetVals[i] - outVals[i]) * slewCoeff;
+		break;
+	}
+	case SmoothMode::SmoothNone:
+	default:
+		for (int i = 0; i < numVals; i++)
+			outVals[i] = translatedVals[i];
+		break;
+	}
+	return;
+} // end process()
+
+//--------------------------------------------------------
+// serialize()
+// @returns : The channel json node.
+//--------------------------------------------------------
+json_t* TSOSCCVOutputChannel::serialize()
+{
+	json_t* channelJ = this->TSOSCCVChannel::serialize();
+	json_object_set_new(channelJ, "smoothMode", json_integer(smoothMode));
+	json_object_set_new(channelJ, "slewTimeMs", json_real(slewTime_ms));
+	json_object_set_new(channelJ, "rxLatestOnly", json_boolean(rxLatestOnly));
+	return channelJ;
+} // end serialize()
+//--------------------------------------------------------
+// deserialize()
+// @rootJ : (IN) The channel json node.
+//--------------------------------------------------------
+void TSOSCCVOutputChannel::deserialize(json_t* rootJ) {
+	if (rootJ) {
+		this->TSOSCCVChannel::deserialize(rootJ);
+		json_t* currJ = NULL;
+		currJ = json_object_get(rootJ, "smoothMode");
+		if (currJ)
+			smoothMode = static_cast<SmoothMode>(clamp(static_cast<int>(json_integer_value(currJ)), 0, SmoothMode::NUM_SMOOTH_MODES - 1));
+		currJ = json_object_get(rootJ, "slewTimeMs");
+		if (currJ)
+			slewTime_ms = json_number_value(currJ);
+		currJ = json_object_get(rootJ, "rxLatestOnly");
+		rxLatestOnly = (currJ) ? json_is_true(currJ) : false;
+		resetSmoothing();
+	}
+	return;
+} // end deserialize()
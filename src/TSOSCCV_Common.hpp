@@ -6,8 +6,12 @@ using namespace rack;
 #include "trowaSoft.hpp"
 #include "trowaSoftUtilities.hpp"
 #include "TSOSCCommon.hpp"
+#include "TSLightEnvelope.hpp"
 #include <mutex>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <string.h>
 
 #define TROWA_OSCCVEXPANDER_DEFAULT_NUM_CHANNELS	16 // Default # channels for expander
 
@@ -16,7 +20,8 @@ using namespace rack;
 #define TROWA_OSCCV_DEFAULT_NAMESPACE		   "" // Default namespace for this module (should not be the same as the sequencers). Now Blank was 'trowacv'.
 #define TROWA_OSCCV_MAX_VOLTAGE				 10.0 // Max output voltage
 #define TROWA_OSCCV_MIN_VOLTAGE				-10.0 // Min output voltage
-#define TROWA_OSCCV_VAL_BUFFER_SIZE			  512 // Buffer size for value history
+#define TROWA_OSCCV_VAL_BUFFER_SIZE			  512 // Buffer size (buckets) for value history
+#define TROWA_OSCCV_VAL_BUCKET_TIME	  (1.0f/4096) // Time (s) per value history bucket.
 #define TROWA_OSCCV_TRIGGER_ON_V			 10.0 // Trigger on/high output voltage
 #define TROWA_OSCCV_TRIGGER_OFF_V			  0.0 // Trigger off/low output voltage
 #define TROWA_OSCCV_MIDI_VALUE_MIN_V		     -5 // -5v : Midi Value 0 (C-1)
@@ -24,9 +29,27 @@ using namespace rack;
 #define TROWA_OSCCV_MIDI_VALUE_MIN		         0 // Midi value 0
 #define TROWA_OSCCV_MIDI_VALUE_MAX			   127 // Midi value 127
 #define TROWA_OSCCV_DEFAULT_SEND_HZ			   100 // If no trigger input, bang out OSC when val changes this many times per second.
+#define TROWA_OSCCV_MAX_SEND_HZ			  1000 // Max per-channel send rate (Hz).
 #define TROWA_OSCCV_NUM_LIGHTS_PER_CHANNEL		2
+#define TROWA_OSCCV_DEFAULT_SENSITIVITY		 0.05f // Default change needed (deadband) before a CV->OSC channel sends.
+#define TROWA_OSCCV_ADAPTIVE_DEADBAND_MULT	  3.0f // Adaptive deadband = this * noise (std dev of sample to sample change).
+#define TROWA_OSCCV_NOISE_TIME_CONSTANT		 0.05f // Time constant (s) for the noise estimate of the adaptive deadband.
+#define TROWA_OSCCV_DEFAULT_SIGNIFICANT_CHANGE 0.5f // Default change (V or translated units) that is 'significant'.
+#define TROWA_OSCCV_TIMETAG_IMMEDIATE			 1 // OSC time tag for 'immediately' (also used if the message was not in a bundle).
+#define TROWA_OSCCV_CLOCK_SYNC_SAMPLES		   64 // How often (samples) to re-sync the sample clock with the local clock for Rx scheduling.
+#define TROWA_OSCCV_MAX_JITTER_BUFFER_MS	  100.0f // Max Rx jitter buffer (ms).
+#define TROWA_OSCCV_MAX_SCHEDULE_AHEAD		  1.0 // Max time (s) past the jitter buffer we will hold a message (in case clocks are way off).
+#define TROWA_OSCCV_MIN_RX_INTERVAL		   0.001f // Min estimated time (s) between received values for OSC->CV smoothing.
+#define TROWA_OSCCV_MAX_RX_INTERVAL		    0.25f // Max estimated time (s) between received values for OSC->CV smoothing (longer gaps are not counted).
 
 #define TROWA_OSCCV_VECTOR_MAX_SIZE			engine::PORT_MAX_CHANNELS // Now with polyphonic cables, there can be 16 channels sent in one CV input/output
+#define TROWA_OSCCV_MSG_ADDRESS_SIZE		  512 // Max size of an encoded OSC address (namespace + path) including padding.
+#define TROWA_OSCCV_MSG_TEMPLATE_SIZE		(TROWA_OSCCV_MSG_ADDRESS_SIZE + 20) // Encoded address + type tags (',' + 16 tags + padding).
+#define TROWA_OSCCV_BUNDLE_HEADER_SIZE		   16 // "#bundle\0" + 8 byte time tag.
+#define TROWA_OSCCV_DEFAULT_MAX_PACKET_SIZE	 1472 // Default max UDP payload per datagram (1500 Ethernet MTU - 20 IPv4 - 8 UDP) so we don't get fragmented.
+#define TROWA_OSCCV_MAX_TX_PACKETS			  256 // Max number of datagrams (bundles) we will send in one tick.
+#define TROWA_OSCCV_MAX_CHAIN_LENGTH		   32 // Max number of expanders cached on one side of a master.
+#define TROWA_OSCCV_EXPANDER_TX_BUFFER_SIZE	16384 // Encoded messages the input expanders can pass toward the master per sample.
 
 
 
@@ -35,10 +58,109 @@ using namespace rack;
 #define DEBUG_MAC_OS_POINTER					 0
 #define USE_STATIC_ARRAY						 1 // Use a STATIC array for OSC Message since it seems MAC OS doesn't handle new and delete[] when it's very fast (and vector errors too).
 #define USE_MODULE_STATIC_RX					1 // Debug MAC OS issues. Start keeping a static buffer of msg objects for each module.
-#define OSC_RX_MSG_BUFFER_SIZE				   40 // Debug MAC OS issues. Start keeping a static buffer of msg objects for each module.
+#define OSC_RX_MSG_BUFFER_SIZE				  256 // Debug MAC OS issues. Start keeping a static buffer of msg objects for each module. (Was 40, messages may now wait in the jitter buffer).
 
 
 
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Value history for charting a channel.
+// Audio thread adds samples (decimated into min/max buckets), UI thread reads completed buckets. No locks.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCCVValueHistory {
+	// Min value in each bucket.
+	float minVals[TROWA_OSCCV_VAL_BUFFER_SIZE] = { 0 };
+	// Max value in each bucket.
+	float maxVals[TROWA_OSCCV_VAL_BUFFER_SIZE] = { 0 };
+	// Number of completed buckets (next bucket goes to writeCount % size).
+	std::atomic<uint32_t> writeCount { 0 };
+	// Samples per bucket (calculated when the sample rate changes).
+	int samplesPerBucket = 11;
+	// [Audio thread] Samples in the current bucket.
+	int sampleIx = 0;
+	// [Audio thread] Current bucket min/max.
+	float currMin = 0.0f;
+	float currMax = 0.0f;
+
+	// [UI thread] Chart built from a snapshot of the history. Rebuilt (at most once per UI frame, the display
+	// asks once per channel per draw) when new buckets come in or the chart changes.
+	struct ChartCache {
+		uint32_t writeCount = 0;
+		bool valid = false;
+		int width = 0;
+		int height = 0;
+		float minV = 0.0f;
+		float maxV = 0.0f;
+		// Number of points
+		int numPoints = 0;
+		// Points (relative to the chart's top left).
+		std::vector<float> xs;
+		std::vector<float> ys;
+		// Snapshot of the completed buckets (oldest first).
+		float snapMin[TROWA_OSCCV_VAL_BUFFER_SIZE];
+		float snapMax[TROWA_OSCCV_VAL_BUFFER_SIZE];
+	} chartCache;
+
+	//--------------------------------------------------------
+	// setSampleRate()
+	// @sampleRate : (IN) Engine sample rate.
+	//--------------------------------------------------------
+	void setSampleRate(float sampleRate)
+	{
+		samplesPerBucket = std::max(static_cast<int>(std::ceil(sampleRate * TROWA_OSCCV_VAL_BUCKET_TIME)), 1);
+		sampleIx = 0;
+		return;
+	}
+	// Clear the history.
+	void reset()
+	{
+		for (int i = 0; i < TROWA_OSCCV_VAL_BUFFER_SIZE; i++)
+		{
+			minVals[i] = 0.0f;
+			maxVals[i] = 0.0f;
+		}
+		sampleIx = 0;
+		writeCount++; // So charts rebuild
+		return;
+	}
+	// [Audio thread] Add a sample.
+	void add(float val)
+	{
+		if (sampleIx == 0)
+		{
+			currMin = val;
+			currMax = val;
+		}
+		else if (val < currMin)
+		{
+			currMin = val;
+		}
+		else if (val > currMax)
+		{
+			currMax = val;
+		}
+		if (++sampleIx >= samplesPerBucket)
+		{
+			uint32_t n = writeCount.load(std::memory_order_relaxed);
+			int ix = n % TROWA_OSCCV_VAL_BUFFER_SIZE;
+			minVals[ix] = currMin;
+			maxVals[ix] = currMax;
+			writeCount.store(n + 1, std::memory_order_release);
+			sampleIx = 0;
+		}
+		return;
+	}
+	//--------------------------------------------------------
+	// updateChart()
+	// [UI thread] Rebuild the chart points if needed (oldest on the left, one min/max pair per column).
+	// @width : (IN) Chart width (px).
+	// @height : (IN) Chart height (px).
+	// @minV : (IN) Value at the bottom.
+	// @maxV : (IN) Value at the top.
+	// @returns : The chart.
+	//--------------------------------------------------------
+	const ChartCache& updateChart(int width, int height, float minV, float maxV);
+};
+
 // A channel for OSC.
 struct TSOSCCVChannel {
 	// Base param ids for the channel
@@ -75,12 +197,10 @@ struct TSOSCCVChannel {
 	// Message received.
 	//float msgReceived = 0.0;
 
-	// Value buffer
-	float valBuffer[TROWA_OSCCV_VAL_BUFFER_SIZE] = { 0.0 };
-	// Value buffer current index to insert into.
-	int valBuffIx = 0;
-	// The frame index.
-	int frameIx = 0;
+	// Value history (for the chart).
+	TSOSCCVValueHistory valHistory;
+	// Channel activity light (sent/received).
+	TSLightEnvelope light;
 
 	// Show channel configuration for this channel.
 	dsp::SchmittTrigger showChannelConfigTrigger;
@@ -104,6 +224,8 @@ struct TSOSCCVChannel {
 	bool clipVals = false;
 
 	std::mutex mutPath;
+	// Incremented every time the path changes (so senders know to rebuild their pre-encoded message).
+	std::atomic<uint32_t> pathVersion { 1 };
 
 	TSOSCCVChannel()
 	{
@@ -122,6 +244,7 @@ struct TSOSCCVChannel {
 	}
 
 	virtual void initialize() {
+		pathVersion++; // Path may have been set directly
 		this->convertVals = false;
 		this->val = 0.0;
 		this->translatedVal = getValOSC2CV();
@@ -134,11 +257,7 @@ struct TSOSCCVChannel {
 		minOscVal = 0;
 		// Max OSC input or output value.
 		maxOscVal = 127;
-		for (int i = 0; i < TROWA_OSCCV_VAL_BUFFER_SIZE; i++)
-		{
-			valBuffer[i] = 0.0f;
-		}
-		valBuffIx = 0;
+		valHistory.reset();
 		convertVals = false;
 		return;
 	} // end initialize()
@@ -216,7 +335,11 @@ struct TSOSCCVChannel {
 		translatedVal = translatedVals[0];
 		return;
 	}	
-	void addValToBuffer(float buffVal);
+	// Add a value to the history.
+	void addValToBuffer(float buffVal) {
+		valHistory.add(buffVal);
+		return;
+	}
 
 	// Sets the value from CV input.
 	void setValue(float newVal) {
@@ -263,6 +386,7 @@ struct TSOSCCVChannel {
 			this->path = "/" + path;
 		else
 			this->path = path;
+		pathVersion++;
 		return;
 	}
 	std::string getPath() {
@@ -282,6 +406,154 @@ struct TSOSCCVChannel {
 	virtual void deserialize(json_t* rootJ);
 
 };
+//--------------------------------------------------------
+// TSOSCCVNextNamespaceVersion()
+// Next namespace version (process-wide, so no two masters share one and an
+// expander moved to another master always rebuilds its messages). Never 0.
+//--------------------------------------------------------
+uint32_t TSOSCCVNextNamespaceVersion();
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Pre-encoded OSC message (padded address + type tag string).
+// Only rebuilt when the path, namespace or data type changes, so
+// sending a value just patches in the argument bytes.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCCVMsgTemplate
+{
+	// The encoded address and type tags.
+	char header[TROWA_OSCCV_MSG_TEMPLATE_SIZE];
+	// Number of bytes used in header.
+	int headerSize = 0;
+	// Index in header of the first type tag (right after the ',').
+	int typeTagsIx = 0;
+	// Number of arguments.
+	int numArgs = 0;
+	// Type tag for all the arguments ('f', 'i' or 'T' for bool which gets patched to 'T' or 'F' per value).
+	char argTypeTag = 0;
+	// The channel path version this was built for.
+	uint32_t pathVersion = 0;
+	// The namespace version this was built for.
+	uint32_t nsVersion = 0;
+
+	//--------------------------------------------------------
+	// isValid()
+	// @pathVer : (IN) Current path version of the channel.
+	// @nsVer : (IN) Current namespace version of the module.
+	// @argTag : (IN) The type tag for the arguments.
+	// @nArgs : (IN) The number of arguments.
+	// @returns : True if this template still matches.
+	//--------------------------------------------------------
+	bool isValid(uint32_t pathVer, uint32_t nsVer, char argTag, int nArgs) const
+	{
+		return headerSize > 0 && pathVersion == pathVer && nsVersion == nsVer && argTypeTag == argTag && numArgs == nArgs;
+	}
+	//--------------------------------------------------------
+	// build()
+	// @oscNamespace : (IN) The namespace (without '/').
+	// @path : (IN) The channel path.
+	// @argTag : (IN) The type tag for the arguments.
+	// @nArgs : (IN) The number of arguments.
+	// Encode the address and type tags.
+	//--------------------------------------------------------
+	void build(const std::string& oscNamespace, const std::string& path, char argTag, int nArgs);
+	//--------------------------------------------------------
+	// getMessageSize()
+	// @returns : Size of the full encoded message (header + arguments).
+	//--------------------------------------------------------
+	int getMessageSize() const
+	{
+		return headerSize + ((argTypeTag == 'T') ? 0 : numArgs * 4);
+	}
+	//--------------------------------------------------------
+	// write()
+	// @buffer : (OUT) Where to write the message. Must have getMessageSize() bytes.
+	// @vals : (IN) The argument values (numArgs of them).
+	// @returns : The number of bytes written.
+	//--------------------------------------------------------
+	int write(char* buffer, const float* vals);
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Writes pre-encoded messages into an (immediate) OSC bundle.
+// Replaces osc::OutboundPacketStream for the cvOSCcv send path.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCCVBundleWriter
+{
+	// The output buffer (not owned).
+	char* buffer = NULL;
+	// The size of the output buffer.
+	int capacity = 0;
+	// Total bytes written (all bundles). 0 if no bundle has been opened.
+	int size = 0;
+	// Max size of a single bundle/datagram (UDP payload). 0 for no limit (one bundle).
+	int maxPacketSize = TROWA_OSCCV_DEFAULT_MAX_PACKET_SIZE;
+	// Number of bundles (datagrams) written.
+	int numPackets = 0;
+	// Start of the current (last) bundle.
+	int packetStart = 0;
+	// End of each bundle in the buffer.
+	int packetEnds[TROWA_OSCCV_MAX_TX_PACKETS];
+
+	TSOSCCVBundleWriter()
+	{
+		return;
+	}
+	TSOSCCVBundleWriter(char* buffer, int capacity)
+	{
+		this->buffer = buffer;
+		this->capacity = capacity;
+		return;
+	}
+	// If a bundle has been started.
+	bool isOpen() const
+	{
+		return size > 0;
+	}
+	// Throw away the current bundles.
+	void clear()
+	{
+		size = 0;
+		numPackets = 0;
+		packetStart = 0;
+	}
+	const char* data() const
+	{
+		return buffer;
+	}
+	// Get the start of the given bundle/datagram.
+	const char* getPacketData(int packetIx) const
+	{
+		return (packetIx > 0) ? buffer + packetEnds[packetIx - 1] : buffer;
+	}
+	// Get the size of the given bundle/datagram.
+	int getPacketSize(int packetIx) const
+	{
+		return (packetIx > 0) ? packetEnds[packetIx] - packetEnds[packetIx - 1] : packetEnds[0];
+	}
+	//--------------------------------------------------------
+	// addMessage()
+	// @msgTemplate : (IN) The pre-encoded message.
+	// @vals : (IN) The argument values.
+	// @returns : True if added, false if there is no room.
+	// Adds the message to the current bundle (opens the bundle if needed).
+	// If the message would make the bundle larger than maxPacketSize, a new bundle is started.
+	//--------------------------------------------------------
+	bool addMessage(TSOSCCVMsgTemplate* msgTemplate, const float* vals);
+	//--------------------------------------------------------
+	// addEncodedMessage()
+	// @msg : (IN) An encoded message (i.e. from an expander).
+	// @msgSize : (IN) The size of the message.
+	// @returns : True if added, false if there is no room.
+	//--------------------------------------------------------
+	bool addEncodedMessage(const char* msg, int msgSize);
+private:
+	//--------------------------------------------------------
+	// beginElement()
+	// Make room for a message of @msgSize in the current bundle (opens/starts a bundle if needed).
+	// @returns : Where to write the message, NULL if there is no room.
+	//--------------------------------------------------------
+	char* beginElement(int msgSize);
+};
+
 // Channel specifically for CV Input -> OSC.
 // Extra stuff for knowing when to send output.
 struct TSOSCCVInputChannel : TSOSCCVChannel {
@@ -291,9 +563,31 @@ struct TSOSCCVInputChannel : TSOSCCVChannel {
 	std::vector<float> lastTranslatedVals;
 	
 	// If trigger is not set up (input type channel), how much input change is needed to send a message out.
-	float channelSensitivity = 0.05f;
+	float channelSensitivity = TROWA_OSCCV_DEFAULT_SENSITIVITY;
+	// Rate (Hz) this channel sends at (most) when its value changes, on its own clock. 0 to use the module send timer.
+	float maxSendRate_Hz = TROWA_OSCCV_DEFAULT_SEND_HZ;
+	// If the deadband should grow with the signal's noise (so jittery CV doesn't keep sending).
+	bool adaptiveDeadband = false;
+	// Adaptive deadband = this * noise (but at least channelSensitivity).
+	float adaptiveDeadbandMult = TROWA_OSCCV_ADAPTIVE_DEADBAND_MULT;
+	// How much change is 'significant'.
+	float significantChange = TROWA_OSCCV_DEFAULT_SIGNIFICANT_CHANGE;
+	// Significant changes are sent within this many ms (regardless of the send timer or rate limit). Negative to disable.
+	float significantSendWithin_ms = -1.0f;
 	// If we should send. Working value for module.
 	bool doSend = false;
+	// Pre-encoded message for sending this channel.
+	TSOSCCVMsgTemplate msgTemplate;
+	// [Working] Send clock phase (>= 1 when the channel may send).
+	float sendPhase = 1.0f;
+	// [Working] If a significant change is waiting to be sent.
+	bool significantPending = false;
+	// [Working] Time (s) the significant change has been waiting.
+	float significantPendingTime = 0.0f;
+	// [Working] Noise estimate (mean square of the sample to sample change) for the adaptive deadband.
+	float noiseVariance = 0.0f;
+	// [Working] Previous sample values for the noise estimate.
+	std::vector<float> noisePrevVals;
 
 	TSOSCCVInputChannel() : TSOSCCVChannel()
 	{
@@ -301,6 +595,7 @@ struct TSOSCCVInputChannel : TSOSCCVChannel {
 		{			
 			lastVals.push_back(VoltageUnused);
 			lastTranslatedVals.push_back(VoltageUnused);
+			noisePrevVals.push_back(0.0f);
 		}
 		return;
 	}
@@ -314,9 +609,18 @@ struct TSOSCCVInputChannel : TSOSCCVChannel {
 	}	
 	void initialize() override {
 		initLastVals();
-		channelSensitivity = 0.05f;
+		channelSensitivity = TROWA_OSCCV_DEFAULT_SENSITIVITY;
+		maxSendRate_Hz = TROWA_OSCCV_DEFAULT_SEND_HZ;
+		adaptiveDeadband = false;
+		adaptiveDeadbandMult = TROWA_OSCCV_ADAPTIVE_DEADBAND_MULT;
+		significantChange = TROWA_OSCCV_DEFAULT_SIGNIFICANT_CHANGE;
+		significantSendWithin_ms = -1.0f;
 		TSOSCCVChannel::initialize();
 		doSend = false;
+		sendPhase = 1.0f;
+		significantPending = false;
+		significantPendingTime = 0.0f;
+		noiseVariance = 0.0f;
 		return;
 	} // end initialize()
 	
@@ -328,26 +632,146 @@ struct TSOSCCVInputChannel : TSOSCCVChannel {
 			lastTranslatedVals[i] = VoltageUnused;
 		}
 	}
+	// The largest change from what we last sent.
+	float getMaxChange()
+	{
+		const float* curr = (convertVals) ? translatedVals.data() : vals.data();
+		const float* last = (convertVals) ? lastTranslatedVals.data() : lastVals.data();
+		float maxChange = 0.0f;
+		for (int i = 0; i < numVals; i++)
+		{
+			float change = std::abs(curr[i] - last[i]);
+			if (change > maxChange)
+				maxChange = change;
+		}
+		return maxChange;
+	}
+	// The current deadband (change needed to send).
+	float getDeadband()
+	{
+		if (adaptiveDeadband)
+			return std::max(channelSensitivity, adaptiveDeadbandMult * std::sqrt(noiseVariance));
+		return channelSensitivity;
+	}
+	//--------------------------------------------------------
+	// updateNoise()
+	// @dt : (IN) Time (s) since last call.
+	// Track how much the signal moves from sample to sample (for the adaptive deadband).
+	//--------------------------------------------------------
+	void updateNoise(float dt)
+	{
+		const float* curr = (convertVals) ? translatedVals.data() : vals.data();
+		float d = 0.0f;
+		for (int i = 0; i < numVals; i++)
+		{
+			float change = std::abs(curr[i] - noisePrevVals[i]);
+			if (change > d)
+				d = change;
+			noisePrevVals[i] = curr[i];
+		}
+		noiseVariance += (d * d - noiseVariance) * dt / (TROWA_OSCCV_NOISE_TIME_CONSTANT + dt);
+		return;
+	}
 	// Checks to see if vals have changed enough to send a value.
 	bool valChanged()
 	{
-		bool sendVal = false;
-		int i = 0;
-		while (i < numVals && !sendVal)
+		return getMaxChange() > getDeadband();
+	}
+	//--------------------------------------------------------
+	// checkSend()
+	// @sendTime : (IN) If it is the module's send tick (only used if maxSendRate_Hz is 0).
+	// @dt : (IN) Time (s) since last call (sample time).
+	// @returns : True if this channel should send now.
+	// Changes larger than the deadband are sent on the channel's next send tick (every 1/maxSendRate_Hz,
+	// independent of the module timer, so a channel can send faster or slower than it).
+	// Significant changes are sent within significantSendWithin_ms (if enabled) even if the tick hasn't come yet.
+	//--------------------------------------------------------
+	bool checkSend(bool sendTime, float dt)
+	{
+		// Channel send clock (stops at 1 while there is nothing to send, so no burst later)
+		if (maxSendRate_Hz > 0.0f && sendPhase < 1.0f)
+			sendPhase += dt * maxSendRate_Hz;
+		if (adaptiveDeadband)
+			updateNoise(dt);
+		bool checkSignificant = significantSendWithin_ms >= 0.0f && !significantPending;
+		if (!doSend || checkSignificant)
 		{
-			if (convertVals)
+			float change = getMaxChange();
+			if (!doSend)
+				doSend = change > getDeadband();
+			if (checkSignificant && doSend && change >= significantChange)
 			{
-				sendVal = std::abs(translatedVals[i] - lastTranslatedVals[i]) > channelSensitivity;							
+				significantPending = true;
+				significantPendingTime = 0.0f;
 			}
-			else
+		}
+		if (!doSend)
+			return false;
+		if (significantPending)
+		{
+			significantPendingTime += dt;
+			if (significantPendingTime * 1000.0f >= significantSendWithin_ms)
+				return true;
+		}
+		return (maxSendRate_Hz > 0.0f) ? sendPhase >= 1.0f : sendTime;
+	} // end checkSend()
+	// Values have been sent. Save them and reset the send state.
+	void onSent()
+	{
+		storeLastValues();
+		doSend = false;
+		// Keep the clock's phase (no drift for rates that don't divide the sample rate)
+		sendPhase = (sendPhase >= 1.0f) ? sendPhase - 1.0f : 0.0f;
+		significantPending = false;
+		return;
+	}
+	
+	// The OSC type tag we will send for our values.
+	char getArgTypeTag()
+	{
+		if (convertVals)
+		{
+			switch (dataType)
 			{
-				sendVal = std::abs(vals[i] - lastVals[i]) > channelSensitivity;							
+			case TSOSCCVChannel::ArgDataType::OscInt:
+				return 'i';
+			case TSOSCCVChannel::ArgDataType::OscBool:
+				return 'T';
+			case TSOSCCVChannel::ArgDataType::OscFloat:
+			default:
+				break;
 			}
-			i++;
 		}
-		return sendVal;
+		return 'f';
+	}
+	// The values we will send (raw or translated).
+	const float* getSendVals()
+	{
+		return (convertVals) ? translatedVals.data() : vals.data();
+	}
+	//--------------------------------------------------------
+	// getMsgTemplate()
+	// @oscNamespace : (IN) The namespace (without '/').
+	// @nsVersion : (IN) The namespace version.
+	// @returns : The pre-encoded message (rebuilt first if the path/namespace/data type changed).
+	//--------------------------------------------------------
+	TSOSCCVMsgTemplate* getMsgTemplate(const std::string& oscNamespace, uint32_t nsVersion)
+	{
+		char argTag = getArgTypeTag();
+		uint32_t pathVer = pathVersion;
+		if (!msgTemplate.isValid(pathVer, nsVersion, argTag, numVals))
+		{
+			// [Audio thread] Don't copy the path (allocates) or wait on the UI. If it is being edited, try again next time.
+			if (mutPath.try_lock())
+			{
+				msgTemplate.build(oscNamespace, path, argTag, numVals);
+				mutPath.unlock();
+				msgTemplate.pathVersion = pathVer;
+				msgTemplate.nsVersion = nsVersion;
+			}
+		}
+		return &msgTemplate;
 	}
-	
 	void storeLastValues()
 	{
 		for (int i = 0; i < TROWA_OSCCV_VECTOR_MAX_SIZE; i++)
@@ -377,6 +801,220 @@ struct TSOSCCVInputChannel : TSOSCCVChannel {
 	void deserialize(json_t* rootJ) override;
 };
 
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Latest-value mailbox for one OSC->CV channel (seqlock).
+// The Rx thread overwrites the values; the audio thread reads the newest
+// complete snapshot (if there is a new one). Neither side ever waits, and a
+// burst of messages costs the same as one. Single writer (Rx thread).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCCVMailbox
+{
+	//--------------------------------------------------------
+	// write()
+	// [Writer] Replace the values.
+	// @vals : (IN) The values.
+	// @size : (IN) Number of values (max TROWA_OSCCV_VECTOR_MAX_SIZE).
+	//--------------------------------------------------------
+	void write(const float* vals, int size)
+	{
+		size = (size < 1) ? 1 : ((size > TROWA_OSCCV_VECTOR_MAX_SIZE) ? TROWA_OSCCV_VECTOR_MAX_SIZE : size);
+		uint32_t seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed); // Odd: writing
+		std::atomic_thread_fence(std::memory_order_release);
+		for (int i = 0; i < size; i++)
+			values[i].store(vals[i], std::memory_order_relaxed);
+		length.store(size, std::memory_order_relaxed);
+		sequence.store(seq + 2, std::memory_order_release); // Even: done
+		return;
+	}
+	//--------------------------------------------------------
+	// read()
+	// [Reader] Get the newest snapshot if it is new since the last read.
+	// @vals : (OUT) The values (TROWA_OSCCV_VECTOR_MAX_SIZE).
+	// @size : (OUT) Number of values.
+	// @returns : True if there was a new complete snapshot.
+	// If the writer is busy we just try again next sample.
+	//--------------------------------------------------------
+	bool read(float* vals, int* size)
+	{
+		uint32_t seq = sequence.load(std::memory_order_acquire);
+		if (seq == lastReadSequence || (seq & 1))
+			return false;
+		int n = length.load(std::memory_order_relaxed);
+		for (int i = 0; i < n; i++)
+			vals[i] = values[i].load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sequence.load(std::memory_order_relaxed) != seq)
+			return false; // Torn (written while we read)
+		lastReadSequence = seq;
+		*size = n;
+		return true;
+	}
+protected:
+	std::atomic<uint32_t> sequence { 0 };
+	std::atomic<float> values[TROWA_OSCCV_VECTOR_MAX_SIZE];
+	std::atomic<int> length { 1 };
+	// [Reader] Last snapshot read.
+	uint32_t lastReadSequence = 0;
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Output (OSC->CV) channel.
+// Can reconstruct a smooth signal from received points (so controllers can send at a low rate).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCCVOutputChannel : TSOSCCVChannel {
+	// How to get from one received value to the next.
+	enum SmoothMode : int {
+		// Step to the new value (no smoothing).
+		SmoothNone,
+		// Linear ramp over the (estimated) interval between received values.
+		SmoothLinear,
+		// Cubic (Hermite) curve over the (estimated) interval between received values. Smooth slope, may overshoot a little.
+		SmoothCubic,
+		// One-pole slew (lag) towards the new value.
+		SmoothSlew,
+		NUM_SMOOTH_MODES
+	};
+	SmoothMode smoothMode = SmoothMode::SmoothNone;
+	// Only the latest received value matters (mailbox instead of the message queue). Not for bool (trigger) channels.
+	std::atomic<bool> rxLatestOnly { false };
+	// Latest received value (if rxLatestOnly).
+	TSOSCCVMailbox rxMailbox;
+	// Slew time constant (ms). 0 to use half the (estimated) interval between received values.
+	float slewTime_ms = 0.0f;
+	// Values to output (smoothed translatedVals).
+	float outVals[TROWA_OSCCV_VECTOR_MAX_SIZE] = { 0 };
+	// [Working] Where the current segment starts.
+	float startVals[TROWA_OSCCV_VECTOR_MAX_SIZE] = { 0 };
+	// [Working] Slope (V/s) at the start of the current segment.
+	float startSlopes[TROWA_OSCCV_VECTOR_MAX_SIZE] = { 0 };
+	// [Working] Where the current segment ends (the last received value).
+	float targetVals[TROWA_OSCCV_VECTOR_MAX_SIZE] = { 0 };
+	// [Working] The value received before the target.
+	float prevTargetVals[TROWA_OSCCV_VECTOR_MAX_SIZE] = { 0 };
+	// [Working] Position (0-1) in the current segment.
+	float segPhase = 1.0f;
+	// [Working] Length (s) of the current segment.
+	float segDuration = 0.0f;
+	// [Working] Estimated time (s) between received values. 0 if we don't know yet.
+	float rxInterval = 0.0f;
+	// [Working] Time (s) since the last received value.
+	float timeSinceRx = 0.0f;
+	// [Working] Number of values in the segment.
+	int segNumVals = 0;
+	// [Working] Slew coefficient and what it was calculated for.
+	float slewCoeff = 1.0f;
+	float slewCoeffTau = -1.0f;
+	float slewCoeffDt = -1.0f;
+
+	TSOSCCVOutputChannel() : TSOSCCVChannel()
+	{
+		// Room for a full polyphonic message
+		vals.resize(TROWA_OSCCV_VECTOR_MAX_SIZE, 0.f);
+		translatedVals.resize(TROWA_OSCCV_VECTOR_MAX_SIZE, 0.f);
+		return;
+	}
+	TSOSCCVOutputChannel(int chNum, std::string path) : TSOSCCVOutputChannel()
+	{
+		this->channelNum = chNum;
+		this->path = path;
+		this->initialize();
+		return;
+	}
+	void initialize() override {
+		TSOSCCVChannel::initialize();
+		smoothMode = SmoothMode::SmoothNone;
+		slewTime_ms = 0.0f;
+		rxLatestOnly = false;
+		resetSmoothing();
+		return;
+	} // end initialize()
+	// Reset the working values (jump to the current value).
+	void resetSmoothing()
+	{
+		for (int i = 0; i < TROWA_OSCCV_VECTOR_MAX_SIZE; i++)
+		{
+			float v = (i < numVals) ? translatedVals[i] : 0.0f;
+			outVals[i] = v;
+			startVals[i] = v;
+			targetVals[i] = v;
+			prevTargetVals[i] = v;
+			startSlopes[i] = 0.0f;
+		}
+		segNumVals = numVals;
+		segPhase = 1.0f;
+		segDuration = 0.0f;
+		rxInterval = 0.0f;
+		timeSinceRx = 0.0f;
+		return;
+	}
+	// Multiple input. Starts a new segment towards the received values.
+	void setOSCInValue(float* oscVals, int size)
+	{
+		size = clamp(size, 1, TROWA_OSCCV_VECTOR_MAX_SIZE);
+		TSOSCCVChannel::setOSCInValue(oscVals, size);
+		onReceived();
+		return;
+	}
+	// Single input.
+	void setOSCInValue(float oscVal)
+	{
+		setOSCInValue(&oscVal, 1);
+		return;
+	}
+	//--------------------------------------------------------
+	// offerToMailbox()
+	// [Rx thread] If this channel only keeps the latest value, put the values in the mailbox.
+	// Bool channels are triggers (every message counts), they always use the queue.
+	// @vals : (IN) The values.
+	// @size : (IN) Number of values.
+	// @returns : True if taken (don't queue the message).
+	//--------------------------------------------------------
+	bool offerToMailbox(const float* vals, int size)
+	{
+		if (!rxLatestOnly.load(std::memory_order_relaxed) || dataType == ArgDataType::OscBool)
+			return false;
+		rxMailbox.write(vals, size);
+		return true;
+	}
+	//--------------------------------------------------------
+	// readMailbox()
+	// [Audio thread] Apply the newest mailbox values (if any arrived).
+	// @returns : True if there was a new value.
+	//--------------------------------------------------------
+	bool readMailbox()
+	{
+		float mailVals[TROWA_OSCCV_VECTOR_MAX_SIZE];
+		int size = 0;
+		if (!rxMailbox.read(mailVals, &size))
+			return false;
+		setOSCInValue(mailVals, size);
+		return true;
+	}
+	//--------------------------------------------------------
+	// onReceived()
+	// Update the interval estimate and start the next segment.
+	//--------------------------------------------------------
+	void onReceived();
+	//--------------------------------------------------------
+	// process()
+	// @dt : (IN) Sample time (s).
+	// Calculate outVals for this sample.
+	//--------------------------------------------------------
+	void process(float dt);
+
+	//--------------------------------------------------------
+	// serialize()
+	// @returns : The channel json node.
+	//--------------------------------------------------------
+	json_t* serialize() override;
+	//--------------------------------------------------------
+	// deserialize()
+	// @rootJ : (IN) The channel json node.
+	//--------------------------------------------------------
+	void deserialize(json_t* rootJ) override;
+};
+
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // Simple single message to/from OSC. 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -389,13 +1027,19 @@ struct TSOSCCVSimpleMessage
 	// std::vector is giving me grief on MacOS. 
 	// Allocating new float* is giving grief too but seems to use less ram is faster
 #if USE_STATIC_ARRAY
-	float rxVals[TROWA_OSCCV_VAL_BUFFER_SIZE] = {0};
+	float rxVals[TROWA_OSCCV_VECTOR_MAX_SIZE] = {0};
 #else
 	// Dynamic array of values.
 	float* rxVals = NULL; 
 #endif	
 	// How many elements we have in rxVals.
 	int rxLength = 0;
+	// OSC time tag (NTP 32.32) of the bundle this came in. TROWA_OSCCV_TIMETAG_IMMEDIATE if none/immediate.
+	uint64_t timeTag = TROWA_OSCCV_TIMETAG_IMMEDIATE;
+	// When we received it (s, local steady clock).
+	double arrivalTime = 0.0;
+	// [Audio thread] When to apply it (s, module sample clock). Negative if not calculated yet.
+	double dueTime = -1.0;
 
 	TSOSCCVSimpleMessage()
 	{
@@ -440,6 +1084,7 @@ struct TSOSCCVSimpleMessage
 	{
 		// NOTES: Adding copy constructor didn't help on MAC OS (still get memory error).
 		SetValues(cpy.channelNum, cpy.rxVals, cpy.rxLength);
+		SetTiming(cpy.timeTag, cpy.arrivalTime);
 		// channelNum = cpy.channelNum;
 		// rxVals.clear();
 		// for (int i = 0; i < static_cast<int>(cpy.rxVals.size()); i++)
@@ -455,6 +1100,7 @@ struct TSOSCCVSimpleMessage
 			return *this;
 		}
 		SetValues(rhs.channelNum, rhs.rxVals, rhs.rxLength);
+		SetTiming(rhs.timeTag, rhs.arrivalTime);
 		// channelNum = rhs.channelNum;
 		// rxVals.clear();
 		// for (int i = 0; i < static_cast<int>(rhs.rxVals.size()); i++)
@@ -464,9 +1110,20 @@ struct TSOSCCVSimpleMessage
 		return *this;
 	}
 	
+	void SetTiming(uint64_t timeTag, double arrivalTime)
+	{
+		this->timeTag = timeTag;
+		this->arrivalTime = arrivalTime;
+		this->dueTime = -1.0;
+		return;
+	}
+	
 	void SetBuffer(int size)
 	{
-#if !USE_STATIC_ARRAY		
+#if USE_STATIC_ARRAY
+		if (size > TROWA_OSCCV_VECTOR_MAX_SIZE)
+			size = TROWA_OSCCV_VECTOR_MAX_SIZE;
+#else
 		if (rxVals != NULL && rxLength < size)
 		{
 			// Resize our array. 
@@ -487,7 +1144,7 @@ struct TSOSCCVSimpleMessage
 	{
 		this->channelNum = chNum;
 		SetBuffer(size);
-		for (int i = 0; i < size; i++)
+		for (int i = 0; i < rxLength; i++)
 		{
 			rxVals[i] = vals[i];
 		}		
@@ -498,7 +1155,7 @@ struct TSOSCCVSimpleMessage
 	{
 		this->channelNum = chNum;
 		SetBuffer(size);
-		for (int i = 0; i < size; i++)
+		for (int i = 0; i < rxLength; i++)
 		{
 			rxVals[i] = vals[i];
 		}		
@@ -511,9 +1168,11 @@ struct TSOSCCVSimpleMessage
 		SetBuffer(static_cast<int>(vals.size()));		
 		//rxVals.clear();
 
-	DEBUG("Ch %d, Vals are size: %d. RxLength now %d.", chNum, vals.size(), rxLength);
+#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_HIGH
+		DEBUG("Ch %d, Vals are size: %d. RxLength now %d.", chNum, static_cast<int>(vals.size()), rxLength);
+#endif
 		
-		for (int i = 0; i < static_cast<int>(vals.size()); i++)
+		for (int i = 0; i < rxLength; i++)
 		{
 			rxVals[i] = vals[i];
 			//rxVals.push_back(vals[i]);			
@@ -531,8 +1190,191 @@ struct TSOSCCVSimpleMessage
 	}	
 };
 
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Received message queue (listener thread -> audio thread).
+// Fixed ring of message objects: single consumer (the audio thread) is lock free and
+// nothing is allocated or freed. Producers must serialize among themselves (rxMsgMutex).
+// If it is full, new messages are dropped (counted).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCCVRxQueue
+{
+	// Number of messages dropped (queue full).
+	std::atomic<uint32_t> droppedCount { 0 };
+
+	//--------------------------------------------------------
+	// getWriteSlot()
+	// [Producer] Get the next free message object to fill in.
+	// @returns : The message to fill in or NULL if the queue is full.
+	//--------------------------------------------------------
+	TSOSCCVSimpleMessage* getWriteSlot()
+	{
+		int w = writeIx.load(std::memory_order_relaxed);
+		if ((w + 1) % OSC_RX_MSG_BUFFER_SIZE == readIx.load(std::memory_order_acquire))
+		{
+			droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return NULL;
+		}
+		return &(buffer[w]);
+	}
+	// [Producer] Publish the message from getWriteSlot().
+	void push()
+	{
+		writeIx.store((writeIx.load(std::memory_order_relaxed) + 1) % OSC_RX_MSG_BUFFER_SIZE, std::memory_order_release);
+	}
+	// [Consumer] The oldest message (NULL if empty). Stays valid until pop().
+	TSOSCCVSimpleMessage* front()
+	{
+		int r = readIx.load(std::memory_order_relaxed);
+		return (r == writeIx.load(std::memory_order_acquire)) ? NULL : &(buffer[r]);
+	}
+	// [Consumer] Release the oldest message.
+	void pop()
+	{
+		int r = readIx.load(std::memory_order_relaxed);
+		if (r != writeIx.load(std::memory_order_acquire))
+			readIx.store((r + 1) % OSC_RX_MSG_BUFFER_SIZE, std::memory_order_release);
+	}
+	// Number of messages waiting.
+	int size() const
+	{
+		int n = writeIx.load(std::memory_order_acquire) - readIx.load(std::memory_order_acquire);
+		return (n < 0) ? n + OSC_RX_MSG_BUFFER_SIZE : n;
+	}
+protected:
+	TSOSCCVSimpleMessage buffer[OSC_RX_MSG_BUFFER_SIZE];
+	std::atomic<int> writeIx { 0 };
+	std::atomic<int> readIx { 0 };
+};
+
+// Local steady clock time (s). For time stamping received messages.
+inline double getOscCVClockTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Schedules received OSC messages to a sample position (jitter buffer).
+// Messages are applied jitterBuffer_ms after their bundle time tag (mapped to our clock) or after
+// they arrived (no time tag). This way network jitter and engine block boundaries don't move them around.
+// [Audio thread] only.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCCVRxScheduler
+{
+	// Jitter buffer (ms). 0 to apply messages as soon as we see them (ignores time tags).
+	float jitterBuffer_ms = 0.0f;
+	// Our sample clock (s).
+	double sampleClock = 0.0;
+	// Local clock - sample clock (s).
+	double clockOffset = 0.0;
+	bool clockOffsetValid = false;
+	// Local clock (arrival) - sender clock (time tag) (s). Smallest we've seen (so it's the fastest network delivery).
+	double senderOffset = 0.0;
+	bool senderOffsetValid = false;
+	// Samples until next clock sync.
+	int syncCounter = 0;
+
+	void reset()
+	{
+		sampleClock = 0.0;
+		clockOffsetValid = false;
+		senderOffsetValid = false;
+		syncCounter = 0;
+		return;
+	}
+	//--------------------------------------------------------
+	// followClock()
+	// Use the master's sample clock (expanders get it a few samples late).
+	// Our sender clock tracking stays our own.
+	// @master : (IN) The master's scheduler.
+	// @delay : (IN) How old the master's clock is (s).
+	//--------------------------------------------------------
+	void followClock(const TSOSCCVRxScheduler& master, double delay)
+	{
+		jitterBuffer_ms = master.jitterBuffer_ms;
+		sampleClock = master.sampleClock + delay;
+		clockOffset = master.clockOffset;
+		clockOffsetValid = master.clockOffsetValid;
+		return;
+	}
+	// Advance one sample.
+	void step(float sampleTime)
+	{
+		sampleClock += sampleTime;
+		if (jitterBuffer_ms > 0.0f && --syncCounter <= 0)
+		{
+			sync();
+			syncCounter = TROWA_OSCCV_CLOCK_SYNC_SAMPLES;
+		}
+		return;
+	}
+	//--------------------------------------------------------
+	// sync()
+	// Track the offset from the local clock to our sample clock.
+	// Engine blocks are processed faster than real-time, so keep the smallest offset (start of the blocks) and follow it slowly.
+	//--------------------------------------------------------
+	void sync()
+	{
+		double observed = getOscCVClockTime() - sampleClock;
+		if (!clockOffsetValid || observed < clockOffset || observed - clockOffset > TROWA_OSCCV_MAX_SCHEDULE_AHEAD)
+		{
+			// First time, or engine was paused/stalled
+			clockOffset = observed;
+			clockOffsetValid = true;
+		}
+		else
+		{
+			clockOffset += (observed - clockOffset) * 0.001;
+		}
+		return;
+	}
+	//--------------------------------------------------------
+	// isDue()
+	// @msg : (IN/OUT) The message (dueTime is calculated the first time).
+	// @returns : True if the message should be applied at this sample.
+	//--------------------------------------------------------
+	bool isDue(TSOSCCVSimpleMessage* msg)
+	{
+		if (jitterBuffer_ms <= 0.0f)
+			return true;
+		if (msg->dueTime < 0.0)
+			msg->dueTime = calcDueTime(msg);
+		return msg->dueTime <= sampleClock;
+	}
+	//--------------------------------------------------------
+	// calcDueTime()
+	// @msg : (IN) The message.
+	// @returns : The sample clock time to apply the message.
+	//--------------------------------------------------------
+	double calcDueTime(const TSOSCCVSimpleMessage* msg)
+	{
+		if (!clockOffsetValid)
+			sync();
+		double jitterBuffer = jitterBuffer_ms * 0.001;
+		double localTime = msg->arrivalTime + jitterBuffer;
+		if (msg->timeTag > TROWA_OSCCV_TIMETAG_IMMEDIATE)
+		{
+			// Sender's time tag. We don't know the sender's clock, so keep the same spacing it has and a constant delay.
+			double tagTime = static_cast<double>(msg->timeTag >> 32) + static_cast<double>(msg->timeTag & 0xFFFFFFFF) / 4294967296.0;
+			double observed = msg->arrivalTime - tagTime;
+			if (!senderOffsetValid || observed < senderOffset || observed - senderOffset > TROWA_OSCCV_MAX_SCHEDULE_AHEAD)
+			{
+				senderOffset = observed;
+				senderOffsetValid = true;
+			}
+			else
+			{
+				senderOffset += (observed - senderOffset) * 0.01; // Follow clock drift slowly
+			}
+			localTime = tagTime + senderOffset + jitterBuffer;
+		}
+		double due = localTime - clockOffset;
+		if (due > sampleClock + jitterBuffer + TROWA_OSCCV_MAX_SCHEDULE_AHEAD)
+			due = sampleClock + jitterBuffer;
+		return due;
+	}
+};
+
 //=== Expander ===
-// Not needed anymore since I realize there is a 1 sample time delay...
 enum TSOSCCVExpanderDirection 
 {
 	Unknown,
@@ -541,16 +1383,216 @@ enum TSOSCCVExpanderDirection
 	Output
 };
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
-// Message to pass to/from expanders.-- NOT USED. Expander messaging has 1 sample delay.
+// Master -> expanders (Rack expander message).
+// The master writes this to its neighbors every sample and each expander
+// passes it on, so it is one sample older for every hop.
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
-struct TSOSCCVExpanderMessage 
+struct TSOSCCVExpanderState
 {
-	int moduleId = 0;
-	int numChannels = TROWA_OSCCV_DEFAULT_NUM_CHANNELS;
-	TSOSCCVExpanderDirection direction;
-	int expansionNum;
-	std::vector<TSOSCCVChannel> expansionChannels;
+	// If OSC is running.
+	bool oscInitialized = false;
+	// If it is the master's send tick.
+	bool sendTime = false;
+	// Namespace version (channels rebuild their messages if this changes).
+	uint32_t nsVersion = 0;
+	// The namespace (without '/').
+	char oscNamespace[TROWA_OSCCV_MSG_ADDRESS_SIZE] = { 0 };
+	// The master's Rx clock (when to apply received messages).
+	TSOSCCVRxScheduler rxClock;
+
+	// Copy (only the used part of the namespace).
+	void copy(const TSOSCCVExpanderState* src)
+	{
+		oscInitialized = src->oscInitialized;
+		sendTime = src->sendTime;
+		nsVersion = src->nsVersion;
+		setNamespace(src->oscNamespace);
+		rxClock = src->rxClock;
+		return;
+	}
+	void setNamespace(const char* ns)
+	{
+		int n = strnlen(ns, TROWA_OSCCV_MSG_ADDRESS_SIZE - 1);
+		std::memcpy(oscNamespace, ns, n);
+		oscNamespace[n] = 0;
+		return;
+	}
+	// Send to a neighbor (@dst is the neighbor's Expander on our side). Rack flips it at the end of the sample.
+	void sendTo(Module::Expander& dst) const
+	{
+		if (dst.producerMessage != NULL)
+		{
+			reinterpret_cast<TSOSCCVExpanderState*>(dst.producerMessage)->copy(this);
+			dst.messageFlipRequested = true;
+		}
+		return;
+	}
+};
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Input expanders -> master (Rack expander message).
+// Each input expander sends what it got from the expanders past it plus
+// its own encoded messages; the master puts them in its bundle.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCCVExpanderTxMessage
+{
+	// Bytes used in data.
+	int size = 0;
+	// Number of messages in data.
+	int numMessages = 0;
+	// Encoded messages, each is [int size][message].
+	char data[TROWA_OSCCV_EXPANDER_TX_BUFFER_SIZE];
+
+	void clear()
+	{
+		size = 0;
+		numMessages = 0;
+		return;
+	}
+	//--------------------------------------------------------
+	// addMessage()
+	// @msgTemplate : (IN) The pre-encoded message.
+	// @vals : (IN) The argument values.
+	// @returns : True if added, false if there is no room.
+	//--------------------------------------------------------
+	bool addMessage(TSOSCCVMsgTemplate* msgTemplate, const float* vals)
+	{
+		if (msgTemplate->headerSize < 1)
+			return true; // Not built yet (path being edited), nothing to send
+		int msgSize = msgTemplate->getMessageSize();
+		if (size + static_cast<int>(sizeof(int)) + msgSize > TROWA_OSCCV_EXPANDER_TX_BUFFER_SIZE)
+			return false;
+		std::memcpy(data + size, &msgSize, sizeof(int));
+		msgTemplate->write(data + size + sizeof(int), vals);
+		size += sizeof(int) + msgSize;
+		numMessages++;
+		return true;
+	}
+	//--------------------------------------------------------
+	// append()
+	// @src : (IN) Messages to add after ours.
+	// @returns : True if added, false if there is no room.
+	//--------------------------------------------------------
+	bool append(const TSOSCCVExpanderTxMessage* src)
+	{
+		if (size + src->size > TROWA_OSCCV_EXPANDER_TX_BUFFER_SIZE)
+			return false;
+		std::memcpy(data + size, src->data, src->size);
+		size += src->size;
+		numMessages += src->numMessages;
+		return true;
+	}
+	//--------------------------------------------------------
+	// addTo()
+	// Add the messages to a bundle.
+	// @bundle : (IN/OUT) The bundle.
+	// @returns : The number of messages that didn't fit (0 if they were all added).
+	//--------------------------------------------------------
+	int addTo(TSOSCCVBundleWriter& bundle) const
+	{
+		int ix = 0;
+		int n = 0;
+		while (ix < size)
+		{
+			int msgSize = 0;
+			std::memcpy(&msgSize, data + ix, sizeof(int));
+			if (!bundle.addEncodedMessage(data + ix + sizeof(int), msgSize))
+				return numMessages - n;
+			ix += sizeof(int) + msgSize;
+			n++;
+		}
+		return 0;
+	}
 };
 
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSOSCCVModuleChain
+// Cached chain of neighboring modules of one model (i.e. a master's input or
+// output expanders, or the expanders between an expander and its master).
+// The chain is walked (model checks and all) only when it changes. Checking it
+// every sample is just comparing the neighbor pointers with the cached ones.
+// Only the first TROWA_OSCCV_MAX_CHAIN_LENGTH modules are cached; findEnd()
+// walks the rest (if any) every time.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCCVModuleChain
+{
+	// The modules in the chain (nearest first).
+	Module* modules[TROWA_OSCCV_MAX_CHAIN_LENGTH];
+	// Number of modules in the chain.
+	int length = 0;
+	// Module past the end of the chain (NULL for none).
+	Module* end = NULL;
+	// Model of the module past the end.
+	Model* endModel = NULL;
+
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// update()
+	// Rebuild the chain if any of the neighbors changed.
+	// @start : (IN) Module the chain starts from (not part of the chain).
+	// @left : (IN) True to follow the left expanders, false for the right.
+	// @model : (IN) Model of the modules in the chain.
+	// @returns : True if the chain was rebuilt.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	bool update(Module* start, bool left, Model* model)
+	{
+		Module* m = start;
+		for (int i = 0; i <= length; i++)
+		{
+			Module* next = (left) ? m->leftExpander.module : m->rightExpander.module;
+			bool inChain = i < length;
+			if (next != ((inChain) ? modules[i] : end) || (next != NULL && next->model != ((inChain) ? model : endModel)))
+			{
+				rebuild(start, left, model);
+				return true;
+			}
+			m = next;
+		}
+		return false;
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// rebuild()
+	// Walk the chain.
+	// @start : (IN) Module the chain starts from (not part of the chain).
+	// @left : (IN) True to follow the left expanders, false for the right.
+	// @model : (IN) Model of the modules in the chain.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void rebuild(Module* start, bool left, Model* model)
+	{
+		length = 0;
+		Module* m = (left) ? start->leftExpander.module : start->rightExpander.module;
+		while (m != NULL && m->model == model && length < TROWA_OSCCV_MAX_CHAIN_LENGTH)
+		{
+			modules[length++] = m;
+			m = (left) ? m->leftExpander.module : m->rightExpander.module;
+		}
+		end = m;
+		endModel = (m != NULL) ? m->model : NULL;
+		return;
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// findEnd()
+	// Find the module past the end of the whole chain. If the chain is longer
+	// than we cache, the rest is walked (not cached).
+	// @left : (IN) True to follow the left expanders, false for the right.
+	// @model : (IN) Model of the modules in the chain.
+	// @outEndModel : (OUT) Model of the module past the end (NULL for none).
+	// @chainLength : (OUT) Number of modules in the whole chain.
+	// @returns : The module past the end (NULL for none).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	Module* findEnd(bool left, Model* model, Model** outEndModel, int* chainLength) const
+	{
+		Module* m = end;
+		Model* mModel = endModel;
+		int n = length;
+		while (m != NULL && mModel == model)
+		{
+			m = (left) ? m->leftExpander.module : m->rightExpander.module;
+			mModel = (m != NULL) ? m->model : NULL;
+			n++;
+		}
+		*outEndModel = mModel;
+		*chainLength = n;
+		return m;
+	}
+};
 
 #endif // endif !TSOSCCV_COMMON_HPP
\ No newline at end of file
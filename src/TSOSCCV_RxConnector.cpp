@@ -1,6 +1,35 @@
 #include "TSOSCCV_RxConnector.hpp"
 #include "Module_oscCV.hpp"
 
+//--------------------------------------------------------------------------------------------------------------------------------------------
+// ProcessPacket()
+// @data : (IN) The packet.
+// @size : (IN) The packet size.
+// @remoteEndPoint: (IN) The remove end point (sender).
+// Time stamp the packet. Messages not in a bundle are 'immediate'.
+//--------------------------------------------------------------------------------------------------------------------------------------------
+void OscCVRxMsgRouter::ProcessPacket(const char* data, int size, const IpEndpointName& remoteEndpoint)
+{
+	currentTimeTag = TROWA_OSCCV_TIMETAG_IMMEDIATE;
+	currentArrivalTime = getOscCVClockTime();
+	osc::OscPacketListener::ProcessPacket(data, size, remoteEndpoint);
+	return;
+} // end ProcessPacket()
+
+//--------------------------------------------------------------------------------------------------------------------------------------------
+// ProcessBundle()
+// @rxBundle : (IN) The received bundle.
+// @remoteEndPoint: (IN) The remove end point (sender).
+// Keep the bundle's time tag for the messages inside it.
+//--------------------------------------------------------------------------------------------------------------------------------------------
+void OscCVRxMsgRouter::ProcessBundle(const osc::ReceivedBundle& rxBundle, const IpEndpointName& remoteEndpoint)
+{
+	uint64_t prevTimeTag = currentTimeTag;
+	currentTimeTag = rxBundle.TimeTag();
+	osc::OscPacketListener::ProcessBundle(rxBundle, remoteEndpoint);
+	currentTimeTag = prevTimeTag;
+	return;
+} // end ProcessBundle()
 
 //--------------------------------------------------------------------------------------------------------------------------------------------
 // ProcessMessage()
@@ -134,9 +163,9 @@ void OscCVRxMsgRouter::ProcessMessage(const osc::ReceivedMessage& rxMsg, const I
 #if USE_MODULE_STATIC_RX
 									// Re-use static buffer on module (this is a test):
 									if (numArgs > 1)
-										oscModule->addRxMsgToQueue(c + 1, bArgs);
+										oscModule->addRxMsgToQueue(c + 1, bArgs, currentTimeTag, currentArrivalTime);
 									else
-										oscModule->addRxMsgToQueue(c + 1, boolArg);
+										oscModule->addRxMsgToQueue(c + 1, boolArg, currentTimeTag, currentArrivalTime);
 #else
 									// Add *new* Message
 									oscModule->rxMsgMutex.lock();	
@@ -157,9 +186,9 @@ void OscCVRxMsgRouter::ProcessMessage(const osc::ReceivedMessage& rxMsg, const I
 #if USE_MODULE_STATIC_RX
 									// Re-use static buffer on module:
 									if (numArgs > 1)
-										oscModule->addRxMsgToQueue(c + 1, iArgs);
+										oscModule->addRxMsgToQueue(c + 1, iArgs, currentTimeTag, currentArrivalTime);
 									else
-										oscModule->addRxMsgToQueue(c + 1, intArg);
+										oscModule->addRxMsgToQueue(c + 1, intArg, currentTimeTag, currentArrivalTime);
 #else
 									// Add *new* Message
 									oscModule->rxMsgMutex.lock();
@@ -191,9 +220,9 @@ void OscCVRxMsgRouter::ProcessMessage(const osc::ReceivedMessage& rxMsg, const I
 #if USE_MODULE_STATIC_RX
 									// Re-use static buffer on module:
 									if (numArgs > 1)
-										oscModule->addRxMsgToQueue(c + 1, fArgs);
+										oscModule->addRxMsgToQueue(c + 1, fArgs, currentTimeTag, currentArrivalTime);
 									else
-										oscModule->addRxMsgToQueue(c + 1, floatArg);
+										oscModule->addRxMsgToQueue(c + 1, floatArg, currentTimeTag, currentArrivalTime);
 #else
 									oscModule->rxMsgMutex.lock();
 									if (numArgs > 1)
@@ -270,7 +299,7 @@ bool OscCVRxMsgRouter::deliverMessage(const char* path, oscCVExpander* expander,
 #endif
 #if USE_MODULE_STATIC_RX
 					// Re-use static buffer on module (this is a test):
-					expander->addRxMsgToQueue(c + 1, bArgs);
+					expander->addRxMsgToQueue(c + 1, bArgs, currentTimeTag, currentArrivalTime);
 #else
 					// Add *new* Message
 					queueMutex->lock();	
@@ -288,7 +317,7 @@ bool OscCVRxMsgRouter::deliverMessage(const char* path, oscCVExpander* expander,
 #endif
 #if USE_MODULE_STATIC_RX
 					// Re-use static buffer on module (this is a test):
-					expander->addRxMsgToQueue(c + 1, iArgs);
+					expander->addRxMsgToQueue(c + 1, iArgs, currentTimeTag, currentArrivalTime);
 #else
 					// Add *new* Message
 					queueMutex->lock();	
@@ -306,7 +335,7 @@ bool OscCVRxMsgRouter::deliverMessage(const char* path, oscCVExpander* expander,
 #endif
 #if USE_MODULE_STATIC_RX
 					// Re-use static buffer on module (this is a test):
-					expander->addRxMsgToQueue(c + 1, fArgs);
+					expander->addRxMsgToQueue(c + 1, fArgs, currentTimeTag, currentArrivalTime);
 #else
 					// Add *new* Message
 					queueMutex->lock();	
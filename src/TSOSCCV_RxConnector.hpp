@@ -19,6 +19,21 @@ class OscCVRxMsgRouter : public TSOSCBaseMsgRouter<oscCV> {
 public:
 	
 protected:
+	// Time tag of the bundle we are processing (TROWA_OSCCV_TIMETAG_IMMEDIATE if none).
+	uint64_t currentTimeTag = TROWA_OSCCV_TIMETAG_IMMEDIATE;
+	// When the packet we are processing arrived (s, local steady clock).
+	double currentArrivalTime = 0.0;
+
+	//--------------------------------------------------------------------------------------------------------------------------------------------
+	// ProcessPacket()
+	// Time stamp the packet and hand off to the OSC library.
+	//--------------------------------------------------------------------------------------------------------------------------------------------
+	virtual void ProcessPacket(const char* data, int size, const IpEndpointName& remoteEndpoint) override;
+	//--------------------------------------------------------------------------------------------------------------------------------------------
+	// ProcessBundle()
+	// Keep the bundle's time tag for the messages inside it.
+	//--------------------------------------------------------------------------------------------------------------------------------------------
+	virtual void ProcessBundle(const osc::ReceivedBundle& rxBundle, const IpEndpointName& remoteEndpoint) override;
 	//--------------------------------------------------------------------------------------------------------------------------------------------
 	// ProcessMessage()
 	// @rxMsg : (IN) The received message from the OSC library.
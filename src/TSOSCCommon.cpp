@@ -1,10 +1,20 @@
 #include "TSOSCCommon.hpp"
 #include <string>
+#include <stdlib.h>
 
 
 // The OSC client labels/strings. 
-std::string OSCClientStr[NUM_OSC_CLIENTS] = { "Generic", "touchOSC" };// , "Lemur" };
-std::string OSCClientAbbr[NUM_OSC_CLIENTS] = { "Gen", "tOSC" };// , "Lemr" };
+std::string OSCClientStr[NUM_OSC_CLIENTS] = { "Generic", "touchOSC", "Generic (Bulk)" };// , "Lemur" };
+std::string OSCClientAbbr[NUM_OSC_CLIENTS] = { "Gen", "tOSC", "Blk" };// , "Lemr" };
+
+// If the (dotted IPv4) address is a multicast group (224.0.0.0 - 239.255.255.255).
+bool OSCIsMulticastAddress(const char* ipAddress)
+{
+	if (ipAddress == NULL || ipAddress[0] < '0' || ipAddress[0] > '9')
+		return false;
+	int firstOctet = atoi(ipAddress);
+	return firstOctet >= 224 && firstOctet <= 239;
+}
 
 
 namespace touchOSC
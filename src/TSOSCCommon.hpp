@@ -2,6 +2,8 @@
 #define TSOSCCOMMON_HPP
 
 #include <string>
+#include <string.h>
+#include <stdint.h>
 
 //--- OSC defines --
 // Default OSC outgoing address (Tx). 127.0.0.1.
@@ -14,6 +16,10 @@
 #define OSC_DEFAULT_NS				"/tsseq"
 #define OSC_OUTPUT_BUFFER_SIZE		(1024*64)
 #define OSC_ADDRESS_BUFFER_SIZE		50
+// Default multicast TTL (hops). 1 stays on the local subnet.
+#define OSC_MULTICAST_TTL_DEF		1
+// Max multicast TTL offered in the menu.
+#define OSC_MULTICAST_TTL_MAX		32
 
 // What client are we talking to. touchOSC and Lemur are a little limited, so they need special treatment.
 enum OSCClient : uint8_t {
@@ -24,16 +30,45 @@ enum OSCClient : uint8_t {
 	touchOSCClient,
 	// Lemur : Special treatment not implemented yet.
 	//LemurClient,
+	// Generic with bulk sync: a whole channel is sent as one blob message (/edit/ch/steps) instead of one message per step.
+	BulkClient,
 	NUM_OSC_CLIENTS
 };
 // The OSC client labels/strings. Currently defined in ConfigWidget.
 extern std::string OSCClientStr[NUM_OSC_CLIENTS];
 // OSC Client abbreviations.
 extern std::string OSCClientAbbr[NUM_OSC_CLIENTS];
+// If the (dotted IPv4) address is a multicast group (224.0.0.0 - 239.255.255.255).
+bool OSCIsMulticastAddress(const char* ipAddress);
 
 
 
 //-------- Helpers -------------
+// Bulk step values (OSC blobs) are float32, big-endian (OSC byte order).
+#define OSC_BULK_VALUE_SIZE		4
+namespace OSCBulk
+{
+	// Write a value into a bulk blob.
+	inline void writeFloat(/*out*/ char* dst, /*in*/ float val)
+	{
+		uint32_t bits;
+		memcpy(&bits, &val, sizeof(bits));
+		dst[0] = (char)((bits >> 24) & 0xFF);
+		dst[1] = (char)((bits >> 16) & 0xFF);
+		dst[2] = (char)((bits >> 8) & 0xFF);
+		dst[3] = (char)(bits & 0xFF);
+		return;
+	}
+	// Read a value from a bulk blob.
+	inline float readFloat(/*in*/ const char* src)
+	{
+		const unsigned char* u = reinterpret_cast<const unsigned char*>(src);
+		uint32_t bits = ((uint32_t)u[0] << 24) | ((uint32_t)u[1] << 16) | ((uint32_t)u[2] << 8) | (uint32_t)u[3];
+		float val;
+		memcpy(&val, &bits, sizeof(val));
+		return val;
+	}
+}
 namespace touchOSC
 {
 	// touchOSC color strings for our channels. In future, this should maybe live in sequencer file since this is for sequencers (if we do touchOSC for other types of modules).
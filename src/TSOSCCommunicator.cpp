@@ -6,6 +6,21 @@
 #include <stdio.h>
 #include <map>
 #include <mutex>
+#include <chrono>
+#if TROWA_OSC_TX_USE_SENDMMSG || TROWA_OSC_LOCAL_TRANSPORT
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#if TROWA_OSC_LOCAL_TRANSPORT
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <errno.h>
+#include <stdlib.h>
+#endif
 
 #define MIN_PORT	1000
 #define MAX_PORT	0xFFFF
@@ -309,3 +324,711 @@ uint16_t TSOSCConnector::getAvailablePort(int id, TSOSCPortInfo::PortType portTy
 	}
 	return (portFound) ? port : 0;
 } // end getAvailablePort()
+
+
+//=======================================================
+// TSOSCTxQueue
+//=======================================================
+TSOSCTxQueue::TSOSCTxQueue(TSOSCTxEndpoint* endpoint, int capacity)
+{
+	this->endpoint = endpoint;
+	this->capacity = capacity & ~0x03; // Keep records 4 byte aligned
+	this->buffer = new char[this->capacity];
+	return;
+}
+TSOSCTxQueue::~TSOSCTxQueue()
+{
+	delete[] buffer;
+	buffer = NULL;
+	return;
+}
+//--------------------------------------------------------
+// push()
+// [Producer] Add a datagram. Does not block or allocate.
+// @data : (IN) The datagram.
+// @size : (IN) The size of the datagram.
+// @returns : True if queued, false if there is no room.
+//--------------------------------------------------------
+bool TSOSCTxQueue::push(const char* data, int size)
+{
+	int recSize = 4 + ((size + 3) & ~0x03);
+	if (size < 1 || recSize > capacity / 2)
+	{
+		droppedCount++;
+		return false;
+	}
+	int w = writeIx.load(std::memory_order_relaxed);
+	int r = readIx.load(std::memory_order_acquire);
+	int start = w;
+	if (w >= r)
+	{
+		int tail = capacity - w;
+		if (recSize > tail || (recSize == tail && r == 0))
+		{
+			// Wrap to the start (never let write catch up to read, that would look empty)
+			if (recSize >= r)
+			{
+				droppedCount++;
+				return false;
+			}
+			int32_t wrapMarker = 0;
+			memcpy(buffer + w, &wrapMarker, 4);
+			start = 0;
+		}
+	}
+	else if (recSize >= r - w)
+	{
+		droppedCount++;
+		return false;
+	}
+	int32_t sz = size;
+	memcpy(buffer + start, &sz, 4);
+	memcpy(buffer + start + 4, data, size);
+	w = start + recSize;
+	if (w >= capacity)
+		w = 0;
+	writeIx.store(w, std::memory_order_release);
+	return true;
+} // end push()
+//--------------------------------------------------------
+// peek()
+// [Consumer] Get pointers to the queued datagrams (they stay valid until consume()).
+// @datas : (OUT) The datagrams.
+// @sizes : (OUT) The datagram sizes.
+// @maxCount : (IN) Max datagrams to get.
+// @nextReadIx : (OUT) Pass to consume() once these are sent.
+// @returns : The number of datagrams.
+//--------------------------------------------------------
+int TSOSCTxQueue::peek(const char** datas, int* sizes, int maxCount, int& nextReadIx)
+{
+	int r = readIx.load(std::memory_order_relaxed);
+	int w = writeIx.load(std::memory_order_acquire);
+	int n = 0;
+	while (r != w && n < maxCount)
+	{
+		int32_t sz = 0;
+		memcpy(&sz, buffer + r, 4);
+		if (sz < 1)
+		{
+			// Wrap marker
+			r = 0;
+			continue;
+		}
+		datas[n] = buffer + r + 4;
+		sizes[n] = sz;
+		n++;
+		r += 4 + ((sz + 3) & ~0x03);
+		if (r >= capacity)
+			r = 0;
+	}
+	nextReadIx = r;
+	return n;
+} // end peek()
+// [Producer] Wake the Tx thread (call after pushing a frame's datagrams).
+void TSOSCTxQueue::signal()
+{
+	TSOSCTxService::Service()->wake();
+	return;
+}
+
+//=======================================================
+// TSOSCTxService
+//=======================================================
+TSOSCTxService::TSOSCTxService()
+{
+	_numSenders = 0;
+	return;
+}
+
+TSOSCTxService* TSOSCTxService::Service()
+{
+	// Created on first use (thread safe, several engine threads may get here at once). Never deleted.
+	static TSOSCTxService* instance = new TSOSCTxService();
+	return instance;
+}
+
+//--------------------------------------------------------
+// wake()
+// [Producer] Wake the Tx thread. Only the first signal since the Tx thread last
+// looked notifies. If we get the wait mutex (without waiting), the Tx thread is
+// either blocked or hasn't checked the flag yet, so the signal can't be missed;
+// if not, TROWA_OSC_TX_WAIT_MS is the most it can be late.
+//--------------------------------------------------------
+void TSOSCTxService::wake()
+{
+	if (!_wakePending.exchange(true, std::memory_order_acq_rel))
+	{
+		if (_wakeMutex.try_lock())
+			_wakeMutex.unlock();
+		_wakeCv.notify_one();
+	}
+	return;
+} // end wake()
+
+//--------------------------------------------------------
+// registerSender()
+// @ipAddress : (IN) The destination ip address / host.
+// @port : (IN) The destination port.
+// @multicastTtl : (IN) TTL if @ipAddress is a multicast group.
+// @multicastLoopback : (IN) If @ipAddress is a multicast group, also deliver to listeners on this host.
+// @returns : The sender's queue or NULL if the endpoint can't be opened.
+//--------------------------------------------------------
+TSOSCTxQueue* TSOSCTxService::registerSender(const char* ipAddress, uint16_t port, uint8_t multicastTtl, bool multicastLoopback)
+{
+	std::lock_guard<std::mutex> lifeLock(_lifeMutex);
+	TSOSCTxQueue* queue = NULL;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		bool isMulticast = OSCIsMulticastAddress(ipAddress);
+		std::string key = std::string(ipAddress) + ":" + std::to_string(port);
+		if (isMulticast)
+		{
+			// Senders with different multicast options need their own sockets
+			key += " ttl " + std::to_string(multicastTtl) + ((multicastLoopback) ? " loop" : "");
+		}
+		TSOSCTxEndpoint* endpoint = NULL;
+		std::map<std::string, TSOSCTxEndpoint*>::iterator it = _endpoints.find(key);
+		if (it != _endpoints.end())
+		{
+			endpoint = it->second;
+		}
+		else
+		{
+			try
+			{
+				IpEndpointName endpointName(ipAddress, port);
+				endpoint = new TSOSCTxEndpoint();
+				endpoint->key = key;
+#if TROWA_OSC_TX_USE_SENDMMSG
+				struct sockaddr_in addr;
+				memset(&addr, 0, sizeof(addr));
+				addr.sin_family = AF_INET;
+				addr.sin_addr.s_addr = htonl(endpointName.address);
+				addr.sin_port = htons(endpointName.port);
+				endpoint->socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+				if (endpoint->socketFd < 0 || connect(endpoint->socketFd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+				{
+					WARN("TSOSCTxService - Unable to open socket to %s.", key.c_str());
+					if (endpoint->socketFd >= 0)
+						close(endpoint->socketFd);
+					delete endpoint;
+					return NULL;
+				}
+				if (isMulticast)
+				{
+					unsigned char ttl = multicastTtl;
+					unsigned char loop = (multicastLoopback) ? 1 : 0;
+					setsockopt(endpoint->socketFd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+					setsockopt(endpoint->socketFd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+				}
+#else
+				endpoint->txSocket = new UdpTransmitSocket(endpointName);
+				if (isMulticast)
+				{
+					endpoint->txSocket->SetMulticastTtl(multicastTtl);
+					endpoint->txSocket->SetMulticastLoopback(multicastLoopback);
+				}
+#endif
+				_endpoints[key] = endpoint;
+			}
+			catch (const std::exception& ex)
+			{
+				WARN("TSOSCTxService - Unable to open socket to %s: %s.", key.c_str(), ex.what());
+				if (endpoint != NULL)
+					delete endpoint;
+				return NULL;
+			}
+		}
+		queue = addSender(endpoint);
+	}
+	startThread();
+	return queue;
+} // end registerSender()
+
+#if TROWA_OSC_LOCAL_TRANSPORT
+//--------------------------------------------------------
+// registerLocalSender()
+// The receiver doesn't have to be up yet: the Tx thread connects when it is
+// (datagrams until then are dropped, like UDP to a closed port).
+// @port : (IN) The destination port (names the socket).
+// @returns : The sender's queue.
+//--------------------------------------------------------
+TSOSCTxQueue* TSOSCTxService::registerLocalSender(uint16_t port)
+{
+	std::string path = TSOSCLocalSocketPath(port); // May throw, don't hold the locks
+	std::lock_guard<std::mutex> lifeLock(_lifeMutex);
+	TSOSCTxQueue* queue = NULL;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::string key = "local:" + path;
+		TSOSCTxEndpoint* endpoint = NULL;
+		std::map<std::string, TSOSCTxEndpoint*>::iterator it = _endpoints.find(key);
+		if (it != _endpoints.end())
+		{
+			endpoint = it->second;
+		}
+		else
+		{
+			endpoint = new TSOSCTxEndpoint();
+			endpoint->key = key;
+			endpoint->localPath = path;
+			_endpoints[key] = endpoint;
+		}
+		queue = addSender(endpoint);
+	}
+	startThread();
+	return queue;
+} // end registerLocalSender()
+#endif
+
+// Add a sender (queue) to the endpoint. Call with _mutex held.
+TSOSCTxQueue* TSOSCTxService::addSender(TSOSCTxEndpoint* endpoint)
+{
+	TSOSCTxQueue* queue = new TSOSCTxQueue(endpoint, TROWA_OSC_TX_QUEUE_SIZE);
+	endpoint->queues.push_back(queue);
+	_numSenders++;
+	return queue;
+}
+
+// Start the Tx thread if it isn't running. Call with _lifeMutex held.
+void TSOSCTxService::startThread()
+{
+	if (!_running)
+	{
+		_running = true;
+		_thread = std::thread(&TSOSCTxService::run, this);
+	}
+	return;
+}
+
+//--------------------------------------------------------
+// unregisterSender()
+// @queue : (IN) The sender's queue (will be deleted).
+//--------------------------------------------------------
+void TSOSCTxService::unregisterSender(TSOSCTxQueue* queue)
+{
+	if (queue == NULL)
+		return;
+	std::lock_guard<std::mutex> lifeLock(_lifeMutex);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		TSOSCTxEndpoint* endpoint = queue->endpoint;
+		std::vector<TSOSCTxQueue*>::iterator position = std::find(endpoint->queues.begin(), endpoint->queues.end(), queue);
+		if (position != endpoint->queues.end())
+		{
+			endpoint->queues.erase(position);
+			_numSenders--;
+		}
+		delete queue;
+		if (endpoint->queues.size() < 1)
+		{
+			// No more senders, close.
+			_endpoints.erase(endpoint->key);
+#if TROWA_OSC_TX_USE_SENDMMSG
+			if (endpoint->socketFd >= 0)
+				close(endpoint->socketFd);
+#else
+			delete endpoint->txSocket;
+#endif
+#if TROWA_OSC_LOCAL_TRANSPORT
+			if (endpoint->localFd >= 0)
+				close(endpoint->localFd);
+#endif
+			delete endpoint;
+		}
+	}
+	if (_numSenders < 1 && _running)
+	{
+		// Stop the Tx thread (we don't want it running when the plugin is unloaded).
+		{
+			std::lock_guard<std::mutex> wakeLock(_wakeMutex);
+			_running = false;
+		}
+		_wakeCv.notify_one();
+		if (_thread.joinable())
+			_thread.join();
+	}
+	return;
+} // end unregisterSender()
+
+//--------------------------------------------------------
+// run()
+// Tx thread. Sleep until a sender signals, then flush all queues.
+//--------------------------------------------------------
+void TSOSCTxService::run()
+{
+	while (_running)
+	{
+		{
+			std::unique_lock<std::mutex> wakeLock(_wakeMutex);
+			_wakeCv.wait_for(wakeLock, std::chrono::milliseconds(TROWA_OSC_TX_WAIT_MS), [this]() {
+				return _wakePending.load(std::memory_order_acquire) || !_running;
+			});
+		}
+		_wakePending.store(false, std::memory_order_release);
+		flush();
+	}
+	flush(); // Last bit
+	return;
+} // end run()
+
+//--------------------------------------------------------
+// flush()
+// Send everything that's queued.
+//--------------------------------------------------------
+void TSOSCTxService::flush()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (std::map<std::string, TSOSCTxEndpoint*>::iterator it = _endpoints.begin(); it != _endpoints.end(); it++)
+	{
+		flushEndpoint(it->second);
+	}
+	return;
+} // end flush()
+
+#if TROWA_OSC_LOCAL_TRANSPORT
+//--------------------------------------------------------
+// connectLocal()
+// Connect the endpoint's local socket if the receiver is up (retry at most
+// every TROWA_OSC_LOCAL_RETRY_MS). The send buffer is raised so bundles bigger
+// than the default max datagram (2 KB on macOS) go through.
+// @returns : True if connected.
+//--------------------------------------------------------
+static bool connectLocal(TSOSCTxEndpoint* endpoint)
+{
+	if (endpoint->localFd >= 0)
+		return true;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now - endpoint->lastConnectTime < std::chrono::milliseconds(TROWA_OSC_LOCAL_RETRY_MS))
+		return false;
+	endpoint->lastConnectTime = now;
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, endpoint->localPath.c_str(), sizeof(addr.sun_path) - 1);
+	int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if (fd < 0)
+		return false;
+	int bufSize = TROWA_OSC_LOCAL_MAX_DATAGRAM;
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize)); // Best effort
+	if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		close(fd); // Receiver isn't up (yet)
+		return false;
+	}
+	endpoint->localFd = fd;
+	return true;
+} // end connectLocal()
+
+//--------------------------------------------------------
+// sendLocalBatch()
+// Send the datagrams to the local endpoint. Called under the service lock, so
+// never waits: if the receiver is behind, the rest is dropped (like UDP). A
+// datagram that is too big is dropped by itself. If the receiver is down,
+// everything is dropped.
+//--------------------------------------------------------
+static void sendLocalBatch(TSOSCTxEndpoint* endpoint, const char** datas, const int* sizes, int n)
+{
+	if (!connectLocal(endpoint))
+		return;
+	int sent = 0;
+	while (sent < n)
+	{
+#if TROWA_OSC_TX_USE_SENDMMSG
+		struct mmsghdr msgs[TROWA_OSC_TX_BATCH_SIZE];
+		struct iovec iovs[TROWA_OSC_TX_BATCH_SIZE];
+		memset(msgs, 0, sizeof(msgs));
+		for (int i = sent; i < n; i++)
+		{
+			iovs[i - sent].iov_base = const_cast<char*>(datas[i]);
+			iovs[i - sent].iov_len = sizes[i];
+			msgs[i - sent].msg_hdr.msg_iov = &(iovs[i - sent]);
+			msgs[i - sent].msg_hdr.msg_iovlen = 1;
+		}
+		int r = sendmmsg(endpoint->localFd, msgs, n - sent, MSG_DONTWAIT);
+#else
+		int r = (send(endpoint->localFd, datas[sent], sizes[sent], MSG_DONTWAIT) < 0) ? -1 : 1;
+#endif
+		if (r < 1)
+		{
+			if (errno == EMSGSIZE)
+			{
+				sent++; // Too big for the socket, drop just this one
+				continue;
+			}
+			else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS)
+			{
+				// Receiver went away, reconnect when it's back
+				close(endpoint->localFd);
+				endpoint->localFd = -1;
+			}
+			break; // Drop the rest (receiver is behind or gone)
+		}
+		sent += r;
+	}
+	return;
+} // end sendLocalBatch()
+#endif // TROWA_OSC_LOCAL_TRANSPORT
+
+//--------------------------------------------------------
+// sendBatch()
+// Send the datagrams to the endpoint (one sendmmsg call if we can). Called
+// under the service lock, so a full send buffer drops the rest (like UDP).
+//--------------------------------------------------------
+static void sendBatch(TSOSCTxEndpoint* endpoint, const char** datas, const int* sizes, int n)
+{
+#if TROWA_OSC_LOCAL_TRANSPORT
+	if (!endpoint->localPath.empty())
+	{
+		sendLocalBatch(endpoint, datas, sizes, n);
+		return;
+	}
+#endif
+#if TROWA_OSC_TX_USE_SENDMMSG
+	struct mmsghdr msgs[TROWA_OSC_TX_BATCH_SIZE];
+	struct iovec iovs[TROWA_OSC_TX_BATCH_SIZE];
+	memset(msgs, 0, sizeof(msgs));
+	for (int i = 0; i < n; i++)
+	{
+		iovs[i].iov_base = const_cast<char*>(datas[i]);
+		iovs[i].iov_len = sizes[i];
+		msgs[i].msg_hdr.msg_iov = &(iovs[i]);
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+	int sent = 0;
+	while (sent < n)
+	{
+		// Never wait, we have the service lock (the UI thread may be waiting on it to register/unregister)
+		int r = sendmmsg(endpoint->socketFd, msgs + sent, n - sent, MSG_DONTWAIT);
+		if (r < 1)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+				break; // Send buffer full, UDP, just drop the rest
+			sent++; // Error on this one (i.e. refused, too big), drop just it
+			continue;
+		}
+		sent += r;
+	}
+#else
+	for (int i = 0; i < n; i++)
+	{
+		try
+		{
+			endpoint->txSocket->Send(datas[i], sizes[i]);
+		}
+		catch (const std::exception& ex)
+		{
+			WARN("TSOSCTxService - Error sending to %s: %s.", endpoint->key.c_str(), ex.what());
+			break;
+		}
+	}
+#endif
+	return;
+} // end sendBatch()
+
+//--------------------------------------------------------
+// flushEndpoint()
+// Send everything that's queued for this endpoint (from all its senders).
+// Batches up to TROWA_OSC_TX_BATCH_SIZE datagrams per send call.
+//--------------------------------------------------------
+void TSOSCTxService::flushEndpoint(TSOSCTxEndpoint* endpoint)
+{
+	const char* datas[TROWA_OSC_TX_BATCH_SIZE];
+	int sizes[TROWA_OSC_TX_BATCH_SIZE];
+	// Queues in this batch and where to move their read index to once sent.
+	TSOSCTxQueue* batchQueues[TROWA_OSC_TX_BATCH_SIZE];
+	int batchReadIxs[TROWA_OSC_TX_BATCH_SIZE];
+	int nQueues = 0;
+	int n = 0;
+	for (size_t q = 0; q < endpoint->queues.size(); q++)
+	{
+		bool queueEmpty = false;
+		while (!queueEmpty)
+		{
+			int nextReadIx = 0;
+			int count = endpoint->queues[q]->peek(datas + n, sizes + n, TROWA_OSC_TX_BATCH_SIZE - n, nextReadIx);
+			if (count > 0)
+			{
+				batchQueues[nQueues] = endpoint->queues[q];
+				batchReadIxs[nQueues] = nextReadIx;
+				nQueues++;
+				n += count;
+			}
+			if (n < TROWA_OSC_TX_BATCH_SIZE)
+			{
+				queueEmpty = true; // Got everything from this queue
+			}
+			else
+			{
+				// Batch is full
+				sendBatch(endpoint, datas, sizes, n);
+				for (int i = 0; i < nQueues; i++)
+					batchQueues[i]->consume(batchReadIxs[i]);
+				n = 0;
+				nQueues = 0;
+			}
+		} // end while
+	} // end for
+	if (n > 0)
+	{
+		sendBatch(endpoint, datas, sizes, n);
+		for (int i = 0; i < nQueues; i++)
+			batchQueues[i]->consume(batchReadIxs[i]);
+	}
+	return;
+} // end flushEndpoint()
+
+#if TROWA_OSC_LOCAL_TRANSPORT
+//=======================================================
+// Local transport
+//=======================================================
+//--------------------------------------------------------
+// TSOSCLocalSocketPath()
+// Sockets go in $XDG_RUNTIME_DIR/trowasoft-osc, else in
+// $TMPDIR/trowasoft-osc-<uid> (or /tmp), made mode 0700 so other users can't
+// connect, squat or swap in a link.
+// Throws std::runtime_error if the directory can't be made or isn't ours.
+// @port : (IN) The port (names the socket).
+// @returns : The socket path.
+//--------------------------------------------------------
+std::string TSOSCLocalSocketPath(uint16_t port)
+{
+	char buffer[64];
+	std::string dir;
+	const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+	if (runtimeDir != NULL && runtimeDir[0] == '/')
+	{
+		dir = std::string(runtimeDir) + "/" + TROWA_OSC_LOCAL_DIR_NAME;
+	}
+	else
+	{
+		const char* tmpDir = getenv("TMPDIR");
+		dir = (tmpDir != NULL && tmpDir[0] == '/') ? std::string(tmpDir) : std::string("/tmp");
+		if (dir.back() != '/')
+			dir += "/";
+		snprintf(buffer, sizeof(buffer), "%s-%u", TROWA_OSC_LOCAL_DIR_NAME, static_cast<unsigned int>(getuid()));
+		dir += buffer;
+	}
+	if (mkdir(dir.c_str(), 0700) < 0 && errno != EEXIST)
+		throw std::runtime_error("unable to create local socket directory " + dir);
+	// Don't trust one that was already there unless it's ours and private (lstat, so not a link)
+	struct stat st;
+	if (lstat(dir.c_str(), &st) < 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 077) != 0)
+		throw std::runtime_error("local socket directory " + dir + " is not a private directory owned by this user");
+	snprintf(buffer, sizeof(buffer), "/%u", static_cast<unsigned int>(port));
+	std::string path = dir + buffer;
+	if (path.length() >= sizeof(((struct sockaddr_un*)NULL)->sun_path))
+		throw std::runtime_error("local socket path " + path + " is too long");
+	return path;
+} // end TSOSCLocalSocketPath()
+
+//--------------------------------------------------------
+// TSOSCLocalListeningSocket()
+// Throws std::runtime_error if the socket can't be created or is in use.
+// @port : (IN) The port (names the socket).
+// @listener : (IN) The packet listener.
+//--------------------------------------------------------
+TSOSCLocalListeningSocket::TSOSCLocalListeningSocket(uint16_t port, PacketListener* listener)
+{
+	this->listener = listener;
+	this->path = TSOSCLocalSocketPath(port);
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	// If the path is there, see if someone is still listening on it (else it's left over from a crash)
+	int probeFd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if (probeFd >= 0)
+	{
+		bool inUse = connect(probeFd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+		close(probeFd);
+		if (inUse)
+			throw std::runtime_error("local socket " + path + " is in use");
+	}
+	unlink(path.c_str());
+	socketFd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if (socketFd < 0)
+		throw std::runtime_error("unable to create local socket");
+	int bufSize = TROWA_OSC_LOCAL_MAX_DATAGRAM;
+	setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize)); // Best effort (room for big bundles)
+	if (bind(socketFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || pipe(breakPipe) < 0)
+	{
+		close(socketFd);
+		socketFd = -1;
+		throw std::runtime_error("unable to bind local socket " + path);
+	}
+	buffer = new char[TROWA_OSC_LOCAL_MAX_DATAGRAM];
+	return;
+}
+TSOSCLocalListeningSocket::~TSOSCLocalListeningSocket()
+{
+	if (socketFd >= 0)
+	{
+		close(socketFd);
+		unlink(path.c_str());
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		if (breakPipe[i] >= 0)
+			close(breakPipe[i]);
+	}
+	delete[] buffer;
+	return;
+}
+
+//--------------------------------------------------------
+// Run()
+// Loop and block processing packets until AsynchronousBreak().
+//--------------------------------------------------------
+void TSOSCLocalListeningSocket::Run()
+{
+	breakRequested = false;
+	struct pollfd fds[2];
+	fds[0].fd = socketFd;
+	fds[0].events = POLLIN;
+	fds[1].fd = breakPipe[0];
+	fds[1].events = POLLIN;
+	while (!breakRequested)
+	{
+		fds[0].revents = 0;
+		fds[1].revents = 0;
+		if (poll(fds, 2, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (breakRequested || (fds[1].revents & POLLIN))
+			break;
+		if (fds[0].revents & POLLIN)
+		{
+			ssize_t size = recv(socketFd, buffer, TROWA_OSC_LOCAL_MAX_DATAGRAM, 0);
+			if (size > 0)
+			{
+				try
+				{
+					// No IP endpoint for a local sender
+					listener->ProcessPacket(buffer, static_cast<int>(size), IpEndpointName());
+				}
+				catch (const std::exception& ex)
+				{
+					WARN("TSOSCLocalListeningSocket - Error processing packet on %s: %s.", path.c_str(), ex.what());
+				}
+			}
+		}
+	} // end while
+	return;
+} // end Run()
+
+// Exit Run() (from another thread).
+void TSOSCLocalListeningSocket::AsynchronousBreak()
+{
+	breakRequested = true;
+	char c = 0;
+	if (write(breakPipe[1], &c, 1) < 0)
+	{
+		// Run() also checks the flag
+	}
+	return;
+}
+#endif // TROWA_OSC_LOCAL_TRANSPORT
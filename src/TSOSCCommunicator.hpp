@@ -3,9 +3,12 @@
 
 #include <thread> // std::thread
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <string.h>
 #include <map>
 #include <vector>
+#include <chrono>
 
 #include "../lib/oscpack/osc/OscOutboundPacketStream.h"
 #include "../lib/oscpack/ip/UdpSocket.h"
@@ -13,6 +16,24 @@
 #include "../lib/oscpack/osc/OscPacketListener.h"
 
 #include "TSOSCSequencerListener.hpp"
+#include "TSOSCCommon.hpp"
+
+#if defined(__linux__)
+#define TROWA_OSC_TX_USE_SENDMMSG		1 // Batch datagrams with sendmmsg (Linux only). Otherwise we loop with UdpTransmitSocket::Send().
+#else
+#define TROWA_OSC_TX_USE_SENDMMSG		0 // Batch datagrams with sendmmsg (Linux only). Otherwise we loop with UdpTransmitSocket::Send().
+#endif
+#define TROWA_OSC_TX_QUEUE_SIZE	  (1024*256) // Size (bytes) of each sender's datagram queue.
+#define TROWA_OSC_TX_BATCH_SIZE			  64 // Max number of datagrams per sendmmsg call.
+#define TROWA_OSC_TX_WAIT_MS			  20 // Longest (ms) the Tx thread sleeps without being signaled (backstop for a missed signal).
+#if defined(_WIN32)
+#define TROWA_OSC_LOCAL_TRANSPORT		0 // Local transport (unix domain datagram sockets) for OSC clients on this host. Not on Windows.
+#else
+#define TROWA_OSC_LOCAL_TRANSPORT		1 // Local transport (unix domain datagram sockets) for OSC clients on this host. Not on Windows.
+#endif
+#define TROWA_OSC_LOCAL_DIR_NAME		"trowasoft-osc" // Local socket directory in $XDG_RUNTIME_DIR (else "<name>-<uid>" in $TMPDIR or /tmp). The port number names the socket.
+#define TROWA_OSC_LOCAL_MAX_DATAGRAM	(1024*64) // Max local datagram we read.
+#define TROWA_OSC_LOCAL_RETRY_MS		 500 // How often (ms) the Tx thread retries a local endpoint that isn't up.
 
 // OSC connection information
 typedef struct TSOSCInfo {	
@@ -22,6 +43,12 @@ typedef struct TSOSCInfo {
 	uint16_t oscTxPort;
 	// OSC input port number.
 	uint16_t oscRxPort;
+	// Multicast TTL (hops) if the address is a multicast group.
+	uint8_t multicastTtl;
+	// If our multicast datagrams should also go to listeners on this host.
+	bool multicastLoopback;
+	// Use the local transport (unix domain sockets named by the ports) instead of UDP.
+	bool localTransport;
 } TSOSCConnectionInfo;
 
 // Osc port information
@@ -112,4 +139,258 @@ private:
 	std::mutex _mutex;
 };
 
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSOSCListeningSocket
+// Like oscpack's UdpListeningReceiveSocket, but can join a multicast group.
+// For a group, the port is bound with address reuse so other listeners on this
+// host (other Rack instances, visualizers) get the same datagrams.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+class TSOSCListeningSocket : public UdpSocket
+{
+public:
+	//--------------------------------------------------------
+	// TSOSCListeningSocket()
+	// Throws std::runtime_error if the port can't be bound or the group joined.
+	// @port : (IN) The port to listen on (any address).
+	// @listener : (IN) The packet listener.
+	// @multicastGroup : (IN) Group to join (NULL or not a multicast address for unicast only).
+	//--------------------------------------------------------
+	TSOSCListeningSocket(uint16_t port, PacketListener* listener, const char* multicastGroup = NULL) : listener(listener)
+	{
+		bool isMulticast = OSCIsMulticastAddress(multicastGroup);
+		if (isMulticast)
+			SetAllowReuse(true);
+		Bind(IpEndpointName(IpEndpointName::ANY_ADDRESS, port));
+		if (isMulticast)
+			joinGroup(multicastGroup);
+		mux.AttachSocketListener(this, listener);
+		return;
+	}
+	~TSOSCListeningSocket()
+	{
+		mux.DetachSocketListener(this, listener);
+		return;
+	}
+	//--------------------------------------------------------
+	// joinGroup()
+	// Join a multicast group (reference counted, so several modules may share a socket and group).
+	// @multicastGroup : (IN) The group address.
+	// @returns : False if not a multicast address.
+	//--------------------------------------------------------
+	bool joinGroup(const char* multicastGroup)
+	{
+		if (!OSCIsMulticastAddress(multicastGroup))
+			return false;
+		std::string group = multicastGroup;
+		if (groups[group] < 1)
+			JoinMulticastGroup(IpEndpointName(multicastGroup, 0));
+		groups[group]++;
+		return true;
+	}
+	//--------------------------------------------------------
+	// leaveGroup()
+	// Leave a multicast group (once everyone that joined has left).
+	// @multicastGroup : (IN) The group address.
+	//--------------------------------------------------------
+	void leaveGroup(const char* multicastGroup)
+	{
+		if (!OSCIsMulticastAddress(multicastGroup))
+			return;
+		std::map<std::string, int>::iterator it = groups.find(std::string(multicastGroup));
+		if (it != groups.end() && --(it->second) < 1)
+		{
+			LeaveMulticastGroup(IpEndpointName(multicastGroup, 0));
+			groups.erase(it);
+		}
+		return;
+	}
+	// Loop and block processing messages (listener thread).
+	void Run() { mux.Run(); }
+	// Exit Run() (from another thread).
+	void AsynchronousBreak() { mux.AsynchronousBreak(); }
+protected:
+	SocketReceiveMultiplexer mux;
+	PacketListener* listener;
+	// Groups joined and how many joined each.
+	std::map<std::string, int> groups;
+};
+
+#if TROWA_OSC_LOCAL_TRANSPORT
+// Path of the local socket for this port (in a directory only this user can use).
+// Throws std::runtime_error if the directory can't be made or isn't safe.
+std::string TSOSCLocalSocketPath(uint16_t port);
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSOSCLocalListeningSocket
+// Receives OSC packets (same framing as UDP, one packet per datagram) on a unix
+// domain datagram socket, for clients on this host (skips the UDP/IP stack).
+// Same Run()/AsynchronousBreak() use as TSOSCListeningSocket.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+class TSOSCLocalListeningSocket
+{
+public:
+	//--------------------------------------------------------
+	// TSOSCLocalListeningSocket()
+	// Throws std::runtime_error if the socket can't be created or is in use.
+	// @port : (IN) The port (names the socket, see TSOSCLocalSocketPath()).
+	// @listener : (IN) The packet listener.
+	//--------------------------------------------------------
+	TSOSCLocalListeningSocket(uint16_t port, PacketListener* listener);
+	~TSOSCLocalListeningSocket();
+	// Loop and block processing packets (listener thread).
+	void Run();
+	// Exit Run() (from another thread).
+	void AsynchronousBreak();
+	// The socket path.
+	std::string getPath() const { return path; }
+protected:
+	PacketListener* listener;
+	std::string path;
+	int socketFd = -1;
+	// Wakes Run() for a break.
+	int breakPipe[2] = { -1, -1 };
+	std::atomic<bool> breakRequested { false };
+	char* buffer = NULL;
+};
+#endif // TROWA_OSC_LOCAL_TRANSPORT
+
+struct TSOSCTxEndpoint;
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSOSCTxQueue
+// Queue of outgoing datagrams for one sender (module).
+// Single producer (the module's process()), single consumer (the Tx thread), lock free.
+// Records are [int32 size][data padded to 4 bytes]. A size of 0 means wrap to the start.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCTxQueue
+{
+	// The endpoint this sender talks to.
+	TSOSCTxEndpoint* endpoint = NULL;
+	// Number of datagrams that didn't fit in the queue.
+	std::atomic<uint32_t> droppedCount { 0 };
+
+	TSOSCTxQueue(TSOSCTxEndpoint* endpoint, int capacity);
+	~TSOSCTxQueue();
+	//--------------------------------------------------------
+	// push()
+	// [Producer] Add a datagram. Does not block or allocate.
+	// @data : (IN) The datagram.
+	// @size : (IN) The size of the datagram.
+	// @returns : True if queued, false if there is no room.
+	//--------------------------------------------------------
+	bool push(const char* data, int size);
+	//--------------------------------------------------------
+	// peek()
+	// [Consumer] Get pointers to the queued datagrams (they stay valid until consume()).
+	// @datas : (OUT) The datagrams.
+	// @sizes : (OUT) The datagram sizes.
+	// @maxCount : (IN) Max datagrams to get.
+	// @nextReadIx : (OUT) Pass to consume() once these are sent.
+	// @returns : The number of datagrams.
+	//--------------------------------------------------------
+	int peek(const char** datas, int* sizes, int maxCount, int& nextReadIx);
+	//--------------------------------------------------------
+	// signal()
+	// [Producer] Wake the Tx thread (call after pushing a frame's datagrams). Does not block.
+	//--------------------------------------------------------
+	void signal();
+	// [Consumer] Release the datagrams from peek().
+	void consume(int nextReadIx)
+	{
+		readIx.store(nextReadIx, std::memory_order_release);
+	}
+protected:
+	char* buffer = NULL;
+	int capacity = 0;
+	std::atomic<int> writeIx { 0 };
+	std::atomic<int> readIx { 0 };
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSOSCTxEndpoint
+// A destination (ip:port) shared by all senders talking to it.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOSCTxEndpoint
+{
+	// The key (ip:port, plus the multicast options for a group).
+	std::string key;
+	// The senders using this endpoint.
+	std::vector<TSOSCTxQueue*> queues;
+#if TROWA_OSC_TX_USE_SENDMMSG
+	// Connected UDP socket.
+	int socketFd = -1;
+#else
+	// Sending socket.
+	UdpTransmitSocket* txSocket = NULL;
+#endif
+#if TROWA_OSC_LOCAL_TRANSPORT
+	// Local socket path (empty for UDP).
+	std::string localPath;
+	// Local socket (-1 until the receiver is up and we connect).
+	int localFd = -1;
+	// When we last tried to connect the local socket.
+	std::chrono::steady_clock::time_point lastConnectTime;
+#endif
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSOSCTxService
+// Process-wide OSC transmitter. Modules queue datagrams from the audio thread and
+// one Tx thread sends them (batched per endpoint) so there is no network I/O in process().
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+class TSOSCTxService
+{
+public:
+	static TSOSCTxService* Service();
+	// Register a sender to the endpoint. Returns NULL if the endpoint can't be opened.
+	TSOSCTxQueue* registerSender(const char* ipAddress, uint16_t port, uint8_t multicastTtl = OSC_MULTICAST_TTL_DEF, bool multicastLoopback = true);
+	// Unregister a sender (deletes the queue). Closes the endpoint if no one else is using it.
+	void unregisterSender(TSOSCTxQueue* queue);
+
+	// Register a sender to the endpoint. Returns NULL if the endpoint can't be opened.
+	static TSOSCTxQueue* RegisterSender(const char* ipAddress, uint16_t port, uint8_t multicastTtl = OSC_MULTICAST_TTL_DEF, bool multicastLoopback = true) { return Service()->registerSender(ipAddress, port, multicastTtl, multicastLoopback); }
+#if TROWA_OSC_LOCAL_TRANSPORT
+	// Register a sender to the local endpoint (port names the socket). The receiver doesn't have to be up yet.
+	TSOSCTxQueue* registerLocalSender(uint16_t port);
+	// Register a sender to the local endpoint (port names the socket).
+	static TSOSCTxQueue* RegisterLocalSender(uint16_t port) { return Service()->registerLocalSender(port); }
+#endif
+	// Unregister a sender (deletes the queue).
+	static void UnregisterSender(TSOSCTxQueue* queue) { Service()->unregisterSender(queue); }
+	//--------------------------------------------------------
+	// wake()
+	// [Producer] Wake the Tx thread, there is something to send. Does not block.
+	//--------------------------------------------------------
+	void wake();
+private:
+	TSOSCTxService();
+	// Tx thread.
+	void run();
+	// Send everything that's queued.
+	void flush();
+	// Send everything that's queued for this endpoint.
+	void flushEndpoint(TSOSCTxEndpoint* endpoint);
+	// Add a sender (queue) to the endpoint. Call with _mutex held.
+	TSOSCTxQueue* addSender(TSOSCTxEndpoint* endpoint);
+	// Start the Tx thread if it isn't running. Call with _lifeMutex held.
+	void startThread();
+
+	// Endpoints by ip:port.
+	std::map<std::string, TSOSCTxEndpoint*> _endpoints;
+	// Number of registered senders.
+	int _numSenders;
+	// Protects the endpoints (Tx thread vs register/unregister). Never taken by the audio thread.
+	std::mutex _mutex;
+	// Serializes starting/stopping the Tx thread.
+	std::mutex _lifeMutex;
+	std::thread _thread;
+	std::atomic<bool> _running { false };
+	// Something was queued since the Tx thread last looked.
+	std::atomic<bool> _wakePending { false };
+	// Tx thread waits on this for a signal.
+	std::mutex _wakeMutex;
+	std::condition_variable _wakeCv;
+};
+
 #endif // !TSOSCCOMMUNICATOR_HPP
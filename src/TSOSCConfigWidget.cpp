@@ -265,6 +265,10 @@ void TSOSCConfigWidget::draw(const DrawArgs &args) {
 	float y = START_Y - 1;
 	float x;
 	const char* labels[] = { "OSC IP Address", "Out Port", "In Port" };
+	if (localTransport)
+		labels[0] = "Local (IP Unused)"; // Ports name the local sockets
+	else if (OSCIsMulticastAddress(tbIpAddress->text.c_str()))
+		labels[0] = "Multicast Group"; // Sent to the group and joined on the In Port
 	for (int i = 0; i < TSOSC_NUM_TXTFIELDS; i++)
 	{
 		x = textBoxes[i]->box.pos.x + 2;
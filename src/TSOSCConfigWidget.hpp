@@ -13,6 +13,7 @@ extern Plugin *pluginInstance;
 #include "TSTextField.hpp"
 #include "trowaSoftComponents.hpp"
 #include "TSOSCCommon.hpp"
+#include "TSOSCCommunicator.hpp"
 
 #define TSOSC_NUM_TXTFIELDS		3
 #define TSOSC_STATUS_COLOR		nvgRGB(0x00, 0xff, 0xff)
@@ -50,6 +51,118 @@ struct TSOSCClientItem : MenuItem {
 	void onAction(const event::Action &e) override;
 };
 
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Multicast menu items (when the OSC address is a multicast group).
+// TModule is oscCV or TSSequencerModuleBase (currentOSCSettings, oscNewSettings,
+// oscCurrentAction). A change reconnects if we are sending to a group now.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+template<class TModule>
+void TSOSCReconnectMulticast(TModule* oscModule)
+{
+	if (oscModule->oscInitialized && OSCIsMulticastAddress(oscModule->currentOSCSettings.oscTxIpAddress.c_str()))
+	{
+		oscModule->oscNewSettings = oscModule->currentOSCSettings;
+		oscModule->oscCurrentAction = TModule::OSCAction::Enable;
+	}
+	return;
+}
+// Multicast TTL (hops) option.
+template<class TModule>
+struct TSOSCMulticastTtlItem : MenuItem {
+	TModule* oscModule;
+	uint8_t ttl;
+	TSOSCMulticastTtlItem(std::string text, uint8_t ttl, TModule* oscModule)
+	{
+		this->text = text;
+		this->ttl = ttl;
+		this->oscModule = oscModule;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		oscModule->currentOSCSettings.multicastTtl = ttl;
+		TSOSCReconnectMulticast(oscModule);
+	}
+	void step() override {
+		rightText = CHECKMARK(oscModule->currentOSCSettings.multicastTtl == ttl);
+		MenuItem::step();
+	}
+};
+// Multicast loopback toggle (our datagrams also go to listeners on this host).
+template<class TModule>
+struct TSOSCMulticastLoopbackItem : MenuItem {
+	TModule* oscModule;
+	TSOSCMulticastLoopbackItem(TModule* oscModule)
+	{
+		this->text = "Loopback (This Computer Too)";
+		this->oscModule = oscModule;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		oscModule->currentOSCSettings.multicastLoopback = !oscModule->currentOSCSettings.multicastLoopback;
+		TSOSCReconnectMulticast(oscModule);
+	}
+	void step() override {
+		rightText = CHECKMARK(oscModule->currentOSCSettings.multicastLoopback);
+		MenuItem::step();
+	}
+};
+// Add the multicast section to a context menu.
+template<class TModule>
+void TSOSCAppendMulticastMenu(ui::Menu* menu, TModule* oscModule)
+{
+	menu->addChild(new MenuLabel());
+	MenuLabel* label = new MenuLabel();
+	label->text = "OSC Multicast (224.0.0.0 - 239.255.255.255)";
+	menu->addChild(label);
+	menu->addChild(new TSOSCMulticastTtlItem<TModule>("> TTL 1 (Local Subnet)", 1, oscModule));
+	menu->addChild(new TSOSCMulticastTtlItem<TModule>("> TTL 4", 4, oscModule));
+	menu->addChild(new TSOSCMulticastTtlItem<TModule>("> TTL " + std::to_string(OSC_MULTICAST_TTL_MAX), OSC_MULTICAST_TTL_MAX, oscModule));
+	menu->addChild(new TSOSCMulticastLoopbackItem<TModule>(oscModule));
+	return;
+}
+#if TROWA_OSC_LOCAL_TRANSPORT
+// Transport option: UDP (IP/ports) or local (unix domain sockets named by the ports). Reconnects if connected.
+template<class TModule>
+struct TSOSCTransportItem : MenuItem {
+	TModule* oscModule;
+	bool local;
+	TSOSCTransportItem(std::string text, bool local, TModule* oscModule)
+	{
+		this->text = text;
+		this->local = local;
+		this->oscModule = oscModule;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		if (oscModule->currentOSCSettings.localTransport == local)
+			return;
+		oscModule->currentOSCSettings.localTransport = local;
+		if (oscModule->oscInitialized)
+		{
+			oscModule->oscNewSettings = oscModule->currentOSCSettings;
+			oscModule->oscCurrentAction = TModule::OSCAction::Enable;
+		}
+	}
+	void step() override {
+		rightText = CHECKMARK(oscModule->currentOSCSettings.localTransport == local);
+		MenuItem::step();
+	}
+};
+#endif
+// Add the transport section to a context menu (nothing if there is only UDP).
+template<class TModule>
+void TSOSCAppendTransportMenu(ui::Menu* menu, TModule* oscModule)
+{
+#if TROWA_OSC_LOCAL_TRANSPORT
+	menu->addChild(new MenuLabel());
+	MenuLabel* label = new MenuLabel();
+	label->text = "OSC Transport";
+	menu->addChild(label);
+	menu->addChild(new TSOSCTransportItem<TModule>("> UDP (IP Address/Ports)", false, oscModule));
+	menu->addChild(new TSOSCTransportItem<TModule>("> Local (Unix Socket per Port, Same Computer)", true, oscModule));
+#endif
+	return;
+}
 
 struct TSOSCConfigWidget : OpaqueWidget
 {
@@ -89,6 +202,8 @@ struct TSOSCConfigWidget : OpaqueWidget
 	NVGcolor successColor = nvgRGB(0x00, 0xee, 0x00);
 	NVGcolor statusColor = TSOSC_STATUS_COLOR;
 
+	// If the module uses the local transport (the IP address isn't used).
+	bool localTransport = false;
 	bool showClientSelect = true;
 	bool showNamespace = false;
 	int xNamespace = -1;
@@ -111,7 +111,14 @@ void TSOSCSequencerListener::ProcessMessage(const osc::ReceivedMessage& rxMsg, c
 
 		/// TODO: Try to order in order of frequency/commonality of the messages
 		/// TODO: Do better/more efficient parsing (tree)
-		if (std::strcmp(path, OSC_RANDOMIZE_EDIT_STEPVALUE) == 0)
+		if (std::strcmp(path, OSC_SET_EDIT_CHANNEL_STEPS) == 0 || std::strcmp(path, OSC_SET_EDIT_PATTERN_STEPS) == 0)
+		{
+			// Bulk Step Values :::::::::::::::::::::::::::::::::::::::::::::::::::::::
+			// /edit/ch/steps int pattern, int channel, blob values
+			// /edit/pat/steps int pattern, blob values
+			processBulkSteps(rxMsg, std::strcmp(path, OSC_SET_EDIT_PATTERN_STEPS) == 0);
+		}
+		else if (std::strcmp(path, OSC_RANDOMIZE_EDIT_STEPVALUE) == 0)
 		{
 			// Set Randomize ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 			// No params
@@ -592,3 +599,64 @@ void TSOSCSequencerListener::ProcessMessage(const osc::ReceivedMessage& rxMsg, c
 	} // end catch
 	return;
 } // end ProcessMessage()
+
+//--------------------------------------------------------------------------------------------------------------------------------------------
+// processBulkSteps()
+// @rxMsg : (IN) /edit/ch/steps or /edit/pat/steps message.
+// @wholePattern : (IN) Values are for all channels of the pattern (else one channel).
+// Queue one bulk step write for the values (from a blob or from float/int arguments).
+// The values go in one of the queue's preallocated blocks, applied on the audio thread.
+//--------------------------------------------------------------------------------------------------------------------------------------------
+void TSOSCSequencerListener::processBulkSteps(const osc::ReceivedMessage& rxMsg, bool wholePattern)
+{
+	osc::ReceivedMessage::const_iterator arg = rxMsg.ArgumentsBegin();
+	osc::ReceivedMessage::const_iterator end = rxMsg.ArgumentsEnd();
+	int pattern = CURRENT_EDIT_PATTERN_IX;
+	int channel = CURRENT_EDIT_CHANNEL_IX;
+	// 1-based pattern and channel (0 for the current edit pattern/channel)
+	if (arg != end)
+	{
+		int p = static_cast<int>(arg->AsFloat()); // Ok for int32 or float
+		if (p > 0)
+			pattern = (int)clamp(p, 1, TROWA_SEQ_NUM_PATTERNS) - 1;
+		arg++;
+	}
+	if (!wholePattern && arg != end)
+	{
+		int c = static_cast<int>(arg->AsFloat());
+		if (c > 0)
+			channel = (int)clamp(c, 1, TROWA_SEQ_NUM_CHNLS) - 1;
+		arg++;
+	}
+	int maxSteps = sequencerModule->maxSteps;
+	int maxVals = std::min((wholePattern) ? TROWA_SEQ_NUM_CHNLS * maxSteps : maxSteps, TROWA_EXT_CTL_BULK_MAX_VALS);
+	int n = 0;
+	int bulkIx = 0;
+	TSExternalControlQueue::BulkValues* bulk = sequencerModule->ctlMsgQueue.acquireBulk(&bulkIx);
+	if (bulk == NULL)
+		return; // Too many bulk writes waiting (dropped and counted)
+	if (arg != end && arg->IsBlob())
+	{
+		const void* data = NULL;
+		osc::osc_bundle_element_size_t size = 0;
+		arg->AsBlob(data, size);
+		int numVals = static_cast<int>(size) / OSC_BULK_VALUE_SIZE;
+		const char* vals = static_cast<const char*>(data);
+		for (n = 0; n < numVals && n < maxVals; n++)
+			bulk->vals[n] = OSCBulk::readFloat(vals + n * OSC_BULK_VALUE_SIZE);
+	}
+	else
+	{
+		// Plain list of values (i.e. from Pd)
+		for (; arg != end && n < maxVals; arg++, n++)
+			bulk->vals[n] = arg->AsFloat();
+	}
+	bulk->numVals = n;
+	bulk->wholePattern = wholePattern;
+	if (!sequencerModule->ctlMsgQueue.push(CreateOSCRecvMsg(TSExternalControlMessage::MessageType::SetEditStepValues, pattern, channel, /*step*/ 0, /*val*/ 0.0f, /*mode*/ bulkIx)))
+		sequencerModule->ctlMsgQueue.releaseBulk(bulkIx); // Queue full (dropped and counted)
+#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
+	DEBUG("Received %s message - %d values (Pattern %d, Channel %d).", rxMsg.AddressPattern(), n, pattern, channel);
+#endif
+	return;
+} // end processBulkSteps()
@@ -113,6 +113,12 @@ struct TSSequencerModuleBase;
 // Copy Current Pattern [touchOSC]
 // Parameters: -NONE-
 #define OSC_COPYCURRENT_EDIT_PATTERN	"/edit/pat/cpycurr"
+// Set all step values of a channel [Bulk]
+// Parameters: int pattern (0 for current), int channel (0 for current), blob values (float32 big-endian) or float values
+#define OSC_SET_EDIT_CHANNEL_STEPS	"/edit/ch/steps"
+// Set all step values of a pattern (channel by channel) [Bulk]
+// Parameters: int pattern (0 for current), blob values (float32 big-endian) or float values
+#define OSC_SET_EDIT_PATTERN_STEPS	"/edit/pat/steps"
 
 
 
@@ -140,5 +146,12 @@ protected:
 	// Should create a generic TSExternalControlMessage for our trowaSoft sequencers and dump it in the module instance's queue.
 	//--------------------------------------------------------------------------------------------------------------------------------------------
 	virtual void ProcessMessage(const osc::ReceivedMessage& rxMsg, const IpEndpointName& remoteEndpoint) override;
+	//--------------------------------------------------------------------------------------------------------------------------------------------
+	// processBulkSteps()
+	// @rxMsg : (IN) /edit/ch/steps or /edit/pat/steps message.
+	// @wholePattern : (IN) Values are for all channels of the pattern (else one channel).
+	// Queue a bulk step write for each value (from a blob or from float/int arguments).
+	//--------------------------------------------------------------------------------------------------------------------------------------------
+	void processBulkSteps(const osc::ReceivedMessage& rxMsg, bool wholePattern);
 };
 #endif
\ No newline at end of file
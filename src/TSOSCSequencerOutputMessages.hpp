@@ -104,6 +104,10 @@ enum SeqOSCOutputMsg {
 	// /edit/stepgrid/color
 	// Parameters: string color
 	EditStepGridColor,
+	// Send all step values of a channel [Bulk]
+	// /edit/ch/steps
+	// Parameters: int pattern, int channel, blob values (float32 big-endian, one per step)
+	EditChannelSteps,
 	NUM_OSC_OUTPUT_MSGS
 };
 
@@ -189,6 +193,9 @@ enum SeqOSCOutputMsg {
 // Step Grid Color [touchOSC] (format string).
 // Parameters: string color
 #define OSC_SEND_EDIT_STEPGRID_COLOR_FS	"%s/edit/stepgrid/color"
+// Send all step values of a channel [Bulk] (format string).
+// Parameters: int pattern, int channel, blob values (float32 big-endian, one per step)
+#define OSC_SEND_EDIT_CHANNEL_STEPS_FS	"%s/edit/ch/steps"
 
 
 // Format strings for our output OSC messages for our sequencers.
@@ -217,7 +224,8 @@ const char* const TSSeqOSCOutputFormats[] = {
 	OSC_SEND_PLAY_STEP_LED_FS,
 	OSC_SEND_PLAY_STEP_LEDCOLOR_FS,
 	OSC_SEND_EDIT_STEP_COLOR_FS,
-	OSC_SEND_EDIT_STEPGRID_COLOR_FS
+	OSC_SEND_EDIT_STEPGRID_COLOR_FS,
+	OSC_SEND_EDIT_CHANNEL_STEPS_FS
 };
 
 
@@ -0,0 +1,44 @@
+#include "TSRealTimeCheck.hpp"
+
+#if TROWA_RT_CHECK
+#include <stddef.h>
+#include <dlfcn.h>
+
+typedef void (*TSRTEnterFn)(const char*);
+typedef void (*TSRTExitFn)();
+
+// Checker entry points (NULL if the library is not preloaded).
+static TSRTEnterFn tsrtEnter = NULL;
+static TSRTExitFn tsrtExit = NULL;
+static bool tsrtResolved = false;
+
+// Look up the checker once (first process() on any thread; the lookup itself may allocate).
+static void TSRealTimeResolve()
+{
+	tsrtEnter = (TSRTEnterFn)dlsym(RTLD_DEFAULT, "tsrt_enter");
+	tsrtExit = (TSRTExitFn)dlsym(RTLD_DEFAULT, "tsrt_exit");
+	if (tsrtEnter == NULL || tsrtExit == NULL)
+	{
+		tsrtEnter = NULL;
+		tsrtExit = NULL;
+	}
+	tsrtResolved = true;
+	return;
+}
+
+TSRealTimeScope::TSRealTimeScope(const char* module)
+{
+	if (!tsrtResolved)
+		TSRealTimeResolve();
+	if (tsrtEnter)
+		tsrtEnter(module);
+	return;
+}
+
+TSRealTimeScope::~TSRealTimeScope()
+{
+	if (tsrtExit)
+		tsrtExit();
+	return;
+}
+#endif // TROWA_RT_CHECK
@@ -0,0 +1,26 @@
+#ifndef TROWASOFT_TSREALTIMECHECK_HPP
+#define TROWASOFT_TSREALTIMECHECK_HPP
+
+// Real-time safety check (debug). Build with 'make RTCHECK=1' (TROWA_RT_CHECK=1) and run Rack with
+// LD_PRELOAD=tools/rtcheck/libtsrtcheck.so to count/trap allocations and mutex locks in process().
+#ifndef TROWA_RT_CHECK
+#define TROWA_RT_CHECK		0
+#endif
+
+#if TROWA_RT_CHECK
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSRealTimeScope
+// Marks the calling thread as inside a process() for the checker library.
+// Does nothing if the library is not loaded.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSRealTimeScope {
+	TSRealTimeScope(const char* module);
+	~TSRealTimeScope();
+};
+// Put at the top of process(). @module must be a string literal.
+#define TS_RT_CHECK_SCOPE(module)		TSRealTimeScope _tsRealTimeScope(module)
+#else
+#define TS_RT_CHECK_SCOPE(module)
+#endif
+
+#endif // !TROWASOFT_TSREALTIMECHECK_HPP
@@ -16,6 +16,10 @@ const GlobalEffect* SCOPE_GLOBAL_EFFECTS[TROWA_NUM_GLOBAL_EFFECTS] = {
 	new GlobalEffect("COPY",NVG_COPY) //source
 };
 
+// Fraction of the persistence raster faded each frame (Off, Short, Medium, Long).
+const float SCOPE_PERSISTENCE_FADE[TROWA_SCOPE_NUM_PERSISTENCE] = { 1.0f, 0.25f, 0.1f, 0.04f };
+const char* SCOPE_PERSISTENCE_NAMES[TROWA_SCOPE_NUM_PERSISTENCE] = { "Off", "Short", "Medium", "Long" };
+
 // Gets where the point is.
 uint8_t GetPointLocationCode(Vec pt, float minX, float maxX, float minY, float maxY)
 {
@@ -43,4 +47,92 @@ uint8_t GetPointLocationCode(Vec pt, Vec minBounds, Vec maxBounds)
 	else if (pt.y > maxBounds.y)
 		code = code | POINT_POS_TOP;
 	return code;
-}
\ No newline at end of file
+}
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// resetCapture()
+// [Audio] Start capturing from scratch (mode changed).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void TSWaveform::resetCapture()
+{
+	activeTriggerMode = triggerMode;
+	activeLissajous = lissajous;
+	triggerState = TriggerIdle;
+	triggerDetect.reset();
+	triggerArmRequest.store(false);
+	bufferIndex = 0;
+	frameIndex = 0;
+	ringIndex = 0;
+	ringCount = 0;
+	postCount = 0;
+	armedFrames = 0;
+	return;
+} // end resetCapture()
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// processTriggered()
+// [Audio] One frame of triggered capture.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void TSWaveform::processTriggered(float x, float y, bool penOn, float level, int frameCount, float sampleRate)
+{
+	int preCount = (BUFFER_SIZE * clamp(triggerPrePercent, 0, TROWA_SCOPE_TRIG_PRE_MAX)) / 100;
+	// Edge detection runs every frame so a trigger is never missed between samples
+	float v = (triggerOnX) ? x : y;
+	bool triggered = (triggerFalling) ? triggerDetect.process(rescale(v, level + TROWA_SCOPE_TRIG_HYSTERESIS, level - TROWA_SCOPE_TRIG_HYSTERESIS, 0.f, 1.f))
+		: triggerDetect.process(rescale(v, level - TROWA_SCOPE_TRIG_HYSTERESIS, level + TROWA_SCOPE_TRIG_HYSTERESIS, 0.f, 1.f));
+	if (triggerArmRequest.exchange(false) && triggerState == TriggerHolding)
+		triggerState = TriggerIdle;
+	switch (triggerState)
+	{
+	case TriggerIdle:
+		// Arm once the pre-trigger part is there and the display has the last capture
+		if (ringCount >= preCount && captureTaken.load(std::memory_order_acquire) == capturePublished.load(std::memory_order_relaxed))
+		{
+			triggerState = TriggerArmed;
+			armedFrames = 0;
+		}
+		break;
+	case TriggerArmed:
+		armedFrames++;
+		if (!triggered && triggerMode == TriggerAuto)
+		{
+			float autoFrames = fmaxf(TROWA_SCOPE_TRIG_AUTO_TIME * sampleRate, (float)BUFFER_SIZE * (frameCount + 1));
+			triggered = armedFrames >= autoFrames;
+		}
+		if (triggered)
+		{
+			triggerState = TriggerCapturing;
+			postCount = 0;
+			// Take a sample now so the trigger lands on the same spot every capture (no jitter)
+			frameIndex = frameCount;
+		}
+		break;
+	default:
+		break;
+	}
+
+	// Add frame to the ring
+	if (++frameIndex > frameCount)
+	{
+		frameIndex = 0;
+		ringX[ringIndex] = x;
+		ringY[ringIndex] = y;
+		ringPenOn[ringIndex] = penOn;
+		ringIndex = (ringIndex + 1) % BUFFER_SIZE;
+		if (ringCount < BUFFER_SIZE)
+			ringCount++;
+		if (triggerState == TriggerCapturing && ++postCount >= BUFFER_SIZE - preCount)
+		{
+			// Done: oldest sample first
+			int n = BUFFER_SIZE - ringIndex;
+			memcpy(bufferX, ringX + ringIndex, n * sizeof(float));
+			memcpy(bufferX + n, ringX, ringIndex * sizeof(float));
+			memcpy(bufferY, ringY + ringIndex, n * sizeof(float));
+			memcpy(bufferY + n, ringY, ringIndex * sizeof(float));
+			memcpy(bufferPenOn, ringPenOn + ringIndex, n * sizeof(bool));
+			memcpy(bufferPenOn + n, ringPenOn, ringIndex * sizeof(bool));
+			capturePublished.fetch_add(1, std::memory_order_release);
+			triggerState = (triggerMode == TriggerSingle) ? TriggerHolding : TriggerIdle;
+		}
+	}
+	return;
+} // end processTriggered()
@@ -2,6 +2,7 @@
 #define TSSCOPEMODULEBASE_HPP
 #include <string.h>
 #include <stdint.h>
+#include <atomic>
 #include "trowaSoft.hpp"
 #include "trowaSoftComponents.hpp"
 #include "trowaSoftUtilities.hpp"
@@ -27,6 +28,15 @@
 #define TROWA_SCOPE_TIME_KNOB_MAX	-16.0
 #define TROWA_SCOPE_TIME_KNOB_DEF	-14.0	// Default value
 
+// Trigger (time mode):
+#define TROWA_SCOPE_TRIG_LEVEL_MIN		-10.0	// Min trigger level [V]
+#define TROWA_SCOPE_TRIG_LEVEL_MAX		 10.0	// Max trigger level [V]
+#define TROWA_SCOPE_TRIG_LEVEL_DEF		  0.0	// Default trigger level [V]
+#define TROWA_SCOPE_TRIG_HYSTERESIS		  0.05f	// Trigger hysteresis [V] (each side of the level)
+#define TROWA_SCOPE_TRIG_PRE_DEF		 25		// Default pre-trigger depth (% of the buffer)
+#define TROWA_SCOPE_TRIG_PRE_MAX		 90		// Max pre-trigger depth (% of the buffer)
+#define TROWA_SCOPE_TRIG_AUTO_TIME		  0.1f	// Auto mode fires on its own after this long [s] (or the buffer length if longer)
+
 // Effect Knob
 // Number of effects (max index is this - 1) for our scope
 #define TROWA_SCOPE_NUM_EFFECTS			TROWA_NUM_GLOBAL_EFFECTS // 4
@@ -93,6 +103,15 @@ uint8_t GetPointLocationCode(Vec pt, Vec minBounds, Vec maxBounds);
 // Global effects array
 extern const GlobalEffect* SCOPE_GLOBAL_EFFECTS[TROWA_NUM_GLOBAL_EFFECTS];
 
+// Persistence (phosphor) modes (0 is off).
+#define TROWA_SCOPE_NUM_PERSISTENCE		4
+// Amount subtracted from the persistence raster every frame on top of the fade (8-bit fades alone never reach 0).
+#define TROWA_SCOPE_PERSISTENCE_FLOOR	(2.0f/255.0f)
+// Fraction of the persistence raster faded each frame, for each mode.
+extern const float SCOPE_PERSISTENCE_FADE[TROWA_SCOPE_NUM_PERSISTENCE];
+// Labels for each persistence mode.
+extern const char* SCOPE_PERSISTENCE_NAMES[TROWA_SCOPE_NUM_PERSISTENCE];
+
 /// TODO: Waveform: Thickness control & port (1 knob, 1 port)
 /// TODO: Waveform: X&Y Size and position ports (4 ports)
 
@@ -110,6 +129,8 @@ struct TSWaveform
 
 	int bufferIndex;
 	float frameIndex;
+	// Samples written to the buffer (free run / lissajous), so the display knows what is new.
+	uint32_t sampleCount = 0;
 	// Lissajous mode on
 	bool lissajous = true;
 	dsp::SchmittTrigger lissajousTrigger;
@@ -206,6 +227,61 @@ struct TSWaveform
 	// Index into SCOPE_GLOBAL_EFFECTS for what effect to do.
 	int gEffectIx = 0;
 
+	// Triggered capture (time mode only) ::::::::::::::::::::::::::::::::::
+	enum TriggerMode {
+		// Free run: fill the buffer, hold, repeat.
+		TriggerOff,
+		// On a trigger, or on its own if none comes.
+		TriggerAuto,
+		// Only on a trigger.
+		TriggerNormal,
+		// One capture on a trigger, then hold until re-armed.
+		TriggerSingle,
+		NUM_TRIGGER_MODES
+	};
+	enum TriggerState {
+		// Waiting for enough pre-trigger samples or for the display to take the last capture.
+		TriggerIdle,
+		// Looking for the trigger.
+		TriggerArmed,
+		// Triggered, taking the post-trigger samples.
+		TriggerCapturing,
+		// (Single) Captured, holding.
+		TriggerHolding
+	};
+	// [UI] Trigger mode (TriggerMode).
+	int triggerMode = TriggerOff;
+	// [UI] Trigger on the X input (else Y).
+	bool triggerOnX = false;
+	// [UI] Trigger on a falling edge (else rising).
+	bool triggerFalling = false;
+	// [UI] Pre-trigger depth (% of the buffer).
+	int triggerPrePercent = TROWA_SCOPE_TRIG_PRE_DEF;
+	// [UI] Re-arm single mode.
+	std::atomic<bool> triggerArmRequest { false };
+	// Trigger engine state (TriggerState).
+	int triggerState = TriggerIdle;
+	// Mode/lissajous the engine was last reset for.
+	int activeTriggerMode = TriggerOff;
+	bool activeLissajous = true;
+	dsp::SchmittTrigger triggerDetect;
+	// Capture ring (written continuously while triggering; bufferX/Y/PenOn get each finished capture).
+	float ringX[BUFFER_SIZE] = {};
+	float ringY[BUFFER_SIZE] = {};
+	bool ringPenOn[BUFFER_SIZE] = {};
+	// Next ring index to write.
+	int ringIndex = 0;
+	// Valid samples in the ring.
+	int ringCount = 0;
+	// Samples taken since the trigger.
+	int postCount = 0;
+	// Frames spent armed (for auto).
+	float armedFrames = 0;
+	// Captures put in bufferX/Y/PenOn (module) and taken by the display (widget). The module only
+	// writes a new capture once the display has taken the last one.
+	std::atomic<uint32_t> capturePublished { 0 };
+	std::atomic<uint32_t> captureTaken { 0 };
+
 	TSWaveform()
 	{
 		bufferIndex = 0;
@@ -227,6 +303,24 @@ struct TSWaveform
 		return;
 	}
 
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// resetCapture()
+	// [Audio] Start capturing from scratch (mode changed).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void resetCapture();
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// processTriggered()
+	// [Audio] One frame of triggered capture: look for the trigger every frame and
+	// write the ring every @frameCount + 1 frames.
+	// @x : (IN) X input voltage.
+	// @y : (IN) Y input voltage.
+	// @penOn : (IN) If the pen is on.
+	// @level : (IN) Trigger level [V].
+	// @frameCount : (IN) Frames between samples - 1.
+	// @sampleRate : (IN) Engine sample rate.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void processTriggered(float x, float y, bool penOn, float level, int frameCount, float sampleRate);
+
 	void setHue(float hue)
 	{
 		waveHue = hue;
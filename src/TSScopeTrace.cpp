@@ -0,0 +1,126 @@
+#include "TSScopeTrace.hpp"
+
+// How far (in line thicknesses) a simplified trace may stray from the points.
+const float TSScopeTraceQualityTolerance[TRACE_NUM_QUALITIES] = { 0.0f, 0.15f, 0.35f, 0.75f };
+const char* TSScopeTraceQualityNames[TRACE_NUM_QUALITIES] = { "Full (Every Point)", "High", "Normal", "Draft" };
+
+// Distance squared from (px, py) to the segment a-b.
+static float segmentDistance2(float px, float py, float ax, float ay, float bx, float by)
+{
+	float dx = bx - ax;
+	float dy = by - ay;
+	float len2 = dx * dx + dy * dy;
+	float t = 0.0f;
+	if (len2 > 0.0f)
+	{
+		t = ((px - ax) * dx + (py - ay) * dy) / len2;
+		if (t < 0.0f)
+			t = 0.0f;
+		else if (t > 1.0f)
+			t = 1.0f;
+	}
+	float ex = ax + t * dx - px;
+	float ey = ay + t * dy - py;
+	return ex * ex + ey * ey;
+}
+
+// Simplify each sub path in place.
+int TSScopeTracePath::simplify(float tolerance)
+{
+	numRawPoints = numPoints;
+	if (tolerance <= 0.0f || numPoints < 3)
+		return numPoints;
+	float tol2 = tolerance * tolerance;
+	int outIx = 0;
+	int first = 0;
+	while (first < numPoints)
+	{
+		int last = first + 1;
+		while (last < numPoints && !start[last])
+			last++;
+		outIx += simplifyRun(first, last - first, outIx, tol2);
+		first = last;
+	}
+	numPoints = outIx;
+	return numPoints;
+}
+
+// Simplify one sub path, moving it down to outIx.
+int TSScopeTracePath::simplifyRun(int first, int count, int outIx, float tol2)
+{
+	// 1. Radial distance: drop points that are within the tolerance of the last one kept.
+	int n = 0;
+	int lastIx = first + count - 1;
+	for (int i = first; i <= lastIx; i++)
+	{
+		if (n > 0 && i < lastIx)
+		{
+			float dx = x[i] - x[outIx + n - 1];
+			float dy = y[i] - y[outIx + n - 1];
+			if (dx * dx + dy * dy < tol2)
+				continue;
+		}
+		x[outIx + n] = x[i];
+		y[outIx + n] = y[i];
+		start[outIx + n] = start[i];
+		n++;
+	}
+	if (n < 3)
+		return n;
+
+	// 2. Ramer-Douglas-Peucker (iterative) on what is left.
+	for (int i = 0; i < n; i++)
+		keep[outIx + i] = false;
+	keep[outIx] = true;
+	keep[outIx + n - 1] = true;
+	int numSpans = 0;
+	spanFirst[numSpans] = outIx;
+	spanLast[numSpans] = outIx + n - 1;
+	numSpans++;
+	while (numSpans > 0)
+	{
+		numSpans--;
+		int a = spanFirst[numSpans];
+		int b = spanLast[numSpans];
+		float maxD2 = 0.0f;
+		int maxIx = -1;
+		for (int i = a + 1; i < b; i++)
+		{
+			float d2 = segmentDistance2(x[i], y[i], x[a], y[a], x[b], y[b]);
+			if (d2 > maxD2)
+			{
+				maxD2 = d2;
+				maxIx = i;
+			}
+		}
+		if (maxIx > -1 && maxD2 > tol2)
+		{
+			// Farthest point stays, check both sides of it
+			keep[maxIx] = true;
+			if (maxIx - a > 1)
+			{
+				spanFirst[numSpans] = a;
+				spanLast[numSpans] = maxIx;
+				numSpans++;
+			}
+			if (b - maxIx > 1)
+			{
+				spanFirst[numSpans] = maxIx;
+				spanLast[numSpans] = b;
+				numSpans++;
+			}
+		}
+	}
+	int w = outIx;
+	for (int i = outIx; i < outIx + n; i++)
+	{
+		if (keep[i])
+		{
+			x[w] = x[i];
+			y[w] = y[i];
+			start[w] = start[i];
+			w++;
+		}
+	}
+	return w - outIx;
+} // end simplifyRun()
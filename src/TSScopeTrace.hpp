@@ -0,0 +1,104 @@
+#ifndef TSSCOPETRACE_HPP
+#define TSSCOPETRACE_HPP
+
+#include <stdint.h>
+
+// Max points in a trace (every buffer point plus the clipped end points that may be injected).
+#define TROWA_SCOPE_TRACE_MAX_POINTS		2048
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSScopeTraceQuality
+// How closely an XY (lissajous) trace follows the buffered points.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+enum TSScopeTraceQuality {
+	// Every point (no simplification).
+	TraceQualityFull,
+	TraceQualityHigh,
+	TraceQualityNormal,
+	TraceQualityDraft,
+	TRACE_NUM_QUALITIES
+};
+// How far (in line thicknesses) a simplified trace may stray from the points, for each quality.
+extern const float TSScopeTraceQualityTolerance[TRACE_NUM_QUALITIES];
+// Labels for each quality.
+extern const char* TSScopeTraceQualityNames[TRACE_NUM_QUALITIES];
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSScopeTracePath
+// Screen space points of a trace (one or more sub paths), collected before they
+// are handed to nanovg so they can be simplified first.
+// Simplification drops points closer than the tolerance to the last one kept
+// (slow figures pile hundreds of points into one pixel) and then runs
+// Ramer-Douglas-Peucker, so corners and peaks stay where they are.
+// Fixed size, no allocation.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSScopeTracePath
+{
+	float x[TROWA_SCOPE_TRACE_MAX_POINTS];
+	float y[TROWA_SCOPE_TRACE_MAX_POINTS];
+	// If the point starts a sub path (moveTo).
+	bool start[TROWA_SCOPE_TRACE_MAX_POINTS];
+	// Number of points.
+	int numPoints = 0;
+	// Number of points before the last simplify().
+	int numRawPoints = 0;
+
+	// Remove all points.
+	void clear()
+	{
+		numPoints = 0;
+		numRawPoints = 0;
+		return;
+	}
+	// Start a sub path at (px, py).
+	void moveTo(float px, float py)
+	{
+		addPoint(px, py, true);
+		return;
+	}
+	// Line to (px, py).
+	void lineTo(float px, float py)
+	{
+		addPoint(px, py, false);
+		return;
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// simplify()
+	// Simplify each sub path in place. The first and last point of each sub path
+	// are always kept.
+	// @tolerance : (IN) How far [px] each pass may move the path from the points
+	// (so at most twice this in all).
+	// @returns : The number of points left.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	int simplify(float tolerance);
+private:
+	// Points to keep (RDP).
+	bool keep[TROWA_SCOPE_TRACE_MAX_POINTS];
+	// RDP work stack (first and last index of each span).
+	int spanFirst[TROWA_SCOPE_TRACE_MAX_POINTS];
+	int spanLast[TROWA_SCOPE_TRACE_MAX_POINTS];
+
+	void addPoint(float px, float py, bool isStart)
+	{
+		if (numPoints < TROWA_SCOPE_TRACE_MAX_POINTS)
+		{
+			x[numPoints] = px;
+			y[numPoints] = py;
+			start[numPoints] = isStart;
+			numPoints++;
+		}
+		return;
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// simplifyRun()
+	// Simplify one sub path, moving it down to @outIx.
+	// @first : (IN) Index of the first point.
+	// @count : (IN) Number of points.
+	// @outIx : (IN) Where the simplified points go (<= first).
+	// @tol2 : (IN) Tolerance squared.
+	// @returns : The number of points written.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	int simplifyRun(int first, int count, int outIx, float tol2);
+};
+
+#endif // !TSSCOPETRACE_HPP
@@ -0,0 +1,32 @@
+#include "TSSeqTransport.hpp"
+
+TSSeqTransport::TSSeqTransport()
+{
+	return;
+}
+
+// The process-wide transport (thread safe, created on first use).
+TSSeqTransport* TSSeqTransport::Transport()
+{
+	static TSSeqTransport* instance = new TSSeqTransport();
+	return instance;
+}
+
+// Take the lead if no one has it.
+bool TSSeqTransport::claimLead(int id)
+{
+	int curr = _leaderId.load(std::memory_order_relaxed);
+	if (curr == id)
+		return true;
+	if (curr != 0)
+		return false;
+	return _leaderId.compare_exchange_strong(curr, id);
+}
+
+// Give up the lead (if we have it).
+void TSSeqTransport::releaseLead(int id)
+{
+	int curr = id;
+	_leaderId.compare_exchange_strong(curr, 0);
+	return;
+}
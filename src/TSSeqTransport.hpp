@@ -0,0 +1,126 @@
+#ifndef TROWASOFT_TSSEQTRANSPORT_HPP
+#define TROWASOFT_TSSEQTRANSPORT_HPP
+
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+// Beats per bar for the shared transport position.
+#define TROWA_SEQ_TRANSPORT_BEATS_PER_BAR		4
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TSSeqTransport
+// Process-wide transport (tempo, bar/beat position, run/reset) for the sequencers.
+// One sequencer leads: it runs its clock (internal or external) and publishes every
+// step. Followers step when the leader steps instead of running their own phase
+// accumulators, so any number of sequencers stay locked without clock cables.
+// Everything is atomic; the audio thread never locks.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+class TSSeqTransport
+{
+public:
+	// What a sequencer does with the transport.
+	enum TransportMode : uint8_t {
+		// Not on the transport (own clock).
+		TransportOff,
+		// Drive the transport.
+		TransportLead,
+		// Follow the transport (own clock if there is no leader).
+		TransportFollow,
+		NUM_TRANSPORT_MODES
+	};
+
+	static TSSeqTransport* Transport();
+
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// claimLead()
+	// Take the lead if no one has it.
+	// @id : (IN) Module id.
+	// @returns : True if @id is the leader.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	bool claimLead(int id);
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// releaseLead()
+	// Give up the lead (if @id has it).
+	// @id : (IN) Module id.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void releaseLead(int id);
+	// If this id is the leader.
+	bool isLeader(int id) const { return _leaderId.load(std::memory_order_relaxed) == id; }
+	// If anyone is leading.
+	bool hasLeader() const { return _leaderId.load(std::memory_order_relaxed) != 0; }
+
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// publish()
+	// (Leader) Publish the state for this sample.
+	// @running : (IN) Leader is running.
+	// @bpm : (IN) Leader BPM (relative to its note).
+	// @phase : (IN) Phase into the current step [0-1).
+	// @stepsPerBeat : (IN) Steps per quarter note.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void publish(bool running, float bpm, float phase, int stepsPerBeat)
+	{
+		_running.store(running, std::memory_order_relaxed);
+		_bpm.store(bpm, std::memory_order_relaxed);
+		_phase.store(phase, std::memory_order_relaxed);
+		_stepsPerBeat.store((stepsPerBeat > 0) ? stepsPerBeat : 1, std::memory_order_relaxed);
+		return;
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// step()
+	// (Leader) A step fired.
+	// @reset : (IN) This step is the first after a reset.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void step(bool reset)
+	{
+		if (reset)
+		{
+			_position.store(0, std::memory_order_relaxed);
+			_resetCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			_position.fetch_add(1, std::memory_order_relaxed);
+		}
+		// Release so followers that see the new count also see the position.
+		_stepCount.fetch_add(1, std::memory_order_release);
+		return;
+	}
+
+	// Number of steps the leader has fired (changes == step).
+	uint32_t getStepCount() const { return _stepCount.load(std::memory_order_acquire); }
+	// Number of resets the leader has done (changes == reset).
+	uint32_t getResetCount() const { return _resetCount.load(std::memory_order_relaxed); }
+	// Steps since the last reset (0 is the first step).
+	uint32_t getPosition() const { return _position.load(std::memory_order_relaxed); }
+	// If the leader is running.
+	bool isRunning() const { return _running.load(std::memory_order_relaxed); }
+	// Leader BPM.
+	float getBPM() const { return _bpm.load(std::memory_order_relaxed); }
+	// Phase into the current step [0-1).
+	float getPhase() const { return _phase.load(std::memory_order_relaxed); }
+	// Steps per beat (quarter note).
+	int getStepsPerBeat() const { return _stepsPerBeat.load(std::memory_order_relaxed); }
+	// Steps per bar.
+	int getStepsPerBar() const { return getStepsPerBeat() * TROWA_SEQ_TRANSPORT_BEATS_PER_BAR; }
+	// Current bar (0-based) since the last reset.
+	uint32_t getBar() const { return getPosition() / getStepsPerBar(); }
+	// Current beat in the bar (0-based).
+	int getBeat() const { return (getPosition() / getStepsPerBeat()) % TROWA_SEQ_TRANSPORT_BEATS_PER_BAR; }
+	// If the current step is the first step of a bar.
+	bool isBarStart() const { return getPosition() % getStepsPerBar() == 0; }
+private:
+	TSSeqTransport();
+
+	// Id of the leader (0 for none).
+	std::atomic<int> _leaderId { 0 };
+	std::atomic<uint32_t> _stepCount { 0 };
+	std::atomic<uint32_t> _resetCount { 0 };
+	std::atomic<uint32_t> _position { 0 };
+	std::atomic<bool> _running { false };
+	std::atomic<float> _bpm { 0.0f };
+	std::atomic<float> _phase { 0.0f };
+	std::atomic<int> _stepsPerBeat { 2 };
+};
+
+#endif // !TROWASOFT_TSSEQTRANSPORT_HPP
@@ -11,6 +11,7 @@
 #include "TSOSCCommunicator.hpp"
 #include "TSSequencerWidgetBase.hpp"
 #include "TSParamQuantity.hpp"
+#include "TSSeqTransport.hpp"
 
 // Static Variables:
 RandStructure TSSequencerModuleBase::RandomPatterns[TROWA_SEQ_NUM_RANDOM_PATTERNS] = {
@@ -119,6 +120,7 @@ TSSequencerModuleBase::TSSequencerModuleBase(/*in*/ int numSteps, /*in*/ int num
 	oscRxSocket = NULL;
 	oscNamespace = OSC_DEFAULT_NS;
 	oscId = TSOSCConnector::GetId();
+	transport = TSSeqTransport::Transport();
 
 	for (int i = 0; i < SeqOSCOutputMsg::NUM_OSC_OUTPUT_MSGS; i++)
 	{
@@ -142,18 +144,16 @@ TSSequencerModuleBase::TSSequencerModuleBase(/*in*/ int numSteps, /*in*/ int num
 	this->numRows = numRows;
 	this->numCols = numCols;
 
-	stepLights = new float*[numRows];
+	stepLights = new TSLightEnvelope[maxSteps];
 	gateLights = new float*[numRows];
 	padLightPtrs = new ColorValueLight**[numRows];
 
 	for (int r = 0; r < numRows; r++)
 	{
-		stepLights[r] = new float[numCols];
 		gateLights[r] = new float[numCols];
 		padLightPtrs[r] = new ColorValueLight*[numCols];
 		for (int c = 0; c < numCols; c++)
 		{
-			stepLights[r][c] = 0;
 			gateLights[r][c] = 0;
 		}
 	}
@@ -190,11 +190,10 @@ TSSequencerModuleBase::TSSequencerModuleBase(/*in*/ int numSteps, /*in*/ int num
 TSSequencerModuleBase::~TSSequencerModuleBase()
 {
 	initialized = false; // Stop doing stuff
+	transport->releaseLead(oscId); // Give up the lead if we have it (not processing anymore)
 	cleanupOSC();
 	for (int r = 0; r < numRows; r++)
 	{
-		if (stepLights[r])
-			delete[] stepLights[r];
 		if (gateLights[r])
 			delete[] gateLights[r];
 		if (padLightPtrs[r])
@@ -240,6 +239,39 @@ TSSequencerModuleBase::~TSSequencerModuleBase()
 } // end ~TSSequencerModuleBase()
 
 
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// setTransportMode()
+// Join/leave the shared transport (the audio thread switches on its next
+// sample, see applyTransportMode()).
+// @mode : (IN) Off, Lead or Follow.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void TSSequencerModuleBase::setTransportMode(TSSeqTransport::TransportMode mode)
+{
+	pendingTransportMode.store(static_cast<int>(mode));
+	return;
+} // end setTransportMode()
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// applyTransportMode()
+// [Audio thread] Switch to the mode requested by setTransportMode() (if any).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void TSSequencerModuleBase::applyTransportMode()
+{
+	if (pendingTransportMode.load(std::memory_order_relaxed) < 0)
+		return;
+	int mode = pendingTransportMode.exchange(-1);
+	if (mode < 0)
+		return;
+	if (mode != TSSeqTransport::TransportMode::TransportLead)
+		transport->releaseLead(oscId);
+	// Don't step/reset/stop on anything that happened before we joined
+	transportStepCount = transport->getStepCount();
+	transportResetCount = transport->getResetCount();
+	transportRunning = transport->isRunning();
+	transportMode = static_cast<TSSeqTransport::TransportMode>(mode);
+	return;
+} // end applyTransportMode()
+
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // reset(void)
 // Reset ALL step values to default.
@@ -305,7 +337,7 @@ void TSSequencerModuleBase::randomize(int patternIx, int channelIx, bool useStru
 			// A, AB, ABBA, ABAC
 			int rIx = rand() % numStructuredRandomPatterns;// TROWA_SEQ_NUM_RANDOM_PATTERNS;
 			int n = RandomPatterns[rIx].numDiffVals;
-			float* randVals = new float[n];
+			float randVals[UINT8_MAX + 1]; // numDiffVals is a uint8_t (no heap, this may run on the audio thread)
 			int patternLen = RandomPatterns[rIx].pattern.size();
 			// Every Channel should get its own random pattern
 			for (int i = 0; i < n; i++)
@@ -318,7 +350,6 @@ void TSSequencerModuleBase::randomize(int patternIx, int channelIx, bool useStru
 				if (patternIx == currentPatternEditingIx && channelIx == currentChannelEditingIx)
 					onShownStepChange(s, val);
 			}
-			delete[] randVals;
 		} // end if random pattern/structure
 		else
 		{
@@ -359,6 +390,26 @@ void TSSequencerModuleBase::setOSCNamespace(const char* oscNs)
 
 	return;
 } // end setOSCNameSpace()
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// addOSCBulkChannelSteps()
+// Add all step values of a channel as one message (/edit/ch/steps) for bulk clients.
+// @oscStream : (IN/OUT) The stream (bundle) to add to.
+// @pattern : (IN) The pattern index.
+// @channel : (IN) The channel index.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void TSSequencerModuleBase::addOSCBulkChannelSteps(osc::OutboundPacketStream& oscStream, int pattern, int channel)
+{
+	for (int s = 0; s < maxSteps; s++)
+	{
+		OSCBulk::writeFloat(oscBulkBlob + s * OSC_BULK_VALUE_SIZE, triggerState[pattern][channel][s]);
+	}
+	oscStream << osc::BeginMessage(oscAddrBuffer[SeqOSCOutputMsg::EditChannelSteps])
+		<< (pattern + 1) << (channel + 1)
+		<< osc::Blob(oscBulkBlob, maxSteps * OSC_BULK_VALUE_SIZE)
+		<< osc::EndMessage;
+	return;
+} // end addOSCBulkChannelSteps()
+
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // Initialize OSC on the given ip and ports.
 // @ipAddress: (IN) The ip address.
@@ -383,28 +434,57 @@ void TSSequencerModuleBase::initOSC(const char* ipAddress, int outputPort, int i
 			{
 				oscBuffer = (char*)malloc(OSC_OUTPUT_BUFFER_SIZE * sizeof(char));
 			}
-			if (oscTxSocket == NULL)
+#if TROWA_OSC_LOCAL_TRANSPORT
+			if (currentOSCSettings.localTransport)
 			{
-#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
-				DEBUG("TSSequencerModuleBase::initOSC() - Create TRANS socket at %s, port %d.", ipAddress, outputPort);
-#endif
-				oscTxSocket = new UdpTransmitSocket(IpEndpointName(ipAddress, outputPort));
-				this->currentOSCSettings.oscTxPort = outputPort;
+				// Local transport: unix domain sockets named by the ports (same OSC framing)
+				if (oscTxQueue == NULL)
+				{
+					oscTxQueue = TSOSCTxService::RegisterLocalSender(outputPort);
+					this->currentOSCSettings.oscTxPort = outputPort;
+				}
+				if (oscLocalRxSocket == NULL)
+				{
+					oscListener = new TSOSCSequencerListener();
+					oscListener->sequencerModule = this;
+					oscListener->oscNamespace = this->oscNamespace;
+					oscLocalRxSocket = new TSOSCLocalListeningSocket(inputPort, oscListener);
+					this->currentOSCSettings.oscRxPort = inputPort;
+					oscListenerThread = std::thread(&TSOSCLocalListeningSocket::Run, oscLocalRxSocket);
+				}
 			}
-			if (oscRxSocket == NULL)
+			else
+#endif
 			{
+				if (oscTxSocket == NULL)
+				{
+#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
+					DEBUG("TSSequencerModuleBase::initOSC() - Create TRANS socket at %s, port %d.", ipAddress, outputPort);
+#endif
+					oscTxSocket = new UdpTransmitSocket(IpEndpointName(ipAddress, outputPort));
+					if (OSCIsMulticastAddress(ipAddress))
+					{
+						oscTxSocket->SetMulticastTtl(currentOSCSettings.multicastTtl);
+						oscTxSocket->SetMulticastLoopback(currentOSCSettings.multicastLoopback);
+					}
+					this->currentOSCSettings.oscTxPort = outputPort;
+				}
+				if (oscRxSocket == NULL)
+				{
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
-				DEBUG("TSSequencerModuleBase::initOSC() - Create RECV socket at any address, port %d.", inputPort);
+					DEBUG("TSSequencerModuleBase::initOSC() - Create RECV socket at any address, port %d.", inputPort);
 #endif
-				oscListener = new TSOSCSequencerListener();
-				oscListener->sequencerModule = this;
-				oscListener->oscNamespace = this->oscNamespace;
-				oscRxSocket = new UdpListeningReceiveSocket(IpEndpointName(IpEndpointName::ANY_ADDRESS, inputPort), oscListener);
-				this->currentOSCSettings.oscRxPort = inputPort;
+					oscListener = new TSOSCSequencerListener();
+					oscListener->sequencerModule = this;
+					oscListener->oscNamespace = this->oscNamespace;
+					// If the address is a multicast group, we join it on the Rx port too
+					oscRxSocket = new TSOSCListeningSocket(inputPort, oscListener, ipAddress);
+					this->currentOSCSettings.oscRxPort = inputPort;
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
-				DEBUG("TSSequencerModuleBase::initOSC() - Starting listener thread...");
+					DEBUG("TSSequencerModuleBase::initOSC() - Starting listener thread...");
 #endif
-				oscListenerThread = std::thread(&UdpListeningReceiveSocket::Run, oscRxSocket);
+					oscListenerThread = std::thread(&TSOSCListeningSocket::Run, oscRxSocket);
+				}
 			}
 //#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_LOW
 //			DEBUG("TSSequencerModuleBase::initOSC() - OSC Initialized");
@@ -425,6 +505,39 @@ void TSSequencerModuleBase::initOSC(const char* ipAddress, int outputPort, int i
 	{
 		oscError = true;
 		WARN("TSSequencerModuleBase::initOSC() - Error initializing: %s.", ex.what());
+		// Undo what we got so a retry starts clean (cleanupOSC() only knows the ports we finished with)
+		bool rxStarted = oscListenerThread.joinable();
+		if (!rxStarted)
+		{
+			if (oscRxSocket != NULL)
+			{
+				delete oscRxSocket;
+				oscRxSocket = NULL;
+			}
+#if TROWA_OSC_LOCAL_TRANSPORT
+			if (oscLocalRxSocket != NULL)
+			{
+				delete oscLocalRxSocket;
+				oscLocalRxSocket = NULL;
+			}
+#endif
+			if (oscListener != NULL)
+			{
+				delete oscListener;
+				oscListener = NULL;
+			}
+		}
+		if (oscTxSocket != NULL)
+		{
+			delete oscTxSocket;
+			oscTxSocket = NULL;
+		}
+		if (oscTxQueue != NULL)
+		{
+			TSOSCTxService::UnregisterSender(oscTxQueue);
+			oscTxQueue = NULL;
+		}
+		TSOSCConnector::ClearPorts(oscId, outputPort, inputPort);
 	}
 	oscMutex.unlock();
 	return;
@@ -461,6 +574,26 @@ void TSSequencerModuleBase::cleanupOSC()
 			delete oscTxSocket;
 			oscTxSocket = NULL;
 		}
+#if TROWA_OSC_LOCAL_TRANSPORT
+		if (oscLocalRxSocket != NULL)
+		{
+			oscLocalRxSocket->AsynchronousBreak();
+			oscListenerThread.join(); // Wait for him to finish
+			delete oscLocalRxSocket;
+			oscLocalRxSocket = NULL;
+		}
+#endif
+		if (oscListener != NULL)
+		{
+			// No socket is using it anymore
+			delete oscListener;
+			oscListener = NULL;
+		}
+		if (oscTxQueue != NULL)
+		{
+			TSOSCTxService::UnregisterSender(oscTxQueue);
+			oscTxQueue = NULL;
+		}
 		//if (oscBuffer != NULL)
 		//{
 		//	free(oscBuffer);
@@ -479,6 +612,54 @@ void TSSequencerModuleBase::cleanupOSC()
 	oscMutex.unlock();
 	return;
 } // end cleanupOSC()
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// processOSCAction()
+// [UI thread] Enable/disable OSC if requested (oscCurrentAction).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void TSSequencerModuleBase::processOSCAction()
+{
+	OSCAction action = this->oscCurrentAction;
+	this->oscCurrentAction = OSCAction::None;
+	switch (action)
+	{
+	case OSCAction::Disable:
+#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
+		DEBUG("Osc Current Action = Disable.");
+#endif
+		this->cleanupOSC(); // Try to clean up OSC
+		break;
+	case OSCAction::Enable:
+#if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
+		DEBUG("Osc Current Action = Enable.");
+#endif
+		this->cleanupOSC(); // Try to clean up OSC if we already have something
+		this->initOSC(this->oscNewSettings.oscTxIpAddress.c_str(), this->oscNewSettings.oscTxPort, this->oscNewSettings.oscRxPort);
+		this->useOSC = true;
+		if (this->oscInitialized)
+			oscStartedPending = true; // Send everything on the next step
+		break;
+	case OSCAction::None:
+	default:
+		break;
+	}
+	return;
+} // end processOSCAction()
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// updateBPMParamLabel()
+// [UI thread] Set the BPM knob's unit/multiplier for the selected BPM note.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void TSSequencerModuleBase::updateBPMParamLabel()
+{
+	int noteIx = clamp(selectedBPMNoteIx, 0, TROWA_TEMP_BPM_NUM_OPTIONS - 1);
+	if (noteIx != bpmParamLabelNoteIx)
+	{
+		bpmParamLabelNoteIx = noteIx;
+		// Adjust the BPM Knob multiplier for the built-in display/text input:
+		this->paramQuantities[BPM_PARAM]->unit = " BPM (1/" + std::string(BPMOptions[noteIx]->label) + ")";
+		this->paramQuantities[BPM_PARAM]->displayMultiplier = BPMOptions[noteIx]->multiplier;
+	}
+	return;
+} // end updateBPMParamLabel()
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // copy()
@@ -569,7 +750,7 @@ void TSSequencerModuleBase::setStepValue(int step, float val, int channel, int p
 	{
 		if (triggerState[pattern][channel][step])
 		{
-			gateLights[r][c] = 1.0f - stepLights[r][c];
+			gateLights[r][c] = 1.0f - getStepLight(step);
 			if (gateTriggers != NULL)
 				gateTriggers[step].state = TriggerSignal::HIGH;
 		}
@@ -581,8 +762,8 @@ void TSSequencerModuleBase::setStepValue(int step, float val, int channel, int p
 		}
 		paramQuantities[ParamIds::CHANNEL_PARAM + step]->setValue(val);
 	}
-	oscMutex.lock();
-	if (useOSC && oscInitialized)
+	bool oscLocked = oscMutex.try_lock(); // Never block the audio thread
+	if (useOSC && oscInitialized && oscLocked)
 	{
 		try
 		{
@@ -609,7 +790,7 @@ void TSSequencerModuleBase::setStepValue(int step, float val, int channel, int p
 				<< triggerState[pattern][channel][step]
 				<< osc::EndMessage
 				<< osc::EndBundle;
-			oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+			oscSend(oscStream.Data(), oscStream.Size());
 
 		}
 		catch (const std::exception &e)
@@ -619,7 +800,8 @@ void TSSequencerModuleBase::setStepValue(int step, float val, int channel, int p
 #endif
 		}
 	}
-	oscMutex.unlock();
+	if (oscLocked)
+		oscMutex.unlock();
 	return;
 } // end setStepValue()
 
@@ -642,6 +824,24 @@ void TSSequencerModuleBase::getStepInputs(const ProcessArgs &args, /*out*/ bool*
 	bool lastRunning = running;
 	int lastBPMNoteIx = this->selectedBPMNoteIx;
 	int lastStepIndex = index;
+	// Lights are only written every few samples
+	updateLights = lightClock.process();
+	lightTauFrames = lightLambda * args.sampleRate;
+
+	// Shared transport
+	applyTransportMode();
+	bool followTransport = isFollowingTransport();
+	bool leadTransport = transportMode == TSSeqTransport::TransportMode::TransportLead && transport->claimLead(oscId);
+	uint32_t lastTransportStepCount = transportStepCount;
+	transportStepCount = transport->getStepCount();
+	if (followTransport)
+	{
+		// Follow the leader's run/stop (our button still works in between).
+		bool tRunning = transport->isRunning();
+		if (tRunning != transportRunning)
+			running = tRunning;
+		transportRunning = tRunning;
+	}
 
 	// Run
 	if (runningTrigger.process(params[RUN_PARAM].getValue())) {
@@ -649,25 +849,8 @@ void TSSequencerModuleBase::getStepInputs(const ProcessArgs &args, /*out*/ bool*
 	}
 	lights[RUNNING_LIGHT].value = running ? 1.0 : 0.0;
 
-	bool oscStarted = false; // If OSC just started to a new address this step.
-	switch (this->oscCurrentAction)
-	{
-	case OSCAction::Disable:
-DEBUG("Osc Current Action = Disable.");	
-		this->cleanupOSC(); // Try to clean up OSC
-		break;
-	case OSCAction::Enable:
-DEBUG("Osc Current Action = Enable.");		
-		this->cleanupOSC(); // Try to clean up OSC if we already have something
-		this->initOSC(this->oscNewSettings.oscTxIpAddress.c_str(), this->oscNewSettings.oscTxPort, this->oscNewSettings.oscRxPort);
-		this->useOSC = true;
-		oscStarted = this->useOSC && this->oscInitialized;
-		break;
-	case OSCAction::None:
-	default:
-		break;
-	}
-	this->oscCurrentAction = OSCAction::None;
+	// If OSC just started to a new address this step (the UI thread does the connecting, see processOSCAction()).
+	bool oscStarted = oscStartedPending.load(std::memory_order_relaxed) && oscStartedPending.exchange(false);
 
 	// OSC is Enabled and Active light
 	lights[LightIds::OSC_ENABLED_LIGHT].value = (useOSC && oscInitialized) ? 1.0 : 0.0;
@@ -684,10 +867,8 @@ DEBUG("Osc Current Action = Enable.");
 			selectedBPMNoteIx++;
 		else
 			selectedBPMNoteIx = 0; // Wrap around
-		lights[SELECTED_BPM_MULT_IX_LIGHT].value = 1.0;
-		// Adjust the BPM Knob multiplier for the built-in display/text input:
-		this->paramQuantities[BPM_PARAM]->unit = " BPM (1/" + std::string(BPMOptions[selectedBPMNoteIx]->label) + ")";
-		this->paramQuantities[BPM_PARAM]->displayMultiplier = BPMOptions[selectedBPMNoteIx]->multiplier;
+		bpmNoteLight.trigger(lightClock.frame);
+		// The BPM Knob multiplier for the built-in display/text input is adjusted by updateBPMParamLabel() (UI thread).
 	}
 	float clockTime = 1.0;
 	float input = 1.0;
@@ -705,11 +886,31 @@ DEBUG("Osc Current Action = Enable.");
 	clockTime = powf(2.0, input); // -2 to 6
 	// Calculate his all the time now instead of just on next step:
 	currentBPM = roundf(clockTime * BPMOptions[selectedBPMNoteIx]->multiplier);
+	if (followTransport)
+		currentBPM = transport->getBPM(); // Show the leader's tempo
 	playBPMChanged = lastBPM != currentBPM;
 	
+	// Reset done at the start of this step (leader tells the transport)
+	bool stepWasReset = false;
 	if (running)
 	{
-		if (inputs[EXT_CLOCK_INPUT].isConnected())
+		if (followTransport)
+		{
+			// Shared transport: step when the leader steps (no phase accumulator of our own)
+			lastStepWasExternalClock = false;
+			realPhase = transport->getPhase();
+			if (transportStepCount != lastTransportStepCount)
+			{
+				nextStep = true;
+				if (resetPaused)
+				{
+					resetPaused = false;
+					index = -1;
+					nextIndex = TROWA_INDEX_UNDEFINED; // Reset our jump to index
+				}
+			}
+		}
+		else if (inputs[EXT_CLOCK_INPUT].isConnected())
 		{
 			// External clock input
 			if (clockTrigger.process(inputs[EXT_CLOCK_INPUT].getVoltage()))
@@ -730,6 +931,7 @@ DEBUG("Osc Current Action = Enable.");
 				resetPaused = false;
 				index = -1;
 				nextIndex = TROWA_INDEX_UNDEFINED; // Reset our jump to index
+				stepWasReset = true;
 			}
 			else
 			{
@@ -751,19 +953,22 @@ DEBUG("Osc Current Action = Enable.");
 
 	// Current Playing Pattern
 	// If we get an input, then use that:
+	int requestedPatternIx = currentPatternPlayingIx;
 	if (inputs[SELECTED_PATTERN_PLAY_INPUT].isConnected())
 	{
-		currentPatternPlayingIx = VoltsToPattern(inputs[SELECTED_PATTERN_PLAY_INPUT].getVoltage()) - 1;
+		requestedPatternIx = VoltsToPattern(inputs[SELECTED_PATTERN_PLAY_INPUT].getVoltage()) - 1;
 	}
 	else
 	{
 		// Otherwise read our knob parameter and use that
-		currentPatternPlayingIx = (int)clamp(static_cast<int>(roundf(params[SELECTED_PATTERN_PLAY_PARAM].getValue())), 0, TROWA_SEQ_NUM_PATTERNS - 1);
+		requestedPatternIx = (int)clamp(static_cast<int>(roundf(params[SELECTED_PATTERN_PLAY_PARAM].getValue())), 0, TROWA_SEQ_NUM_PATTERNS - 1);
 	}
-	if (currentPatternPlayingIx < 0)
-		currentPatternPlayingIx = 0;
-	else if (currentPatternPlayingIx > TROWA_SEQ_NUM_PATTERNS - 1)
-		currentPatternPlayingIx = TROWA_SEQ_NUM_PATTERNS - 1;
+	if (requestedPatternIx < 0)
+		requestedPatternIx = 0;
+	else if (requestedPatternIx > TROWA_SEQ_NUM_PATTERNS - 1)
+		requestedPatternIx = TROWA_SEQ_NUM_PATTERNS - 1;
+	// Now or at the next switch point
+	requestPlayPattern(requestedPatternIx);
 
 
 	// Current Edit Pattern
@@ -785,10 +990,6 @@ DEBUG("Osc Current Action = Enable.");
 		currentChannelEditingIx = TROWA_SEQ_NUM_CHNLS - 1;
 	editChannelChanged = lastChannelIx != currentChannelEditingIx;
 
-
-	int r = 0;
-	int c = 0;
-
 	if (!editChannelChanged) // [v1.1] Only read in if edit channel hasn't changed
 	{
 		// If the channel hasn't changed, read this in
@@ -822,7 +1023,7 @@ DEBUG("Osc Current Action = Enable.");
 	// (i.e. from OSC)
 	//------------------------------------------------------------
 	/// TODO: Check performance hit from sending OSC in general
-	/// TODO: Some thread safety and make sure that this queue never gets unruly? such that we start getting out of time.
+	// Everything waiting is drained at once (repeated step/BPM/tempo writes collapse to the last value).
 	bool resetMsg = false;
 	bool doPaste = false;
 	int prevCopyPatternIx = copySourcePatternIx;
@@ -830,10 +1031,10 @@ DEBUG("Osc Current Action = Enable.");
 	bool storedPatternChanged = false;
 	bool storedLengthChanged = false;
 	bool storedBPMChanged = false;
-	while (ctlMsgQueue.size() > 0)
+	int numCtlMsgs = ctlMsgQueue.drain();
+	for (int msgIx = 0; msgIx < numCtlMsgs; msgIx++)
 	{
-		TSExternalControlMessage recvMsg = (TSExternalControlMessage)(ctlMsgQueue.front());
-		ctlMsgQueue.pop();
+		TSExternalControlMessage recvMsg = ctlMsgQueue.at(msgIx);
 		float tmp;
 		/// TODO: redorder switch for most common cases first.
 		switch (recvMsg.messageType)
@@ -866,7 +1067,8 @@ DEBUG("Osc Current Action = Enable.");
 				// In performance mode, this will be interupted as jump to (playing):
 				if (recvMsg.pattern != CURRENT_EDIT_PATTERN_IX)
 				{
-					currentPatternPlayingIx = recvMsg.pattern; // Jump to this pattern if sent
+					currentPatternPlayingIx = recvMsg.pattern; // Jump to this pattern if sent (explicit jump, not quantized)
+					queuedPatternPlayingIx = TROWA_INDEX_UNDEFINED;
 					// Update our knob
 					/// TODO: This should be moved to Widget for future headless modules.
 					if (controlKnobs[KnobIx::PlayPatternKnob]) {
@@ -923,17 +1125,17 @@ DEBUG("Osc Current Action = Enable.");
 				recvMsg.pattern = storedPatternPlayingIx; // Check our stored pattern
 			if (recvMsg.pattern > -1 && recvMsg.pattern < TROWA_SEQ_NUM_PATTERNS)
 			{
-				currentPatternPlayingIx = recvMsg.pattern;
+				requestPlayPattern(recvMsg.pattern); // Now or queued
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
-				DEBUG("Set Play Pattern: %d.", currentPatternPlayingIx);
+				DEBUG("Set Play Pattern: %d (playing %d).", recvMsg.pattern, currentPatternPlayingIx);
 #endif
 				// Update our knob
 				/// TODO: This should be moved to Widget for future headless modules.
 				if (controlKnobs[KnobIx::PlayPatternKnob]) {
-					controlKnobs[KnobIx::PlayPatternKnob]->setValue(currentPatternPlayingIx);
+					controlKnobs[KnobIx::PlayPatternKnob]->setValue(recvMsg.pattern);
 					controlKnobs[KnobIx::PlayPatternKnob]->setDirty(true);					
 				}
-				params[ParamIds::SELECTED_PATTERN_PLAY_PARAM].setValue(currentPatternPlayingIx);
+				params[ParamIds::SELECTED_PATTERN_PLAY_PARAM].setValue(recvMsg.pattern);
 			}
 			break;
 		case TSExternalControlMessage::MessageType::StorePlayPattern:
@@ -1182,6 +1384,23 @@ DEBUG("Osc Current Action = Enable.");
 		case TSExternalControlMessage::MessageType::RandomizeEditStepValue:
 			onRandomize();
 			break;
+		case TSExternalControlMessage::MessageType::SetEditStepValues:
+		{
+			// Bulk write: no echo per step, just reload the matrix (one bulk message back) if it is shown.
+			const TSExternalControlQueue::BulkValues* bulk = ctlMsgQueue.getBulk(recvMsg.mode);
+			int p = (recvMsg.pattern == CURRENT_EDIT_PATTERN_IX) ? currentPatternEditingIx : recvMsg.pattern;
+			int c = (recvMsg.channel == CURRENT_EDIT_CHANNEL_IX) ? currentChannelEditingIx : recvMsg.channel;
+			for (int n = 0; n < bulk->numVals; n++)
+			{
+				int ch = (bulk->wholePattern) ? n / maxSteps : c;
+				if (ch < TROWA_SEQ_NUM_CHNLS)
+					triggerState[p][ch][n % maxSteps] = bulk->vals[n];
+			}
+			if (bulk->numVals > 0 && p == currentPatternEditingIx && (bulk->wholePattern || c == currentChannelEditingIx))
+				this->reloadEditMatrix = true;
+			ctlMsgQueue.releaseBulk(recvMsg.mode);
+		}
+		break;
 		case TSExternalControlMessage::MessageType::InitializeEditModule:
 			onReset();
 			/// TODO: This should be moved to Widget for future headless modules.
@@ -1261,6 +1480,14 @@ DEBUG("Osc Current Action = Enable.");
 	// Reset
 	// [03/30/2018] So, now j4s0n wants RESET to wait until the next step is played... 
 	// So it's delayed reset. https://github.com/j4s0n-c/trowaSoft-VCV/issues/11
+	if (followTransport)
+	{
+		// The leader reset (it lands on the same step we are getting from the transport).
+		uint32_t tResetCount = transport->getResetCount();
+		if (tResetCount != transportResetCount)
+			resetMsg = true;
+		transportResetCount = tResetCount;
+	}
 	if (resetTrigger.process(params[RESET_PARAM].getValue() + inputs[RESET_INPUT].getVoltage()) || resetMsg)
 	{
 #if TROWA_DEBUG_MSGS >= TROWA_DEBUG_LVL_MED
@@ -1277,23 +1504,25 @@ DEBUG("Osc Current Action = Enable.");
 
 	if (resetQueued && nextStep) {
 		resetQueued = false; 
+		stepWasReset = true;
 		realPhase = 0.0;
 		swingAdjustedPhase = 0; // Reset swing		
 		index = 999;
 		nextStep = true;
-		lights[RESET_LIGHT].value = 1.0;
+		resetLight.trigger(lightClock.frame);
 		nextIndex = TROWA_INDEX_UNDEFINED; // Reset our jump to index
-		oscMutex.lock();
-		if (useOSC && oscInitialized)
+		bool oscLocked = oscMutex.try_lock(); // Never block the audio thread
+		if (useOSC && oscInitialized && oscLocked)
 		{
 			osc::OutboundPacketStream oscStream(oscBuffer, OSC_OUTPUT_BUFFER_SIZE);
 			oscStream << osc::BeginBundleImmediate
 				<< osc::BeginMessage(oscAddrBuffer[SeqOSCOutputMsg::PlayReset])
 				<< "bang" << osc::EndMessage
 				<< osc::EndBundle;
-			oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+			oscSend(oscStream.Data(), oscStream.Size());
 		}
-		oscMutex.unlock();
+		if (oscLocked)
+			oscMutex.unlock();
 	} // end if resetQueued and it's time to reset
 
 	// Next Step
@@ -1310,13 +1539,41 @@ DEBUG("Osc Current Action = Enable.");
 			index = 0; // Reset (artifical limit)
 		}
 		// Show which step we are on:
-		r = index / this->numCols;// TROWA_SEQ_STEP_NUM_COLS;
-		c = index % this->numCols; //TROWA_SEQ_STEP_NUM_COLS;
-		stepLights[r][c] = 1.0f;
+		stepLights[index].trigger(lightClock.frame);
 		gatePulse.trigger(TROWA_PULSE_WIDTH);
+		if (leadTransport)
+			transport->step(stepWasReset);
+		stepPosition = (stepWasReset) ? 0 : stepPosition + 1;
+
+		// Quantized pattern switch. The outputs just index the pattern, so switching is only swapping the index.
+		if (queuedPatternPlayingIx > TROWA_INDEX_UNDEFINED)
+		{
+			bool switchNow = true;
+			if (patternSwitchMode == PatternSwitchMode::PatternSwitchNextBar)
+			{
+				if (leadTransport || followTransport)
+				{
+					switchNow = transport->isBarStart();
+				}
+				else
+				{
+					int stepsPerBar = static_cast<int>(roundf(60.0f / BPMOptions[selectedBPMNoteIx]->multiplier)) * TROWA_SEQ_TRANSPORT_BEATS_PER_BAR;
+					switchNow = stepPosition % stepsPerBar == 0;
+				}
+			}
+			else if (patternSwitchMode == PatternSwitchMode::PatternSwitchPatternEnd)
+			{
+				switchNow = index == 0;
+			}
+			if (switchNow)
+			{
+				currentPatternPlayingIx = queuedPatternPlayingIx;
+				queuedPatternPlayingIx = TROWA_INDEX_UNDEFINED;
+			}
+		}
 
-		oscMutex.lock();
-		if (useOSC && oscInitialized)
+		bool oscLocked = oscMutex.try_lock(); // Never block the audio thread
+		if (useOSC && oscInitialized && oscLocked)
 		{
 			// [01/06/2018] Changed to one-based for OSC (send index+1 instead of index)
 			osc::OutboundPacketStream oscStream(oscBuffer, OSC_OUTPUT_BUFFER_SIZE);
@@ -1324,11 +1581,18 @@ DEBUG("Osc Current Action = Enable.");
 				<< osc::BeginMessage(oscAddrBuffer[SeqOSCOutputMsg::PlayClock])
 				<< index + 1 << osc::EndMessage
 				<< osc::EndBundle;
-			oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+			oscSend(oscStream.Data(), oscStream.Size());
 		}
-		oscMutex.unlock();
+		if (oscLocked)
+			oscMutex.unlock();
 	} // end if next step
 
+	if (leadTransport)
+	{
+		// Publish once per sample for the followers (steps per beat from our note, 1/4 = 1, 1/16 = 4)
+		transport->publish(running, currentBPM, realPhase, static_cast<int>(roundf(60.0f / BPMOptions[selectedBPMNoteIx]->multiplier)));
+	}
+
 	// // If we were just unpaused and we were reset during the pause, make sure we fire the first step.
 	// if (running && !lastRunning)
 	// {
@@ -1339,10 +1603,13 @@ DEBUG("Osc Current Action = Enable.");
 		// resetPaused = false;
 	// } // end if
 
-	// Reset light
-	lights[RESET_LIGHT].value -= lights[RESET_LIGHT].value / lightLambda / args.sampleRate;
-	// BPM Note Calc light:
-	lights[SELECTED_BPM_MULT_IX_LIGHT].value -= lights[SELECTED_BPM_MULT_IX_LIGHT].value / lightLambda / args.sampleRate;
+	if (updateLights)
+	{
+		// Reset light
+		lights[RESET_LIGHT].value = resetLight.exponential(lightClock.frame, lightTauFrames);
+		// BPM Note Calc light:
+		lights[SELECTED_BPM_MULT_IX_LIGHT].value = bpmNoteLight.exponential(lightClock.frame, lightTauFrames);
+	}
 	*pulse = gatePulse.process(args.sampleTime);
 
 	editChannelChanged = currentChannelEditingIx != lastChannelIx;
@@ -1354,8 +1621,8 @@ DEBUG("Osc Current Action = Enable.");
 
 	// Send messages if needed
 	/// TODO: Make a message sender to do this crap
-	oscMutex.lock();
-	if (useOSC && oscInitialized)
+	bool oscLocked = oscMutex.try_lock(); // Never block the audio thread
+	if (useOSC && oscInitialized && oscLocked)
 	{
 		bool bundleOpened = false;
 		// If something has changed or we just started up osc, then send the status of our sequencer.
@@ -1581,10 +1848,11 @@ DEBUG("Osc Current Action = Enable.");
 		{
 			// Finish and send
 			oscStream << osc::EndBundle;
-			oscTxSocket->Send(oscStream.Data(), oscStream.Size());
+			oscSend(oscStream.Data(), oscStream.Size());
 		}
 	} // end send osc
-	oscMutex.unlock();
+	if (oscLocked)
+		oscMutex.unlock();
 
 	firstLoad = false;
 	return;
@@ -1609,6 +1877,11 @@ json_t *TSSequencerModuleBase::dataToJson() {
 	// The current output / knob mode.
 	json_object_set_new(rootJ, "selectedOutputValueMode", json_integer((int)selectedOutputValueMode));
 	
+	// Shared transport (off, lead, follow)
+	json_object_set_new(rootJ, "transportMode", json_integer((int)getTransportMode()));
+	// When the play pattern changes
+	json_object_set_new(rootJ, "patternSwitchMode", json_integer((int)patternSwitchMode));
+
 	// Current BPM calculation note (i.e. 1/4, 1/8, 1/8T, 1/16)
 	json_object_set_new(rootJ, "selectedBPMNoteIx", json_integer((int)selectedBPMNoteIx));
 	
@@ -1644,6 +1917,9 @@ json_t *TSSequencerModuleBase::dataToJson() {
 	json_object_set_new(oscJ, "IpAddress", json_string(this->currentOSCSettings.oscTxIpAddress.c_str()));
 	json_object_set_new(oscJ, "TxPort", json_integer(this->currentOSCSettings.oscTxPort));
 	json_object_set_new(oscJ, "RxPort", json_integer(this->currentOSCSettings.oscRxPort));
+	json_object_set_new(oscJ, "MulticastTtl", json_integer(this->currentOSCSettings.multicastTtl));
+	json_object_set_new(oscJ, "MulticastLoopback", json_boolean(this->currentOSCSettings.multicastLoopback));
+	json_object_set_new(oscJ, "LocalTransport", json_boolean(this->currentOSCSettings.localTransport));
 	json_object_set_new(oscJ, "Client", json_integer(this->oscCurrentClient));
 	json_object_set_new(oscJ, "AutoReconnectAtLoad", json_boolean(oscReconnectAtLoad)); // [v11, v0.6.3]
 	json_object_set_new(oscJ, "Initialized", json_boolean(oscInitialized)); // [v11, v0.6.3] We know the settings are good at least at the time of save
@@ -1705,6 +1981,22 @@ void TSSequencerModuleBase::dataFromJson(json_t *rootJ) {
 	if (currJ)
 		selectedBPMNoteIx = json_integer_value(currJ);
 
+	// Shared transport
+	currJ = json_object_get(rootJ, "transportMode");
+	if (currJ)
+	{
+		int mode = (int)json_integer_value(currJ);
+		if (mode >= 0 && mode < TSSeqTransport::TransportMode::NUM_TRANSPORT_MODES)
+			setTransportMode(static_cast<TSSeqTransport::TransportMode>(mode));
+	}
+	currJ = json_object_get(rootJ, "patternSwitchMode");
+	if (currJ)
+	{
+		int mode = (int)json_integer_value(currJ);
+		if (mode >= 0 && mode < PatternSwitchMode::NUM_PATTERN_SWITCH_MODES)
+			patternSwitchMode = static_cast<PatternSwitchMode>(mode);
+	}
+
 	// triggers
 	json_t *triggersJ = json_object_get(rootJ, "triggers");
 	if (triggersJ)
@@ -1740,6 +2032,15 @@ void TSSequencerModuleBase::dataFromJson(json_t *rootJ) {
 		currJ = json_object_get(oscJ, "RxPort");
 		if (currJ)
 			this->currentOSCSettings.oscRxPort = (uint16_t)(json_integer_value(currJ));
+		currJ = json_object_get(oscJ, "MulticastTtl");
+		if (currJ)
+			this->currentOSCSettings.multicastTtl = (uint8_t)clamp(static_cast<int>(json_integer_value(currJ)), 1, OSC_MULTICAST_TTL_MAX);
+		currJ = json_object_get(oscJ, "MulticastLoopback");
+		if (currJ)
+			this->currentOSCSettings.multicastLoopback = json_is_true(currJ);
+		currJ = json_object_get(oscJ, "LocalTransport");
+		if (currJ)
+			this->currentOSCSettings.localTransport = json_is_true(currJ) && TROWA_OSC_LOCAL_TRANSPORT;
 		currJ = json_object_get(oscJ, "Client");
 		if (currJ)
 			this->oscCurrentClient = static_cast<OSCClient>((uint8_t)(json_integer_value(currJ)));
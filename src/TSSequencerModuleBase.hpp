@@ -24,12 +24,15 @@ using namespace rack;
 #include <chrono>
 #include "TSTempoBPM.hpp"
 #include "TSExternalControlMessage.hpp"
+#include "TSExternalControlQueue.hpp"
 #include "TSOSCCommon.hpp"
 #include "TSOSCSequencerListener.hpp"
 #include "TSOSCCommunicator.hpp"
 #include "TSOSCSequencerOutputMessages.hpp"
 #include "TSSequencerWidgetBase.hpp"
 #include "TSParamQuantity.hpp"
+#include "TSSeqTransport.hpp"
+#include "TSLightEnvelope.hpp"
 
 #include "../lib/oscpack/osc/OscOutboundPacketStream.h"
 #include "../lib/oscpack/ip/UdpSocket.h"
@@ -229,6 +232,24 @@ struct TSSequencerModuleBase : Module {
 	int currentPatternEditingIx = 0;
 	// Index of which pattern we are editing 
 	int currentPatternPlayingIx = 0;
+	// When the play pattern changes (immediately or quantized).
+	enum PatternSwitchMode : uint8_t {
+		// Switch right away (same sample).
+		PatternSwitchImmediate,
+		// Switch on the next step.
+		PatternSwitchNextStep,
+		// Switch on the next bar (shared transport bar if on the transport).
+		PatternSwitchNextBar,
+		// Switch when the current pattern wraps back to step 1.
+		PatternSwitchPatternEnd,
+		NUM_PATTERN_SWITCH_MODES
+	};
+	// When the play pattern changes.
+	PatternSwitchMode patternSwitchMode = PatternSwitchMode::PatternSwitchImmediate;
+	// Pattern we will switch to at the next switch point (or TROWA_INDEX_UNDEFINED).
+	int queuedPatternPlayingIx = TROWA_INDEX_UNDEFINED;
+	// Steps since the last reset (for bar boundaries when not on the shared transport).
+	uint32_t stepPosition = 0;
 	// Index of which channel (trigger/gate/voice) is currently displayed/edited.
 	int currentChannelEditingIx = 0;
 	/// TODO: Perhaps change this to setting for each pattern or each pattern-channel.
@@ -250,8 +271,22 @@ struct TSSequencerModuleBase : Module {
 	//// Last time of the external step
 	//std::chrono::high_resolution_clock::time_point lastExternalStepTime;
 
-	// Pad/Knob lights - Step On
-	float** stepLights; /// TODO: Just make linear
+	// Shared Transport ////////////////
+	// What this sequencer does with the shared transport (off, lead or follow). Only the audio thread changes it.
+	std::atomic<TSSeqTransport::TransportMode> transportMode { TSSeqTransport::TransportMode::TransportOff };
+	// Mode requested by setTransportMode() (-1 for none), applied by the audio thread (applyTransportMode()).
+	std::atomic<int> pendingTransportMode { -1 };
+	// The process-wide transport.
+	TSSeqTransport* transport = NULL;
+	// Last transport step count we saw (follower).
+	uint32_t transportStepCount = 0;
+	// Last transport reset count we saw (follower).
+	uint32_t transportResetCount = 0;
+	// Last transport running state we saw (follower).
+	bool transportRunning = false;
+
+	// Pad/Knob lights - Step On (by step index, decay evaluated when the lights are updated).
+	TSLightEnvelope* stepLights;
 	float** gateLights; /// TODO: Just make linear
 
 						// Default values for our pads/knobs:
@@ -297,11 +332,13 @@ struct TSSequencerModuleBase : Module {
 	// BPM Calculation //////////////
 	// Index into the array BPMOptions
 	int selectedBPMNoteIx = 1; // 1/8th
+	// [UI thread] The BPM note the BPM knob's unit/multiplier are set for.
+	int bpmParamLabelNoteIx = -1;
 	dsp::SchmittTrigger selectedBPMNoteTrigger;
 
 	// External Messages ///////////////////////////////////////////////
-	// Message queue for external (to Rack) control messages
-	std::queue<TSExternalControlMessage> ctlMsgQueue;
+	// Message queue for external (to Rack) control messages (lock-free, listener thread -> audio thread).
+	TSExternalControlQueue ctlMsgQueue;
 
 	enum ExternalControllerMode {
 		// Edit Mode : Send to control what we are editing.
@@ -323,7 +360,7 @@ struct TSSequencerModuleBase : Module {
 	// Mutex for osc messaging.
 	std::mutex oscMutex;
 	// Current OSC IP address and port settings.
-	TSOSCConnectionInfo currentOSCSettings = { OSC_ADDRESS_DEF,  OSC_OUTPORT_DEF , OSC_INPORT_DEF };
+	TSOSCConnectionInfo currentOSCSettings = { OSC_ADDRESS_DEF,  OSC_OUTPORT_DEF , OSC_INPORT_DEF, OSC_MULTICAST_TTL_DEF, true, false };
 	// OSC Configure trigger
 	dsp::SchmittTrigger oscConfigTrigger;
 	dsp::SchmittTrigger oscConnectTrigger;
@@ -345,23 +382,33 @@ struct TSSequencerModuleBase : Module {
 	// OSC message listener
 	TSOSCSequencerListener* oscListener = NULL;
 	// Receiving OSC socket
-	UdpListeningReceiveSocket* oscRxSocket = NULL;
+	TSOSCListeningSocket* oscRxSocket = NULL;
+	// Sender queue for the local transport (sent by the shared Tx thread instead of oscTxSocket).
+	TSOSCTxQueue* oscTxQueue = NULL;
+#if TROWA_OSC_LOCAL_TRANSPORT
+	// Receiving local socket (instead of oscRxSocket for the local transport).
+	TSOSCLocalListeningSocket* oscLocalRxSocket = NULL;
+#endif
 	// The OSC listener thread
 	std::thread oscListenerThread;
 	// Osc address buffer. 
 	char oscAddrBuffer[SeqOSCOutputMsg::NUM_OSC_OUTPUT_MSGS][OSC_ADDRESS_BUFFER_SIZE];
 	// Prev step that was last turned off (when going to a new step).
 	int oscLastPrevStepUpdated = TROWA_INDEX_UNDEFINED;
+	// Blob data for bulk step messages (BulkClient).
+	char oscBulkBlob[TROWA_SEQ_MAX_NUM_STEPS * OSC_BULK_VALUE_SIZE];
 	// Settings for new OSC.
-	TSOSCInfo oscNewSettings = { OSC_ADDRESS_DEF,  OSC_OUTPORT_DEF , OSC_INPORT_DEF };
+	TSOSCInfo oscNewSettings = { OSC_ADDRESS_DEF,  OSC_OUTPORT_DEF , OSC_INPORT_DEF, OSC_MULTICAST_TTL_DEF, true, false };
 	// OSC Mode action (i.e. Enable, Disable)
 	enum OSCAction {
 		None,
 		Disable,
 		Enable
 	};
-	// Flag for our module to either enable or disable osc.
+	// Flag for our module to either enable or disable osc (done by processOSCAction() on the UI thread).
 	OSCAction oscCurrentAction = OSCAction::None;
+	// Set when OSC just started to a new address (process() then sends everything once).
+	std::atomic<bool> oscStartedPending { false };
 	// The current osc client. Clients such as touchOSC and Lemur are limited and need special treatment.
 	OSCClient oscCurrentClient = OSCClient::GenericClient;
 
@@ -376,6 +423,16 @@ struct TSSequencerModuleBase : Module {
 	// If this was loaded from a save, what version
 	int saveVersion = -1;
 	const float lightLambda = 0.05;
+	// Light frame counter/divider.
+	TSLightClock lightClock;
+	// If the lights should be written this sample (set in getStepInputs()).
+	bool updateLights = false;
+	// Light decay time constant in frames.
+	float lightTauFrames = 1.0f;
+	// Reset light.
+	TSLightEnvelope resetLight;
+	// BPM Note Calc light.
+	TSLightEnvelope bpmNoteLight;
 	// The number of structured random patterns to actually use. Should be <= TROWA_SEQ_NUM_RANDOM_PATTERNS.
 	int numStructuredRandomPatterns = TROWA_SEQ_BOOLEAN_NUM_RANDOM_PATTERNS;
 
@@ -393,6 +450,50 @@ struct TSSequencerModuleBase : Module {
 	// Delete our goodies.
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-	
 	~TSSequencerModuleBase();
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// setTransportMode()
+	// Join/leave the shared transport (the audio thread switches on its next sample).
+	// @mode : (IN) Off, Lead or Follow.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void setTransportMode(TSSeqTransport::TransportMode mode);
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// applyTransportMode()
+	// [Audio thread] Switch to the mode requested by setTransportMode() (if any).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void applyTransportMode();
+	// The transport mode (the requested one if it hasn't been applied yet).
+	TSSeqTransport::TransportMode getTransportMode() {
+		int mode = pendingTransportMode.load();
+		return (mode >= 0) ? static_cast<TSSeqTransport::TransportMode>(mode) : transportMode.load();
+	}
+	// If this sequencer is currently stepping from the shared transport.
+	bool isFollowingTransport() {
+		return transportMode == TSSeqTransport::TransportMode::TransportFollow && transport->hasLeader();
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// requestPlayPattern()
+	// Change the play pattern now or queue it for the next switch point (patternSwitchMode).
+	// @patternIx : (IN) The pattern to play (0-63).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void requestPlayPattern(int patternIx)
+	{
+		if (patternSwitchMode == PatternSwitchMode::PatternSwitchImmediate || !running || firstLoad)
+		{
+			currentPatternPlayingIx = patternIx;
+			queuedPatternPlayingIx = TROWA_INDEX_UNDEFINED;
+		}
+		else
+		{
+			// Asking for what is already playing cancels the queued switch.
+			queuedPatternPlayingIx = (patternIx != currentPatternPlayingIx) ? patternIx : TROWA_INDEX_UNDEFINED;
+		}
+		return;
+	}
+	// Current (decayed) value of the step light for step @s.
+	float getStepLight(int s)
+	{
+		return stepLights[s].exponential(lightClock.frame, lightTauFrames);
+	}
 	// Get the inputs for this step.
 	void getStepInputs(const ProcessArgs &args, bool* pulse, bool* reloadMatrix, bool* valueModeChanged);
 	// Paste the clipboard pattern and/or specific gate to current selected pattern and/or gate.
@@ -411,6 +512,38 @@ struct TSSequencerModuleBase : Module {
 	// Clean up OSC.
 	void cleanupOSC();
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// processOSCAction()
+	// [UI thread] Enable/disable OSC if requested (oscCurrentAction). Opening and
+	// closing sockets/threads blocks, so it isn't done in process().
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void processOSCAction();
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// updateBPMParamLabel()
+	// [UI thread] Set the BPM knob's unit/multiplier for the selected BPM note
+	// (not done in process() since assigning the std::string allocates).
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void updateBPMParamLabel();
+	// Send an OSC packet (UDP socket or local transport queue).
+	void oscSend(const char* data, int size)
+	{
+		if (oscTxQueue != NULL)
+		{
+			if (oscTxQueue->push(data, size))
+				oscTxQueue->signal();
+		}
+		else if (oscTxSocket != NULL)
+			oscTxSocket->Send(data, size);
+		return;
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// addOSCBulkChannelSteps()
+	// Add all step values of a channel as one message (/edit/ch/steps) for bulk clients.
+	// @oscStream : (IN/OUT) The stream (bundle) to add to.
+	// @pattern : (IN) The pattern index.
+	// @channel : (IN) The channel index.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void addOSCBulkChannelSteps(osc::OutboundPacketStream& oscStream, int pattern, int channel);
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// Set the OSC namespace.
 	// @oscNs: (IN) The namespace for OSC.
 	// Sets the command address strings too.
@@ -499,6 +632,18 @@ struct TSSeqDisplay : TransparentWidget {
 	int fontSize;
 	char messageStr[TROWA_DISP_MSG_SIZE]; // tmp buffer for our strings.
 	bool showDisplay = true;
+	// Values last drawn. We are drawn in a cached layer, only redrawn when one of these changes.
+	bool lastShowDisplay = true;
+	int lastPlayPattern = TROWA_INDEX_UNDEFINED;
+	int lastQueuedPattern = TROWA_INDEX_UNDEFINED;
+	int lastEditPattern = TROWA_INDEX_UNDEFINED;
+	int lastChannel = TROWA_INDEX_UNDEFINED;
+	int lastNumSteps = TROWA_INDEX_UNDEFINED;
+	// BPM as shown (rounded like %.0f).
+	float lastBPM = -1.0f;
+	int lastBPMNoteIx = TROWA_INDEX_UNDEFINED;
+	bool lastExternalClock = false;
+	const char* lastModeString = NULL;
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// TSSeqDisplay(void)
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -512,6 +657,40 @@ struct TSSeqDisplay : TransparentWidget {
 		return;
 	}
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// step()
+	// Mark our cached layer dirty if anything we show has changed.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void step() override {
+		bool changed = showDisplay != lastShowDisplay;
+		lastShowDisplay = showDisplay;
+		if (module != NULL)
+		{
+			float bpm = nearbyintf(module->currentBPM);
+			changed = changed || module->currentPatternPlayingIx != lastPlayPattern
+				|| module->queuedPatternPlayingIx != lastQueuedPattern
+				|| module->currentPatternEditingIx != lastEditPattern
+				|| module->currentChannelEditingIx != lastChannel
+				|| module->currentNumberSteps != lastNumSteps
+				|| bpm != lastBPM
+				|| module->selectedBPMNoteIx != lastBPMNoteIx
+				|| module->lastStepWasExternalClock != lastExternalClock
+				|| module->modeString != lastModeString;
+			lastPlayPattern = module->currentPatternPlayingIx;
+			lastQueuedPattern = module->queuedPatternPlayingIx;
+			lastEditPattern = module->currentPatternEditingIx;
+			lastChannel = module->currentChannelEditingIx;
+			lastNumSteps = module->currentNumberSteps;
+			lastBPM = bpm;
+			lastBPMNoteIx = module->selectedBPMNoteIx;
+			lastExternalClock = module->lastStepWasExternalClock;
+			lastModeString = module->modeString;
+		}
+		if (changed)
+			TS_markCachedLayerDirty(this);
+		TransparentWidget::step();
+		return;
+	}
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// draw()
 	// @args.vg : (IN) NVGcontext to draw on
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -535,6 +714,7 @@ struct TSSeqDisplay : TransparentWidget {
 			return;
 
 		int currPlayPattern = 1;
+		int queuedPlayPattern = TROWA_INDEX_UNDEFINED;
 		int currEditPattern = 1;
 		int currentGate = 1;
 		int currentNSteps = 16;
@@ -545,6 +725,7 @@ struct TSSeqDisplay : TransparentWidget {
 		{
 			currColor = module->voiceColors[module->currentChannelEditingIx];
 			currPlayPattern = module->currentPatternPlayingIx + 1;
+			queuedPlayPattern = module->queuedPatternPlayingIx;
 			currEditPattern = module->currentPatternEditingIx + 1;
 			currentGate = module->currentChannelEditingIx + 1;
 			currentNSteps = module->currentNumberSteps;
@@ -571,7 +752,16 @@ struct TSSeqDisplay : TransparentWidget {
 		x = 5 + 21;
 		nvgFontSize(args.vg, fontSize); // Small font
 		nvgFontFaceId(args.vg, labelFont->handle);
-		nvgText(args.vg, x, y1, "PATT", NULL);
+		if (queuedPlayPattern > TROWA_INDEX_UNDEFINED)
+		{
+			// Show the pattern we will switch to
+			sprintf(messageStr, "P>%02d", queuedPlayPattern + 1);
+			nvgText(args.vg, x, y1, messageStr, NULL);
+		}
+		else
+		{
+			nvgText(args.vg, x, y1, "PATT", NULL);
+		}
 		sprintf(messageStr, "%02d", currPlayPattern);
 		nvgFontSize(args.vg, fontSize * 1.5);	// Large font
 		nvgFontFaceId(args.vg, font->handle);
@@ -712,7 +902,7 @@ struct TSSeqDisplay : TransparentWidget {
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // TSSeqLabelArea
-// Draw labels on our sequencer.
+// Draw labels on our sequencer (static, drawn in a cached layer).
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 struct TSSeqLabelArea : TransparentWidget {
 	TSSequencerModuleBase *module;
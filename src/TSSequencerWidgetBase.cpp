@@ -39,7 +39,7 @@ void TSSequencerWidgetBase::addBaseControls(bool addGridLines)
 		display->box.pos = Vec(13, 24);
 		display->box.size = Vec(363, 48);
 		display->module = thisModule;
-		addChild(display);
+		addChild(TS_createCachedLayer(display)); // Only redrawn when a value changes
 	}	
 	////////////////////////////////////
 	// OSC configuration screen.
@@ -51,7 +51,7 @@ void TSSequencerWidgetBase::addBaseControls(bool addGridLines)
 			thisModule->oscCurrentClient,
 			thisModule->currentOSCSettings.oscTxIpAddress.c_str(), thisModule->currentOSCSettings.oscTxPort, thisModule->currentOSCSettings.oscRxPort);
 		oscConfig->setVisible(false);
-		oscConfig->box.pos = display->box.pos;
+		oscConfig->box.pos = display->parent->box.pos;
 		oscConfig->box.size = display->box.size;
 		this->oscConfigurationScreen = oscConfig;
 		addChild(oscConfig);
@@ -66,7 +66,7 @@ void TSSequencerWidgetBase::addBaseControls(bool addGridLines)
 		area->box.size = Vec(box.size.x, 380);
 		area->module = thisModule;
 		area->drawGridLines = addGridLines;
-		addChild(area);
+		addChild(TS_createCachedLayer(area)); // Static
 	}
 	// Screws:
 	addChild(createWidget<ScrewBlack>(Vec(0, 0)));
@@ -283,6 +283,11 @@ void TSSequencerWidgetBase::step()
 		return;
 
 	TSSequencerModuleBase* thisModule = dynamic_cast<TSSequencerModuleBase*>(module);
+	// Connect/disconnect OSC and update the BPM knob here (not in process())
+	thisModule->processOSCAction();
+	thisModule->updateBPMParamLabel();
+	if (oscConfigurationScreen != NULL)
+		oscConfigurationScreen->localTransport = thisModule->currentOSCSettings.localTransport; // Label follows the menu setting
 
 	if (thisModule->oscConfigTrigger.process(thisModule->params[TSSequencerModuleBase::ParamIds::OSC_SHOW_CONF_PARAM].getValue()))
 	{
@@ -504,6 +509,91 @@ struct seqRandomMenuItem : MenuItem {
 	}
 };
 
+// Menu item to pick what the sequencer does with the shared transport.
+struct seqTransportModeMenuItem : MenuItem {
+	TSSequencerModuleBase* sequencerModule;
+	TSSeqTransport::TransportMode mode;
+
+	seqTransportModeMenuItem(std::string text, TSSeqTransport::TransportMode mode, TSSequencerModuleBase* seqModule)
+	{
+		this->box.size.x = 200;
+		this->text = text;
+		this->mode = mode;
+		this->sequencerModule = seqModule;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		sequencerModule->setTransportMode(mode);
+	}
+	void step() override {
+		rightText = CHECKMARK(sequencerModule->getTransportMode() == mode);
+		if (mode == TSSeqTransport::TransportMode::TransportLead && sequencerModule->transport->hasLeader()
+			&& !sequencerModule->transport->isLeader(sequencerModule->oscId))
+		{
+			// Someone else is leading, we would just run on our own clock
+			rightText = "(taken) " + rightText;
+		}
+		MenuItem::step();
+	}
+};
+// Menu item to pick when the play pattern changes.
+struct seqPatternSwitchMenuItem : MenuItem {
+	TSSequencerModuleBase* sequencerModule;
+	TSSequencerModuleBase::PatternSwitchMode mode;
+
+	seqPatternSwitchMenuItem(std::string text, TSSequencerModuleBase::PatternSwitchMode mode, TSSequencerModuleBase* seqModule)
+	{
+		this->box.size.x = 200;
+		this->text = text;
+		this->mode = mode;
+		this->sequencerModule = seqModule;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		sequencerModule->patternSwitchMode = mode;
+		if (mode == TSSequencerModuleBase::PatternSwitchMode::PatternSwitchImmediate)
+			sequencerModule->queuedPatternPlayingIx = TROWA_INDEX_UNDEFINED; // Next sample picks up the knob
+	}
+	void step() override {
+		rightText = CHECKMARK(sequencerModule->patternSwitchMode == mode);
+		MenuItem::step();
+	}
+};
+// Live counts of the external control (OSC) message queue.
+struct seqCtlQueueStatsMenuLabel : MenuLabel {
+	TSSequencerModuleBase* sequencerModule;
+	// Which count we show.
+	enum StatType {
+		StatReceived,
+		StatCoalesced,
+		StatOverflow
+	};
+	StatType statType;
+	char buffer[TROWA_DISP_MSG_SIZE];
+
+	seqCtlQueueStatsMenuLabel(StatType statType, TSSequencerModuleBase* seqModule)
+	{
+		this->statType = statType;
+		this->sequencerModule = seqModule;
+		return;
+	}
+	void step() override {
+		switch (statType)
+		{
+		case StatType::StatCoalesced:
+			snprintf(buffer, TROWA_DISP_MSG_SIZE, "Coalesced (replaced): %u", sequencerModule->ctlMsgQueue.getCoalescedCount());
+			break;
+		case StatType::StatOverflow:
+			snprintf(buffer, TROWA_DISP_MSG_SIZE, "Dropped (queue full): %u", sequencerModule->ctlMsgQueue.getOverflowCount());
+			break;
+		default:
+			snprintf(buffer, TROWA_DISP_MSG_SIZE, "Received: %u", sequencerModule->ctlMsgQueue.getReceivedCount());
+			break;
+		}
+		text = buffer;
+		MenuLabel::step();
+	}
+};
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // createContextMenu()
@@ -525,5 +615,43 @@ void TSSequencerWidgetBase::appendContextMenu(ui::Menu *menu)
 	menu->addChild(modeLabel); //menu->pushChild(modeLabel);
 	menu->addChild(new seqRandomMenuItem("> All Steps Random", false, sequencerModule));
 	menu->addChild(new seqRandomMenuItem("> Structured Random", true, sequencerModule));
+
+	//-------- Shared Transport ------- //
+	if (sequencerModule)
+	{
+		menu->addChild(new MenuLabel());
+		MenuLabel *transportLabel = new MenuLabel();
+		transportLabel->text = "Shared Transport";
+		menu->addChild(transportLabel);
+		menu->addChild(new seqTransportModeMenuItem("Off (Own Clock)", TSSeqTransport::TransportMode::TransportOff, sequencerModule));
+		menu->addChild(new seqTransportModeMenuItem("Lead", TSSeqTransport::TransportMode::TransportLead, sequencerModule));
+		menu->addChild(new seqTransportModeMenuItem("Follow", TSSeqTransport::TransportMode::TransportFollow, sequencerModule));
+
+		//-------- Pattern Change ------- //
+		menu->addChild(new MenuLabel());
+		MenuLabel *switchLabel = new MenuLabel();
+		switchLabel->text = "Play Pattern Change";
+		menu->addChild(switchLabel);
+		menu->addChild(new seqPatternSwitchMenuItem("Immediate", TSSequencerModuleBase::PatternSwitchMode::PatternSwitchImmediate, sequencerModule));
+		menu->addChild(new seqPatternSwitchMenuItem("Next Step", TSSequencerModuleBase::PatternSwitchMode::PatternSwitchNextStep, sequencerModule));
+		menu->addChild(new seqPatternSwitchMenuItem("Next Bar", TSSequencerModuleBase::PatternSwitchMode::PatternSwitchNextBar, sequencerModule));
+		menu->addChild(new seqPatternSwitchMenuItem("Pattern End", TSSequencerModuleBase::PatternSwitchMode::PatternSwitchPatternEnd, sequencerModule));
+
+		//-------- OSC Input Queue ------- //
+		if (sequencerModule->allowOSC)
+		{
+			menu->addChild(new MenuLabel());
+			MenuLabel *queueLabel = new MenuLabel();
+			queueLabel->text = "OSC Input Messages";
+			menu->addChild(queueLabel);
+			menu->addChild(new seqCtlQueueStatsMenuLabel(seqCtlQueueStatsMenuLabel::StatType::StatReceived, sequencerModule));
+			menu->addChild(new seqCtlQueueStatsMenuLabel(seqCtlQueueStatsMenuLabel::StatType::StatCoalesced, sequencerModule));
+			menu->addChild(new seqCtlQueueStatsMenuLabel(seqCtlQueueStatsMenuLabel::StatType::StatOverflow, sequencerModule));
+
+			//-------- Transport / Multicast ------- //
+			TSOSCAppendTransportMenu(menu, sequencerModule);
+			TSOSCAppendMulticastMenu(menu, sequencerModule);
+		}
+	}
 	return;
 }
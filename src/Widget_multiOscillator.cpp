@@ -139,10 +139,82 @@ void multiOscillatorWidget::step()
 {
 	if (module == NULL)
 		return;
+	dynamic_cast<multiOscillator*>(module)->updateAuxParamLabels();
 	TSSModuleWidgetBase::step();
 	return;
 } // end multiOscillator::step()
 
+// Menu item to pick the AM/Ring Mod oversampling for an output.
+struct mOscOversampleMenuItem : MenuItem {
+	TS_OscillatorOutput* outputWave;
+	int factor;
+
+	mOscOversampleMenuItem(std::string text, int factor, TS_OscillatorOutput* outputWave)
+	{
+		this->box.size.x = 120;
+		this->text = text;
+		this->factor = factor;
+		this->outputWave = outputWave;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		// Audio thread picks this up and resets its filters
+		outputWave->amOversample = factor;
+	}
+	void step() override {
+		rightText = CHECKMARK(outputWave->amOversample == factor);
+		MenuItem::step();
+	}
+};
+// Sub menu for an output's AM/Ring Mod oversampling.
+struct mOscOversampleOutputMenuItem : MenuItem {
+	TS_OscillatorOutput* outputWave;
+
+	mOscOversampleOutputMenuItem(std::string text, TS_OscillatorOutput* outputWave)
+	{
+		this->box.size.x = 200;
+		this->text = text;
+		this->outputWave = outputWave;
+		this->rightText = RIGHT_ARROW;
+		return;
+	}
+	Menu *createChildMenu() override {
+		Menu* menu = new Menu();
+		menu->addChild(new mOscOversampleMenuItem("Off (1x)", 1, outputWave));
+		for (int f = 2; f <= TROWA_MOSC_MAX_OVERSAMPLE; f *= 2)
+		{
+			menu->addChild(new mOscOversampleMenuItem(std::to_string(f) + "x", f, outputWave));
+		}
+		return menu;
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// appendContextMenu()
+// Add AM/Ring Mod oversampling options (per output, only costs CPU on that output).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void multiOscillatorWidget::appendContextMenu(ui::Menu *menu)
+{
+	multiOscillator* thisModule = dynamic_cast<multiOscillator*>(module);
+	if (thisModule == NULL)
+		return;
+	MenuLabel *spacerLabel = new MenuLabel();
+	menu->addChild(spacerLabel);
+	MenuLabel *modeLabel = new MenuLabel();
+	modeLabel->text = "AM/Ring Mod Oversampling";
+	menu->addChild(modeLabel);
+	for (int osc = 0; osc < thisModule->numberOscillators; osc++)
+	{
+		TS_Oscillator* theOscillator = &(thisModule->oscillators[osc]);
+		for (int i = 0; i < theOscillator->numOutputWaveForms; i++)
+		{
+			std::string text = "Oscillator " + std::to_string(osc + 1) + " Output " + std::to_string(i + 1);
+			menu->addChild(new mOscOversampleOutputMenuItem(text, &(theOscillator->outputWaveforms[i])));
+		}
+	}
+	return;
+} // end appendContextMenu()
+
 
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -45,6 +45,11 @@ struct multiOscillatorWidget : TSSModuleWidgetBase {
 	~multiOscillatorWidget();
 	// Step
 	void step() override;
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// appendContextMenu()
+	// Add AM/Ring Mod oversampling options.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void appendContextMenu(ui::Menu *menu) override;
 
 
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -91,7 +91,7 @@ multiScopeWidget::multiScopeWidget(multiScope *scopeModule) : TSSModuleWidgetBas
 		area->box.pos = Vec(0, TROWA_SCOPE_CONTROL_START_Y - 14); // wAS 56_24 = 80, OLD CONTROL START WAS 94
 		area->box.size = Vec(inputAreaWidth, box.size.y - 50);
 		area->module = scopeModule;
-		addChild(area);
+		addChild(TS_createCachedLayer(area)); // Static
 	}
 
 	////////////////////////////////////
@@ -563,6 +563,188 @@ void multiScopeWidget::step() {
 	}
 	return;
 } // end step()
+
+// Menu item to pick how closely XY traces follow the points.
+struct multiScopeXYQualityMenuItem : MenuItem {
+	multiScope* scopeModule;
+	int quality;
+
+	multiScopeXYQualityMenuItem(std::string text, int quality, multiScope* scopeModule)
+	{
+		this->box.size.x = 200;
+		this->text = text;
+		this->quality = quality;
+		this->scopeModule = scopeModule;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		scopeModule->xyTraceQuality = quality;
+	}
+	void step() override {
+		rightText = CHECKMARK(scopeModule->xyTraceQuality == quality);
+		MenuItem::step();
+	}
+};
+
+// Menu item that sets an int option (trigger mode, pre-trigger depth).
+struct multiScopeIntOptionMenuItem : MenuItem {
+	int* option;
+	int value;
+
+	multiScopeIntOptionMenuItem(std::string text, int* option, int value)
+	{
+		this->box.size.x = 200;
+		this->text = text;
+		this->option = option;
+		this->value = value;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		*option = value;
+	}
+	void step() override {
+		rightText = CHECKMARK(*option == value);
+		MenuItem::step();
+	}
+};
+// Menu item that sets a bool option (trigger source, slope).
+struct multiScopeBoolOptionMenuItem : MenuItem {
+	bool* option;
+	bool value;
+
+	multiScopeBoolOptionMenuItem(std::string text, bool* option, bool value)
+	{
+		this->box.size.x = 200;
+		this->text = text;
+		this->option = option;
+		this->value = value;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		*option = value;
+	}
+	void step() override {
+		rightText = CHECKMARK(*option == value);
+		MenuItem::step();
+	}
+};
+// Re-arm a single capture.
+struct multiScopeTriggerArmMenuItem : MenuItem {
+	TSWaveform* waveForm;
+
+	multiScopeTriggerArmMenuItem(std::string text, TSWaveform* waveForm)
+	{
+		this->box.size.x = 200;
+		this->text = text;
+		this->waveForm = waveForm;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		waveForm->triggerArmRequest.store(true);
+	}
+	void step() override {
+		disabled = waveForm->triggerMode != TSWaveform::TriggerSingle || waveForm->lissajous;
+		if (disabled)
+			rightText = "";
+		else
+			rightText = (waveForm->triggerState == TSWaveform::TriggerHolding) ? "Captured" : "Waiting";
+		MenuItem::step();
+	}
+};
+// Trigger level (the shape's TRIG_PARAM).
+struct multiScopeTriggerLevelSlider : ui::Slider {
+	multiScopeTriggerLevelSlider(Quantity* levelQuantity)
+	{
+		this->box.size.x = 200;
+		this->quantity = levelQuantity; // Not owned
+		return;
+	}
+};
+// Sub menu with one shape's trigger settings.
+struct multiScopeTriggerMenuItem : MenuItem {
+	multiScope* scopeModule;
+	int wIx;
+
+	multiScopeTriggerMenuItem(std::string text, int wIx, multiScope* scopeModule)
+	{
+		this->box.size.x = 200;
+		this->text = text;
+		this->wIx = wIx;
+		this->scopeModule = scopeModule;
+		this->rightText = RIGHT_ARROW;
+		return;
+	}
+	Menu *createChildMenu() override {
+		const char* modeNames[TSWaveform::NUM_TRIGGER_MODES] = { "Off (Free Run)", "Auto", "Normal", "Single" };
+		const int prePercents[] = { 0, 10, 25, 50, 75, TROWA_SCOPE_TRIG_PRE_MAX };
+		TSWaveform* waveForm = scopeModule->waveForms[wIx];
+		Menu* menu = new Menu();
+		for (int m = 0; m < TSWaveform::NUM_TRIGGER_MODES; m++)
+		{
+			menu->addChild(new multiScopeIntOptionMenuItem(modeNames[m], &(waveForm->triggerMode), m));
+		}
+		menu->addChild(new multiScopeTriggerArmMenuItem("Arm Single", waveForm));
+		menu->addChild(new MenuSeparator());
+		menu->addChild(new multiScopeBoolOptionMenuItem("Source: X", &(waveForm->triggerOnX), true));
+		menu->addChild(new multiScopeBoolOptionMenuItem("Source: Y", &(waveForm->triggerOnX), false));
+		menu->addChild(new multiScopeBoolOptionMenuItem("Rising Edge", &(waveForm->triggerFalling), false));
+		menu->addChild(new multiScopeBoolOptionMenuItem("Falling Edge", &(waveForm->triggerFalling), true));
+		menu->addChild(new multiScopeTriggerLevelSlider(scopeModule->paramQuantities[multiScope::TRIG_PARAM + wIx]));
+		menu->addChild(new MenuSeparator());
+		MenuLabel* preLabel = new MenuLabel();
+		preLabel->text = "Pre-Trigger";
+		menu->addChild(preLabel);
+		for (int i = 0; i < (int)(sizeof(prePercents) / sizeof(prePercents[0])); i++)
+		{
+			menu->addChild(new multiScopeIntOptionMenuItem(std::to_string(prePercents[i]) + "%", &(waveForm->triggerPrePercent), prePercents[i]));
+		}
+		return menu;
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// appendContextMenu()
+// Add XY trace quality options (lower quality drops points that would be hidden
+// under the line anyway), the trigger settings for each shape and persistence.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void multiScopeWidget::appendContextMenu(ui::Menu *menu)
+{
+	multiScope* scopeModule = dynamic_cast<multiScope*>(module);
+	if (scopeModule == NULL)
+		return;
+	MenuLabel *spacerLabel = new MenuLabel();
+	menu->addChild(spacerLabel);
+	MenuLabel *modeLabel = new MenuLabel();
+	modeLabel->text = "X*Y Trace Quality";
+	menu->addChild(modeLabel);
+	for (int q = 0; q < TRACE_NUM_QUALITIES; q++)
+	{
+		menu->addChild(new multiScopeXYQualityMenuItem(TSScopeTraceQualityNames[q], q, scopeModule));
+	}
+
+	//-------- Trigger ------- //
+	menu->addChild(new MenuLabel());
+	MenuLabel *trigLabel = new MenuLabel();
+	trigLabel->text = "Trigger (X*Y Off)";
+	menu->addChild(trigLabel);
+	for (int wIx = 0; wIx < TROWA_SCOPE_NUM_WAVEFORMS; wIx++)
+	{
+		char buffer[TROWA_DISP_MSG_SIZE];
+		snprintf(buffer, TROWA_DISP_MSG_SIZE, TROWA_SCOPE_SHAPE_FORMAT_STRING, wIx + 1);
+		menu->addChild(new multiScopeTriggerMenuItem(buffer, wIx, scopeModule));
+	}
+
+	//-------- Persistence ------- //
+	menu->addChild(new MenuLabel());
+	MenuLabel *persistLabel = new MenuLabel();
+	persistLabel->text = "Persistence";
+	menu->addChild(persistLabel);
+	for (int p = 0; p < TROWA_SCOPE_NUM_PERSISTENCE; p++)
+	{
+		menu->addChild(new multiScopeIntOptionMenuItem(SCOPE_PERSISTENCE_NAMES[p], &(scopeModule->persistence), p));
+	}
+	return;
+} // end appendContextMenu()
 // //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // // serialize(void)
 // // Save to json.
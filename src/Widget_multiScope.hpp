@@ -158,6 +158,11 @@ struct multiScopeWidget : TSSModuleWidgetBase {
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	multiScopeWidget(multiScope* scopeModule);
 	void step() override;
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	// appendContextMenu()
+	// Add XY trace quality and trigger options.
+	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+	void appendContextMenu(ui::Menu *menu) override;
 	// /** 
 	// Overriding these is deprecated.
 	// Use Module::dataToJson() and dataFromJson() instead
@@ -52,7 +52,7 @@ oscCVWidget::oscCVWidget(oscCV* oscModule) : TSSModuleWidgetBase(oscModule, fals
 		this->display->showDisplay = true;
 		display->box.pos = Vec(TROWA_HORIZ_MARGIN, 24);
 		display->box.size = topScreenSize;
-		addChild(display);
+		addChild(TS_createCachedLayer(display)); // Only redrawn when the message changes or scrolls
 	}
 
 	////////////////////////////////////
@@ -78,7 +78,7 @@ oscCVWidget::oscCVWidget(oscCV* oscModule) : TSSModuleWidgetBase(oscModule, fals
 		TSOscCVLabels* labelArea = new TSOscCVLabels();
 		labelArea->box.pos = Vec(TROWA_HORIZ_MARGIN, topScreenSize.y + 24);
 		labelArea->box.size = Vec(box.size.x - TROWA_HORIZ_MARGIN * 2, box.size.y - labelArea->box.pos.y - 15);
-		addChild(labelArea);
+		addChild(TS_createCachedLayer(labelArea)); // Static
 	}
 
 	int x, y, dx, dy;
@@ -368,6 +368,10 @@ void oscCVWidget::step()
 		return;
 
 	oscCV* thisModule = dynamic_cast<oscCV*>(module);
+	// Connect/disconnect OSC here (not in process())
+	thisModule->processOSCAction();
+	if (oscConfigurationScreen != NULL)
+		oscConfigurationScreen->localTransport = thisModule->currentOSCSettings.localTransport; // Label follows the menu setting
 	
 	bool loadModuleToConfig = false;
 	if (showConfigScreen != thisModule->oscShowConfigurationScreen)
@@ -686,6 +690,111 @@ void oscCVWidget::onDragEnd(const event::DragEnd &e)
 	return;
 } // end onDragEnd()
 
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// appendContextMenu()
+// Max packet size (so large poly bundles get split instead of IP fragmented), send policy and Tx counters.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void oscCVWidget::appendContextMenu(ui::Menu *menu)
+{
+	oscCV* thisModule = dynamic_cast<oscCV*>(this->module);
+	if (thisModule == NULL)
+		return;
+
+	MenuLabel *spacerLabel = new MenuLabel();
+	menu->addChild(spacerLabel);
+
+	//-------- Max Packet Size ------- //
+	MenuLabel *modeLabel = new MenuLabel();
+	modeLabel->text = "Max Packet Size (Tx)";
+	menu->addChild(modeLabel);
+	menu->addChild(new TSOscCVMaxPacketSizeItem("> 508 bytes (Safe Minimum)", 508, thisModule));
+	menu->addChild(new TSOscCVMaxPacketSizeItem("> 1452 bytes (Ethernet IPv6)", 1452, thisModule));
+	menu->addChild(new TSOscCVMaxPacketSizeItem("> 1472 bytes (Ethernet IPv4)", 1472, thisModule));
+	menu->addChild(new TSOscCVMaxPacketSizeItem("> 8972 bytes (Jumbo Frames)", 8972, thisModule));
+	menu->addChild(new TSOscCVMaxPacketSizeItem("> No Limit (Single Bundle)", 0, thisModule));
+
+	//-------- Send Policy ------- //
+	if (thisModule->doCVPort2OSC && thisModule->numberChannels > 0)
+	{
+		menu->addChild(new MenuLabel());
+		modeLabel = new MenuLabel();
+		modeLabel->text = "Send Policy (CV->OSC)";
+		menu->addChild(modeLabel);
+		TSOscCVAdaptiveDeadbandItem* deadbandItem = new TSOscCVAdaptiveDeadbandItem();
+		deadbandItem->text = "> Adaptive Deadband (Ignore Noise)";
+		deadbandItem->oscModule = thisModule;
+		menu->addChild(deadbandItem);
+		menu->addChild(new TSOscCVSignificantSendItem("> Significant Changes: Next Tick", -1.0f, thisModule));
+		menu->addChild(new TSOscCVSignificantSendItem("> Significant Changes: Immediately", 0.0f, thisModule));
+		menu->addChild(new TSOscCVSignificantSendItem("> Significant Changes: Within 2 ms", 2.0f, thisModule));
+		menu->addChild(new TSOscCVSignificantSendItem("> Significant Changes: Within 5 ms", 5.0f, thisModule));
+	}
+
+	//-------- Rx Jitter Buffer ------- //
+	if (thisModule->doOSC2CVPort)
+	{
+		menu->addChild(new MenuLabel());
+		modeLabel = new MenuLabel();
+		modeLabel->text = "Jitter Buffer (OSC->CV)";
+		menu->addChild(modeLabel);
+		menu->addChild(new TSOscCVJitterBufferItem("> Off (Apply on Arrival)", 0.0f, thisModule));
+		menu->addChild(new TSOscCVJitterBufferItem("> 2 ms", 2.0f, thisModule));
+		menu->addChild(new TSOscCVJitterBufferItem("> 5 ms", 5.0f, thisModule));
+		menu->addChild(new TSOscCVJitterBufferItem("> 10 ms", 10.0f, thisModule));
+		menu->addChild(new TSOscCVJitterBufferItem("> 20 ms", 20.0f, thisModule));
+	}
+
+	//-------- OSC->CV Smoothing ------- //
+	if (thisModule->doOSC2CVPort)
+	{
+		appendSmoothingMenu(menu, thisModule->outputChannels, thisModule->numberChannels);
+	}
+
+	//-------- Transport / Multicast ------- //
+	TSOSCAppendTransportMenu(menu, thisModule);
+	TSOSCAppendMulticastMenu(menu, thisModule);
+
+	//-------- Tx Counters ------- //
+	char buffer[100];
+	menu->addChild(new MenuLabel());
+	modeLabel = new MenuLabel();
+	sprintf(buffer, "Sent: %u packets, %.1f KB", static_cast<unsigned int>(thisModule->oscTxPacketCount), static_cast<double>(thisModule->oscTxByteCount) / 1024.0);
+	modeLabel->text = buffer;
+	menu->addChild(modeLabel);
+	modeLabel = new MenuLabel();
+	sprintf(buffer, "Dropped (buffer full): %u messages", static_cast<unsigned int>(thisModule->oscTxDropCount));
+	modeLabel->text = buffer;
+	menu->addChild(modeLabel);
+	TSOscCVResetTxCountersItem* resetItem = new TSOscCVResetTxCountersItem();
+	resetItem->text = "> Reset Counters";
+	resetItem->oscModule = thisModule;
+	menu->addChild(resetItem);
+	return;
+} // end appendContextMenu()
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// appendSmoothingMenu()
+// @menu : (IN/OUT) The menu to add to.
+// @channels : (IN) The OSC->CV channels.
+// @numChannels : (IN) The number of channels.
+// Add the OSC->CV smoothing options (all channels and per channel).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void oscCVWidget::appendSmoothingMenu(ui::Menu *menu, TSOSCCVOutputChannel* channels, int numChannels)
+{
+	if (channels == NULL || numChannels < 1)
+		return;
+	menu->addChild(new MenuLabel());
+	MenuLabel* modeLabel = new MenuLabel();
+	modeLabel->text = "Smoothing (OSC->CV)";
+	menu->addChild(modeLabel);
+	menu->addChild(new TSOscCVSmoothChannelItem("> All Channels", channels, numChannels));
+	for (int c = 0; c < numChannels; c++)
+	{
+		menu->addChild(new TSOscCVSmoothChannelItem("> Ch " + std::to_string(c + 1) + " (" + channels[c].getPath() + ")", &(channels[c]), 1));
+	}
+	return;
+} // end appendSmoothingMenu()
+
 
 // Show or hide the channel configuration
 void oscCVWidget::toggleChannelPathConfig(bool show)
@@ -734,7 +843,7 @@ void oscCVWidget::toggleChannelPathConfig(bool showInput, bool showOutput)
 	return;
 }
 // Read the channel path configs and store in module's channels.
-std::string oscCVWidget::readChannelPathConfig(TSOSCCVInputChannel* inputChannels, TSOSCCVChannel* outputChannels, int nChannels)
+std::string oscCVWidget::readChannelPathConfig(TSOSCCVInputChannel* inputChannels, TSOSCCVOutputChannel* outputChannels, int nChannels)
 {
 	std::string expanderName = std::string("");
 	if (tbExpanderID->visible)
@@ -791,7 +900,7 @@ void oscCVWidget::readChannelPathConfig(int index)
 } // end readChannelPathConfig()
 
 // Set the channel path text boxes.
-void oscCVWidget::setChannelPathConfig(TSOSCCVInputChannel* inputChannels, TSOSCCVChannel* outputChannels, int nChannels, std::string expanderName) 
+void oscCVWidget::setChannelPathConfig(TSOSCCVInputChannel* inputChannels, TSOSCCVOutputChannel* outputChannels, int nChannels, std::string expanderName) 
 {
 	if (inputChannels != NULL || outputChannels != NULL)
 	{
@@ -946,26 +1055,51 @@ void TSOscCVLabels::draw(/*in*/ const DrawArgs &args) {
 // Calculate scrolling and stuff?
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 void TSOscCVTopDisplay::step() {
-	bool connected = false;
 	bool isPreview = parentWidget->module == NULL;
-	std::string thisIp = std::string("NO CONNECTION ");
-	oscCV* thisModule = NULL;
-	if (!isPreview)
+	bool msgChanged = false;
+	if (isPreview)
+	{
+		if (scrollingMsgLen == 0)
+		{
+			snprintf(scrollingMsg, TROWA_SCROLLING_MSG_TOTAL_SIZE, "trowaSoft - cv<->OSC<->cv - %s", "NO CONNECTION");
+			msgChanged = true;
+		}
+	}
+	else
 	{
-		thisModule = dynamic_cast<oscCV*>(parentWidget->module);
-		connected = thisModule->oscInitialized;
-		if (connected)
+		oscCV* thisModule = dynamic_cast<oscCV*>(parentWidget->module);
+		bool connected = thisModule->oscInitialized;
+		// Only rebuild the message when something in it changes (compare, don't build strings every frame).
+		// The Tx counters change every send, so they are in the context menu instead of the marquee.
+		if (scrollingMsgLen == 0 || connected != lastConnected
+			|| (connected && (thisModule->currentOSCSettings.oscTxIpAddress.compare(lastIp) != 0
+				|| thisModule->currentOSCSettings.oscTxPort != lastTxPort || thisModule->currentOSCSettings.oscRxPort != lastRxPort
+				|| thisModule->oscNamespace.compare(lastNamespace) != 0)))
 		{
-			thisIp = thisModule->currentOSCSettings.oscTxIpAddress
-				+ std::string(" Tx:") + std::to_string(thisModule->currentOSCSettings.oscTxPort)
-				+ std::string(" Rx:") + std::to_string(thisModule->currentOSCSettings.oscRxPort);
-			if (!thisModule->oscNamespace.empty())
-			   thisIp = thisIp + ((thisModule->oscNamespace.at(0) == '/') ? " " : " /") + thisModule->oscNamespace + " ";				
+			if (connected)
+			{
+				lastIp = thisModule->currentOSCSettings.oscTxIpAddress;
+				lastTxPort = thisModule->currentOSCSettings.oscTxPort;
+				lastRxPort = thisModule->currentOSCSettings.oscRxPort;
+				lastNamespace = thisModule->oscNamespace;
+				const char* nsPrefix = (lastNamespace.empty()) ? "" : ((lastNamespace.at(0) == '/') ? " " : " /");
+				snprintf(scrollingMsg, TROWA_SCROLLING_MSG_TOTAL_SIZE, "trowaSoft - %s Tx:%d Rx:%d%s%s%s - cv<->OSC<->cv - ",
+					lastIp.c_str(), lastTxPort, lastRxPort, nsPrefix, lastNamespace.c_str(), (lastNamespace.empty()) ? "" : " ");
+			}
+			else
+			{
+				snprintf(scrollingMsg, TROWA_SCROLLING_MSG_TOTAL_SIZE, "trowaSoft - %s - cv<->OSC<->cv - ", "NO CONNECTION ");
+			}
+			lastConnected = connected;
+			msgChanged = true;
 		}
 	}
-	if (thisIp.compare(lastIp) != 0)
+	if (msgChanged)
 	{
-		sprintf(scrollingMsg, "trowaSoft - %s - cv<->OSC<->cv - ", thisIp.c_str());
+		scrollingMsgLen = static_cast<int>(strlen(scrollingMsg));
+		if (scrollIx >= scrollingMsgLen)
+			scrollIx = 0;
+		glyphsDirty = true;
 	}
 
 	//dt += engineGetSampleTime() / scrollTime_sec;
@@ -975,13 +1109,18 @@ void TSOscCVTopDisplay::step() {
 	{
 		//DEBUG("Dt has grown. Increment Ix: %d", scrollIx);
 		dt = 0.0f;
-		if (static_cast<size_t>(scrollIx) == strlen(scrollingMsg) - 1)
+		if (scrollIx >= scrollingMsgLen - 1)
 			scrollIx = 0;
 		else
 			scrollIx++;
 	}
 
-	lastIp = thisIp;
+	if (msgChanged || scrollIx != lastScrollIx || showDisplay != lastShowDisplay)
+	{
+		lastScrollIx = scrollIx;
+		lastShowDisplay = showDisplay;
+		TS_markCachedLayerDirty(this);
+	}
 	TransparentWidget::step(); // parent whatever he does
 	return;
 }
@@ -1027,26 +1166,28 @@ void TSOscCVTopDisplay::draw(/*in*/ const DrawArgs &args)
 	nvgFontSize(args.vg, fontSize * 1.5);	// Large font
 	//nvgFontFaceId(args.vg, font->handle);
 	nvgTextAlign(args.vg, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
-	
-	if (parentWidget->module == NULL)
-		sprintf(scrollingMsg, "trowaSoft - cv<->OSC<->cv - %s", "NO CONNECTION");
+
+	if (glyphsDirty)
+	{
+		// New message: measure the glyph offsets and total advance once.
+		NVGglyphPosition positions[TROWA_SCROLLING_MSG_TOTAL_SIZE];
+		numGlyphs = nvgTextGlyphPositions(args.vg, 0, 0, scrollingMsg, NULL, positions, TROWA_SCROLLING_MSG_TOTAL_SIZE);
+		for (int i = 0; i < numGlyphs; i++)
+			glyphX[i] = positions[i].x;
+		scrollingMsgWidth = nvgTextBounds(args.vg, 0, 0, scrollingMsg, NULL, NULL);
+		glyphsDirty = false;
+	}
 
 	// Start (left on screen) of scrolling message:
 	const char * subStr = scrollingMsg + scrollIx;
 	nvgText(args.vg, x, y, subStr, NULL);
-	// Get circular wrap (right part of screen) - start of message again:
-	float txtBounds[4] = { 0,0,0,0 };
-	float nextX = nvgTextBounds(args.vg, x, y, subStr, NULL, txtBounds);
-	x = nextX; // +24
+	// Get circular wrap (right part of screen) - start of message again.
+	// The advance of subStr is the message width less the offset of its first glyph.
+	x += scrollingMsgWidth - ((scrollIx < numGlyphs) ? glyphX[scrollIx] : 0.0f);
 	if (x < b.size.x) {
 		// Wrap the start of the string around
 		nvgText(args.vg, x, y, scrollingMsg, subStr);
 	}
-	//// Measures the specified text string. Parameter bounds should be a pointer to float[4],
-	//// if the bounding box of the text should be returned. The bounds value are [xmin,ymin, xmax,ymax]
-	//// Returns the horizontal advance of the measured text (i.e. where the next character should drawn).
-	//// Measured values are returned in local coordinate space.
-	//float nvgTextBounds(NVGcontext* ctx, float x, float y, const char* string, const char* end, float* bounds);
 	nvgResetScissor(args.vg);
 	return;
 } // end TSOscCVTopDisplay::draw()
@@ -1250,19 +1391,16 @@ void TSOscCVMiddleDisplay::drawChannelChart(/*in*/ const DrawArgs &args, /*in*/
 	/*in*/ int x, /*in*/ int y, /*in*/ int width, /*in*/ int height,
 	/*in*/ NVGcolor lineColor)
 {
+	// Points are recalculated (once per frame at most) when there is new data
+	const TSOSCCVValueHistory::ChartCache& chart = channelData->valHistory.updateChart(width, height, channelData->minVoltage, channelData->maxVoltage);
+	if (chart.numPoints < 1)
+		return;
 	nvgScissor(args.vg, x, y, width, height);
 	nvgBeginPath(args.vg);
-	float dx = static_cast<float>(width) / TROWA_OSCCV_VAL_BUFFER_SIZE;
-	//if (dx < 0.5)
-	//	dx = 0.5;
-	float px = x;
-	nvgMoveTo(args.vg, x, y);
-	float startY = y + height;
-	for (int i = 0; i < TROWA_OSCCV_VAL_BUFFER_SIZE; i++)
+	nvgMoveTo(args.vg, x + chart.xs[0], y + chart.ys[0]);
+	for (int i = 1; i < chart.numPoints; i++)
 	{
-		float py = startY - rescale(channelData->valBuffer[i], channelData->minVoltage, channelData->maxVoltage, 0, height);
-		nvgLineTo(args.vg, px, py);
-		px += dx;
+		nvgLineTo(args.vg, x + chart.xs[i], y + chart.ys[i]);
 	}
 	nvgStrokeColor(args.vg, lineColor);
 	nvgStrokeWidth(args.vg, 1.0);
@@ -1279,16 +1417,16 @@ void TSOscCVMiddleDisplay::drawChannelBar(/*in*/ const DrawArgs &args, /*in*/ TS
 	/*in*/ int x, /*in*/ int y, /*in*/ int width, /*in*/ int height,
 	/*in*/ NVGcolor lineColor)
 {
+	// Same points as the chart, but upside down
+	const TSOSCCVValueHistory::ChartCache& chart = channelData->valHistory.updateChart(width, height, channelData->minVoltage, channelData->maxVoltage);
+	if (chart.numPoints < 1)
+		return;
 	nvgScissor(args.vg, x, y, width, height);
 	nvgBeginPath(args.vg);
-	float dx = static_cast<float>(width) / TROWA_OSCCV_VAL_BUFFER_SIZE;
-	float px = x;
-	nvgMoveTo(args.vg, x, y);
-	for (int i = 0; i < TROWA_OSCCV_VAL_BUFFER_SIZE; i++)
+	nvgMoveTo(args.vg, x + chart.xs[0], y + height - chart.ys[0]);
+	for (int i = 1; i < chart.numPoints; i++)
 	{
-		float py = y + rescale(channelData->valBuffer[i], channelData->minVoltage, channelData->maxVoltage, 0, height);
-		nvgLineTo(args.vg, px, py);
-		px += dx;
+		nvgLineTo(args.vg, x + chart.xs[i], y + height - chart.ys[i]);
 	}
 	nvgStrokeColor(args.vg, lineColor);
 	nvgStrokeWidth(args.vg, 1.0);
@@ -1447,6 +1585,14 @@ TSOscCVChannelConfigScreen::TSOscCVChannelConfigScreen(oscCVWidget* widget, Vec
 	//TextBoxIx::NumTextBoxes
 	tbNumericBounds[TextBoxIx::NumTextBoxes - 1]->nextField = tbNumericBounds[0]; // Loop back around
 
+	// Send Rate (right column, across from the OSC values)
+	tbSendRate = new TSTextField(TSTextField::TextType::RealNumberOnly, 10);
+	tbSendRate->setRealPrecision(1);
+	tbSendRate->box.size = tbSize;
+	tbSendRate->box.pos = Vec(box.size.x - startX - 100, tbNumericBounds[TextBoxIx::MinOSCVal]->box.pos.y);
+	tbSendRate->visible = false;
+	addChild(tbSendRate);
+
 
 	//DEBUG("Starting btn select");
 	// Data Type
@@ -1571,6 +1717,20 @@ void TSOscCVChannelConfigScreen::draw(/*in*/ const DrawArgs &args)
 		nvgFontFaceId(args.vg, labelFont->handle);
 		nvgText(args.vg, x, y, "Data Type", NULL);
 
+		if (isInput)
+		{
+			// Send Rate (0 is the module timer)
+			x = tbSendRate->box.pos.x;
+			y = tbSendRate->box.pos.y - fontSize - 3;
+			nvgText(args.vg, x, y, "Send Rate (Hz)", NULL);
+			if (tbSendRateError.length() > 0)
+			{
+				nvgFillColor(args.vg, errorColor);
+				nvgText(args.vg, x, y + errorDy, tbSendRateError.c_str(), NULL);
+				nvgFillColor(args.vg, textColor);
+			}
+		}
+
 		this->OpaqueWidget::draw(args); // Parent
 	}
 	return;
@@ -1608,6 +1768,7 @@ void TSOscCVChannelConfigScreen::showControl(TSOSCCVChannel* channel, bool isInp
 		{
 			tbErrors[i] = std::string("");
 		}
+		tbSendRateError = std::string("");
 
 		// Text Box Values
 		char buffer[50] = { '\0' };
@@ -1650,6 +1811,14 @@ void TSOscCVChannelConfigScreen::showControl(TSOSCCVChannel* channel, bool isInp
 		}
 		} // end switch (data type)
 
+		// Send Rate
+		TSOSCCVInputChannel* inputChannel = (isInput) ? dynamic_cast<TSOSCCVInputChannel*>(currentChannelPtr) : NULL;
+		if (inputChannel != NULL)
+		{
+			sprintf(buffer, "%.1f", inputChannel->maxSendRate_Hz);
+			tbSendRate->text = std::string(buffer);
+		}
+
 		// Data Type
 		selectedDataType = currentChannelPtr->dataType;
 		this->btnSelectDataType->setSelectedValue(static_cast<int>(currentChannelPtr->dataType));
@@ -1705,6 +1874,27 @@ bool TSOscCVChannelConfigScreen::validateValues()
 		tbErrors[i] = (valid) ? std::string("") : std::string("Invalid value.");
 		isValid = isValid && valid;
 	}
+	tbSendRateError = std::string("");
+	if (isInput)
+	{
+		// Send Rate [0, TROWA_OSCCV_MAX_SEND_HZ]
+		bool valid = tbSendRate->isValid();
+		if (valid)
+		{
+			try
+			{
+				float rate = std::stof(tbSendRate->text, NULL);
+				valid = rate >= 0.0f && rate <= TROWA_OSCCV_MAX_SEND_HZ;
+			}
+			catch (const std::exception&)
+			{
+				valid = false;
+			}
+		}
+		if (!valid)
+			tbSendRateError = "0 to " + std::to_string(TROWA_OSCCV_MAX_SEND_HZ) + ".";
+		isValid = isValid && valid;
+	}
 	if (isValid)
 	{
 		//---------------------
@@ -1754,6 +1944,9 @@ bool TSOscCVChannelConfigScreen::saveValues(/*out*/ TSOSCCVChannel* channelPtr)
 			channelPtr->maxVoltage = std::stof(tbNumericBounds[TextBoxIx::MaxCVVolt]->text);
 			channelPtr->minOscVal = std::stof(tbNumericBounds[TextBoxIx::MinOSCVal]->text);
 			channelPtr->maxOscVal = std::stof(tbNumericBounds[TextBoxIx::MaxOSCVal]->text);
+			TSOSCCVInputChannel* inputChannel = (isInput) ? dynamic_cast<TSOSCCVInputChannel*>(channelPtr) : NULL;
+			if (inputChannel != NULL)
+				inputChannel->maxSendRate_Hz = std::stof(tbSendRate->text);
 			saved = true;
 		}
 		catch (const std::exception& e)
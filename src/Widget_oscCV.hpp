@@ -100,11 +100,15 @@ struct oscCVWidget : TSSModuleWidgetBase {
 	// Read the channel path configs and store in module's channels.
 	void readChannelPathConfig(int index);		
 	// Read the channel path configs and store in module's channels.
-	std::string readChannelPathConfig(TSOSCCVInputChannel* inputChannels, TSOSCCVChannel* outputChannels, int numChannels);	
+	std::string readChannelPathConfig(TSOSCCVInputChannel* inputChannels, TSOSCCVOutputChannel* outputChannels, int numChannels);	
 	// Set the channel path text boxes.
-	void setChannelPathConfig(TSOSCCVInputChannel* inputChannels, TSOSCCVChannel* outputChannels, int numChannels, std::string expanderName);
+	void setChannelPathConfig(TSOSCCVInputChannel* inputChannels, TSOSCCVOutputChannel* outputChannels, int numChannels, std::string expanderName);
 	// OnDragEnd - Revisit what expanders we may be connected to.
 	void onDragEnd(const event::DragEnd &e) override;
+	// Add max packet size options and the Tx counters to the context menu.
+	void appendContextMenu(ui::Menu *menu) override;
+	// Add the OSC->CV smoothing options (per channel) to a context menu.
+	static void appendSmoothingMenu(ui::Menu *menu, TSOSCCVOutputChannel* channels, int numChannels);
 	
 	// Calc color of an expander.
 	static NVGcolor calcColor(int index)
@@ -128,7 +132,221 @@ struct oscCVWidget : TSSModuleWidgetBase {
 };
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
-// Labels for oscCV widget.
+// Menu item to pick the max packet (datagram) size.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOscCVMaxPacketSizeItem : MenuItem {
+	oscCV* oscModule;
+	int packetSize;
+	TSOscCVMaxPacketSizeItem(std::string text, int packetSize, oscCV* oscModule)
+	{
+		this->text = text;
+		this->packetSize = packetSize;
+		this->oscModule = oscModule;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		oscModule->oscMaxPacketSize = packetSize;
+	}
+	void step() override {
+		rightText = CHECKMARK(oscModule->oscMaxPacketSize == packetSize);
+		MenuItem::step();
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Menu item to toggle the adaptive deadband on all CV->OSC channels.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOscCVAdaptiveDeadbandItem : MenuItem {
+	oscCV* oscModule;
+	void onAction(const event::Action &e) override {
+		TSOSCCVInputChannel* ch = &(oscModule->inputChannels[0]);
+		oscModule->setInputSendPolicy(!ch->adaptiveDeadband, ch->significantSendWithin_ms);
+	}
+	void step() override {
+		rightText = CHECKMARK(oscModule->inputChannels[0].adaptiveDeadband);
+		MenuItem::step();
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Menu item to pick how fast significant changes are sent on all CV->OSC channels.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOscCVSignificantSendItem : MenuItem {
+	oscCV* oscModule;
+	float sendWithin_ms;
+	TSOscCVSignificantSendItem(std::string text, float sendWithin_ms, oscCV* oscModule)
+	{
+		this->text = text;
+		this->sendWithin_ms = sendWithin_ms;
+		this->oscModule = oscModule;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		oscModule->setInputSendPolicy(oscModule->inputChannels[0].adaptiveDeadband, sendWithin_ms);
+	}
+	void step() override {
+		rightText = CHECKMARK(oscModule->inputChannels[0].significantSendWithin_ms == sendWithin_ms);
+		MenuItem::step();
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Menu item to pick the Rx jitter buffer (OSC->CV scheduling).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOscCVJitterBufferItem : MenuItem {
+	oscCV* oscModule;
+	float jitterBuffer_ms;
+	TSOscCVJitterBufferItem(std::string text, float jitterBuffer_ms, oscCV* oscModule)
+	{
+		this->text = text;
+		this->jitterBuffer_ms = jitterBuffer_ms;
+		this->oscModule = oscModule;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		oscModule->rxScheduler.jitterBuffer_ms = jitterBuffer_ms;
+	}
+	void step() override {
+		rightText = CHECKMARK(oscModule->rxScheduler.jitterBuffer_ms == jitterBuffer_ms);
+		MenuItem::step();
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Menu item to pick the smoothing mode of OSC->CV channel(s).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOscCVSmoothModeItem : MenuItem {
+	TSOSCCVOutputChannel* channels;
+	int numChannels;
+	TSOSCCVOutputChannel::SmoothMode smoothMode;
+	TSOscCVSmoothModeItem(std::string text, TSOSCCVOutputChannel::SmoothMode smoothMode, TSOSCCVOutputChannel* channels, int numChannels)
+	{
+		this->text = text;
+		this->smoothMode = smoothMode;
+		this->channels = channels;
+		this->numChannels = numChannels;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		for (int c = 0; c < numChannels; c++)
+			channels[c].smoothMode = smoothMode;
+	}
+	void step() override {
+		bool all = true;
+		for (int c = 0; c < numChannels && all; c++)
+			all = channels[c].smoothMode == smoothMode;
+		rightText = CHECKMARK(all);
+		MenuItem::step();
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Menu item to pick the slew time of OSC->CV channel(s).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOscCVSlewTimeItem : MenuItem {
+	TSOSCCVOutputChannel* channels;
+	int numChannels;
+	float slewTime_ms;
+	TSOscCVSlewTimeItem(std::string text, float slewTime_ms, TSOSCCVOutputChannel* channels, int numChannels)
+	{
+		this->text = text;
+		this->slewTime_ms = slewTime_ms;
+		this->channels = channels;
+		this->numChannels = numChannels;
+		return;
+	}
+	void onAction(const event::Action &e) override {
+		for (int c = 0; c < numChannels; c++)
+			channels[c].slewTime_ms = slewTime_ms;
+	}
+	void step() override {
+		bool all = true;
+		for (int c = 0; c < numChannels && all; c++)
+			all = channels[c].slewTime_ms == slewTime_ms;
+		rightText = CHECKMARK(all);
+		MenuItem::step();
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Menu item to toggle latest-value-only (mailbox) receive on OSC->CV channel(s).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOscCVLatestOnlyItem : MenuItem {
+	TSOSCCVOutputChannel* channels;
+	int numChannels;
+	TSOscCVLatestOnlyItem(std::string text, TSOSCCVOutputChannel* channels, int numChannels)
+	{
+		this->text = text;
+		this->channels = channels;
+		this->numChannels = numChannels;
+		return;
+	}
+	bool allLatestOnly()
+	{
+		bool all = true;
+		for (int c = 0; c < numChannels && all; c++)
+			all = channels[c].rxLatestOnly;
+		return all;
+	}
+	void onAction(const event::Action &e) override {
+		bool latestOnly = !allLatestOnly();
+		for (int c = 0; c < numChannels; c++)
+			channels[c].rxLatestOnly = latestOnly;
+	}
+	void step() override {
+		rightText = CHECKMARK(allLatestOnly());
+		MenuItem::step();
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Sub menu with the smoothing options for OSC->CV channel(s).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOscCVSmoothChannelItem : MenuItem {
+	TSOSCCVOutputChannel* channels;
+	int numChannels;
+	TSOscCVSmoothChannelItem(std::string text, TSOSCCVOutputChannel* channels, int numChannels)
+	{
+		this->text = text;
+		this->rightText = RIGHT_ARROW;
+		this->channels = channels;
+		this->numChannels = numChannels;
+		return;
+	}
+	Menu *createChildMenu() override {
+		Menu* menu = new Menu();
+		menu->addChild(new TSOscCVSmoothModeItem("Step (None)", TSOSCCVOutputChannel::SmoothMode::SmoothNone, channels, numChannels));
+		menu->addChild(new TSOscCVSmoothModeItem("Linear", TSOSCCVOutputChannel::SmoothMode::SmoothLinear, channels, numChannels));
+		menu->addChild(new TSOscCVSmoothModeItem("Cubic", TSOSCCVOutputChannel::SmoothMode::SmoothCubic, channels, numChannels));
+		menu->addChild(new TSOscCVSmoothModeItem("Slew", TSOSCCVOutputChannel::SmoothMode::SmoothSlew, channels, numChannels));
+		MenuLabel* label = new MenuLabel();
+		label->text = "Slew Time";
+		menu->addChild(label);
+		menu->addChild(new TSOscCVSlewTimeItem("Auto (From Rx Rate)", 0.0f, channels, numChannels));
+		menu->addChild(new TSOscCVSlewTimeItem("5 ms", 5.0f, channels, numChannels));
+		menu->addChild(new TSOscCVSlewTimeItem("20 ms", 20.0f, channels, numChannels));
+		menu->addChild(new TSOscCVSlewTimeItem("50 ms", 50.0f, channels, numChannels));
+		menu->addChild(new TSOscCVSlewTimeItem("100 ms", 100.0f, channels, numChannels));
+		label = new MenuLabel();
+		label->text = "Receive";
+		menu->addChild(label);
+		menu->addChild(new TSOscCVLatestOnlyItem("Latest Value Only (Not Bool)", channels, numChannels));
+		return menu;
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Menu item to reset the Tx counters.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct TSOscCVResetTxCountersItem : MenuItem {
+	oscCV* oscModule;
+	void onAction(const event::Action &e) override {
+		oscModule->resetTxCounters();
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Labels for oscCV widget (static, drawn in a cached layer).
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 struct TSOscCVLabels : TransparentWidget {
 	std::shared_ptr<Font> font;
@@ -261,6 +479,9 @@ struct TSOscCVChannelConfigScreen : OpaqueWidget {
 	// The text boxes for min/max values.
 	TSTextField* tbNumericBounds[TextBoxIx::NumTextBoxes];
 	std::string tbErrors[TextBoxIx::NumTextBoxes];
+	// Send rate (Hz) text box (input channels only).
+	TSTextField* tbSendRate = NULL;
+	std::string tbSendRateError;
 
 	const int numDataTypes = 3;
 	TSOSCCVChannel::ArgDataType oscDataTypeVals[3] = { TSOSCCVChannel::ArgDataType::OscFloat, TSOSCCVChannel::ArgDataType::OscInt, TSOSCCVChannel::ArgDataType::OscBool };
@@ -338,6 +559,7 @@ struct TSOscCVChannelConfigScreen : OpaqueWidget {
 			{
 				tbNumericBounds[i]->visible = visible;
 			}
+			tbSendRate->visible = visible && isInput;
 		}
 		catch (const std::exception& e)
 		{
@@ -417,9 +639,27 @@ struct TSOscCVTopDisplay : TransparentWidget {
 	bool showDisplay = true;
 	char scrollingMsg[TROWA_SCROLLING_MSG_TOTAL_SIZE];
 	int scrollIx = 0;
+	// Length of the scrolling message.
+	int scrollingMsgLen = 0;
+	// Connection shown in the message (only rebuilt when something changes).
+	bool lastConnected = false;
 	std::string lastIp = std::string("");
+	int lastTxPort = -1;
+	int lastRxPort = -1;
+	std::string lastNamespace = std::string("");
 	float dt = 0.0f;
 	float scrollTime_sec = 0.05f;
+	// Glyph x offsets of the scrolling message (measured once per message, not every frame).
+	float glyphX[TROWA_SCROLLING_MSG_TOTAL_SIZE];
+	// Number of valid glyphX.
+	int numGlyphs = 0;
+	// Total advance of the scrolling message.
+	float scrollingMsgWidth = 0.0f;
+	// The message changed (re-measure the glyphs).
+	bool glyphsDirty = true;
+	// What we last drew. We are drawn in a cached layer, only redrawn when this changes.
+	int lastScrollIx = -1;
+	bool lastShowDisplay = true;
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// TSOscCVTopDisplay(void)
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -441,12 +681,14 @@ struct TSOscCVTopDisplay : TransparentWidget {
 		fontSize = 12;
 		memset(messageStr, '\0', sizeof(char)*TROWA_DISP_MSG_SIZE);
 		memset(scrollingMsg, '\0', sizeof(char)*TROWA_SCROLLING_MSG_TOTAL_SIZE);
+		memset(glyphX, 0, sizeof(float)*TROWA_SCROLLING_MSG_TOTAL_SIZE);
 		showDisplay = true;
 		return;
 	}
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	// step()
-	// Calculate scrolling and stuff?
+	// Calculate scrolling and stuff. Marks our cached layer dirty when the
+	// message or scroll position changes.
 	//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 	void step() override;
 
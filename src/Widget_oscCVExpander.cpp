@@ -1,5 +1,6 @@
 
 #include "Widget_oscCVExpander.hpp"
+#include "Widget_oscCV.hpp"
 using namespace rack;
 #include "trowaSoft.hpp"
 #include "trowaSoftComponents.hpp"
@@ -62,7 +63,7 @@ oscCVExpanderWidget::oscCVExpanderWidget(oscCVExpander* oscExpanderModule, TSOSC
 	TSOscCVExpanderLabels* labelArea = new TSOscCVExpanderLabels(this->expanderType);
 	labelArea->box.pos = Vec(TROWA_HORIZ_MARGIN, topScreenSize.y + 24);
 	labelArea->box.size = Vec(box.size.x - TROWA_HORIZ_MARGIN * 2, box.size.y - labelArea->box.pos.y - 15);
-	addChild(labelArea);
+	addChild(TS_createCachedLayer(labelArea)); // Static
 
 
 	//////////////////////////////////////////////
@@ -269,6 +270,19 @@ void oscCVExpanderWidget::onDragEnd(const event::DragEnd &e)
 	return;
 } // end onDragEnd()
 
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// appendContextMenu()
+// Add the OSC->CV smoothing options (output expanders).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+void oscCVExpanderWidget::appendContextMenu(ui::Menu *menu)
+{
+	oscCVExpander* thisModule = dynamic_cast<oscCVExpander*>(this->module);
+	if (thisModule == NULL || thisModule->expanderType != TSOSCCVExpanderDirection::Output)
+		return;
+	oscCVWidget::appendSmoothingMenu(menu, thisModule->outputChannels, thisModule->numberChannels);
+	return;
+} // end appendContextMenu()
+
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
 // draw()
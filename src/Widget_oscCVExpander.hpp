@@ -54,7 +54,8 @@ struct oscCVExpanderWidget : TSSModuleWidgetBase {
 	// Step
 	void step() override;		
 	void onDragEnd(const event::DragEnd &e) override;
-
+	// Add the OSC->CV smoothing options to the context menu (output expanders).
+	void appendContextMenu(ui::Menu *menu) override;
 };
 
 //-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
@@ -1820,6 +1820,32 @@ struct TS_ColorSlider : Knob {
 }; // end TS_ColorSlider
 
 //:::-:::-:::-:::- Helpers -:::-:::-:::-:::
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TS_createCachedLayer()
+// Put a widget in a framebuffer so its drawing is cached (redrawn only when the
+// framebuffer is dirty or the zoom changes). For static labels and displays whose
+// text rarely changes (they call TS_markCachedLayerDirty() when it does).
+// @widget : (IN) Widget with its box set. Its position moves to the framebuffer.
+// @returns : The framebuffer to add to the parent (instead of the widget).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+inline FramebufferWidget* TS_createCachedLayer(Widget* widget) {
+	FramebufferWidget* fb = new FramebufferWidget();
+	fb->box = widget->box;
+	widget->box.pos = Vec(0, 0);
+	fb->addChild(widget);
+	return fb;
+}
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// TS_markCachedLayerDirty()
+// Redraw the framebuffer a widget is cached in (if it is in one).
+// @widget : (IN) Widget inside a TS_createCachedLayer() framebuffer.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+inline void TS_markCachedLayerDirty(Widget* widget) {
+	FramebufferWidget* fb = widget->getAncestorOfType<FramebufferWidget>();
+	if (fb != NULL)
+		fb->dirty = true;
+	return;
+}
 template <class TModuleLightWidget>
 ColorValueLight * TS_createColorValueLight(Vec pos,  Module *module, int lightId, Vec size, NVGcolor lightColor) {
 	ColorValueLight *light = new TModuleLightWidget();
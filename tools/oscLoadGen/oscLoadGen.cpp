@@ -0,0 +1,617 @@
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// oscLoadGen
+// Stand-alone OSC load generator and end-to-end latency tester for cvOSCcv and
+// the OSC sequencers. Sends synthesized (or replayed) OSC traffic to a port and
+// listens for the echoed output, then reports throughput, loss and latency.
+//
+// cvOSCcv latency: set cvOSCcv's Rx port to --port and Tx port to --listen, and
+// patch each output CV jack to the matching input CV jack. Every sent value is
+// unique (per channel) for a while, so echoes are matched back to what was sent.
+//
+// Build: make (in this folder). Run with --help for options.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+#include "../../lib/oscpack/osc/OscOutboundPacketStream.h"
+#include "../../lib/oscpack/osc/OscReceivedElements.h"
+#include "../../lib/oscpack/osc/OscPacketListener.h"
+#include "../../lib/oscpack/ip/UdpSocket.h"
+
+#define LOADGEN_BUFFER_SIZE		(1024*64) // Max datagram we build.
+#define LOADGEN_VALUE_STEPS			2000 // Number of unique values per channel (-10.00 to +9.99 V in 0.01 V steps).
+#define LOADGEN_VALUE_TOLERANCE	   0.004f // How close an echoed value must be to match.
+#define LOADGEN_MAX_PENDING			4096 // Max values per channel waiting for an echo.
+#define LOADGEN_GRACE_TIME_S		 0.5 // Time to keep listening after we are done sending.
+
+typedef std::chrono::steady_clock LoadGenClock;
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Command line options.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct LoadGenOptions {
+	enum Mode {
+		// cvOSCcv channel paths (<ns>/ch/<n>)
+		ModeCV,
+		// Sequencer OSC_* paths (<ns>/play/bpm, <ns>/edit/step, ...)
+		ModeSeq,
+		// Replay a file
+		ModeReplay,
+		// Just echo everything we get on --port back to --host:--listen (self test without Rack).
+		ModeEcho
+	};
+	Mode mode = Mode::ModeCV;
+	std::string host = "127.0.0.1";
+	int port = 7001; // Where we send (module Rx port)
+	int listenPort = 7000; // Where we listen (module Tx port)
+	std::string oscNamespace = ""; // cvOSCcv default is blank, sequencers are /tsseq
+	double rate = 100.0; // Messages per second
+	double duration = 10.0; // Seconds
+	int bundleSize = 0; // Messages per bundle (0 for plain messages)
+	int polyWidth = 1; // Args per message
+	int numChannels = 8; // Number of addresses to cycle through
+	int timeTagAhead_ms = -1; // If >= 0, bundles get a time tag of now + this (else 'immediate').
+	std::string replayFile;
+	bool quiet = false;
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Sequencer paths (see TSOSCSequencerListener.hpp) and a reasonable arg for each.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct SeqPathInfo {
+	const char* path;
+	// 'f' float, 'i' int
+	char argType;
+	float minVal;
+	float maxVal;
+};
+static const SeqPathInfo SEQ_PATHS[] = {
+	{ "/play/bpm", 'i', 60, 180 },
+	{ "/play/tempo", 'f', 0, 1 },
+	{ "/play/len", 'i', 1, 16 },
+	{ "/play/pat", 'i', 1, 64 },
+	{ "/edit/pat", 'i', 1, 64 },
+	{ "/edit/ch", 'i', 1, 16 },
+	{ "/edit/step/1", 'f', 0, 1 },
+	{ "/edit/step/5", 'f', 0, 1 },
+	{ "/edit/step/9", 'f', 0, 1 },
+	{ "/edit/step/13", 'f', 0, 1 },
+	{ "/play/step", 'i', 1, 16 }
+};
+static const int NUM_SEQ_PATHS = sizeof(SEQ_PATHS) / sizeof(SEQ_PATHS[0]);
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// A line from a replay file: <time_s> <address> [<float arg> ...]
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct ReplayMessage {
+	double time;
+	std::string address;
+	std::vector<float> args;
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Statistics (shared by the send and receive threads).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct LoadGenStats {
+	struct PendingValue {
+		float value;
+		LoadGenClock::time_point sendTime;
+	};
+	std::mutex mutex;
+	// Per channel values waiting for an echo.
+	std::vector<std::deque<PendingValue>> pending;
+	// Latencies (ms) of matched echoes.
+	std::vector<double> latencies_ms;
+	std::atomic<uint64_t> sentMessages { 0 };
+	std::atomic<uint64_t> sentPackets { 0 };
+	std::atomic<uint64_t> sentBytes { 0 };
+	std::atomic<uint64_t> receivedMessages { 0 };
+	std::atomic<uint64_t> receivedPackets { 0 };
+	std::atomic<uint64_t> receivedBytes { 0 };
+	std::atomic<uint64_t> unmatchedMessages { 0 };
+	std::atomic<uint64_t> expectedEchoes { 0 };
+	// Values that were replaced before they could be echoed (module only sends the latest value).
+	std::atomic<uint64_t> supersededValues { 0 };
+
+	LoadGenStats(int numChannels)
+	{
+		pending.resize(numChannels);
+		return;
+	}
+	// A value was sent on a channel.
+	void onSent(int chIx, float value, LoadGenClock::time_point t)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::deque<PendingValue>& q = pending[chIx];
+		if (q.size() >= LOADGEN_MAX_PENDING)
+			q.pop_front();
+		PendingValue v;
+		v.value = value;
+		v.sendTime = t;
+		q.push_back(v);
+		expectedEchoes++;
+		return;
+	}
+	// An echo came back.
+	void onEcho(int chIx, float value, LoadGenClock::time_point t)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (chIx < 0 || chIx >= static_cast<int>(pending.size()))
+		{
+			unmatchedMessages++;
+			return;
+		}
+		std::deque<PendingValue>& q = pending[chIx];
+		for (size_t i = 0; i < q.size(); i++)
+		{
+			if (std::fabs(q[i].value - value) <= LOADGEN_VALUE_TOLERANCE)
+			{
+				latencies_ms.push_back(std::chrono::duration<double, std::milli>(t - q[i].sendTime).count());
+				// Anything sent before this was replaced by a newer value on this channel.
+				supersededValues += i;
+				q.erase(q.begin(), q.begin() + i + 1);
+				return;
+			}
+		}
+		unmatchedMessages++;
+		return;
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Listens for the echoed output.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct LoadGenListener : public osc::OscPacketListener {
+	LoadGenStats* stats;
+	bool matchChannels;
+	LoadGenListener(LoadGenStats* stats, bool matchChannels) : stats(stats), matchChannels(matchChannels)
+	{
+		return;
+	}
+	void ProcessPacket(const char* data, int size, const IpEndpointName& remoteEndpoint) override
+	{
+		stats->receivedPackets++;
+		stats->receivedBytes += size;
+		osc::OscPacketListener::ProcessPacket(data, size, remoteEndpoint);
+		return;
+	}
+	void ProcessMessage(const osc::ReceivedMessage& rxMsg, const IpEndpointName& remoteEndpoint) override
+	{
+		LoadGenClock::time_point now = LoadGenClock::now();
+		stats->receivedMessages++;
+		if (!matchChannels)
+			return;
+		try
+		{
+			// .../ch/<n>
+			const char* path = rxMsg.AddressPattern();
+			const char* chStr = strstr(path, "/ch/");
+			if (chStr == NULL || rxMsg.ArgumentCount() < 1)
+			{
+				stats->unmatchedMessages++;
+				return;
+			}
+			int chIx = atoi(chStr + 4) - 1;
+			osc::ReceivedMessage::const_iterator arg = rxMsg.ArgumentsBegin();
+			float val = (arg->IsFloat()) ? arg->AsFloat() : static_cast<float>(arg->AsInt32());
+			stats->onEcho(chIx, val, now);
+		}
+		catch (osc::Exception& ex)
+		{
+			stats->unmatchedMessages++;
+		}
+		return;
+	}
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Echoes everything back (self test).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct EchoListener : public PacketListener {
+	UdpTransmitSocket* txSocket;
+	uint64_t count = 0;
+	EchoListener(UdpTransmitSocket* txSocket) : txSocket(txSocket)
+	{
+		return;
+	}
+	void ProcessPacket(const char* data, int size, const IpEndpointName& remoteEndpoint) override
+	{
+		txSocket->Send(data, size);
+		count++;
+		return;
+	}
+};
+
+//--------------------------------------------------------
+// getChannelValue()
+// @seq : (IN) Sequence number of the value on this channel.
+// @returns : A value that is unique for LOADGEN_VALUE_STEPS sends and is a valid voltage (-10 to +9.99).
+//--------------------------------------------------------
+static float getChannelValue(uint64_t seq)
+{
+	return (static_cast<int>(seq % LOADGEN_VALUE_STEPS) - LOADGEN_VALUE_STEPS / 2) * 0.01f;
+}
+
+//--------------------------------------------------------
+// getTimeTag()
+// @ahead_ms : (IN) Time from now (ms). Negative for 'immediate'.
+// @returns : OSC (NTP) time tag.
+//--------------------------------------------------------
+static osc::uint64 getTimeTag(int ahead_ms)
+{
+	if (ahead_ms < 0)
+		return 1; // Immediate
+	const uint64_t NTP_UNIX_OFFSET = 2208988800ULL;
+	double t = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count() + ahead_ms * 0.001;
+	uint64_t secs = static_cast<uint64_t>(t);
+	uint64_t frac = static_cast<uint64_t>((t - secs) * 4294967296.0);
+	return ((secs + NTP_UNIX_OFFSET) << 32) | (frac & 0xFFFFFFFF);
+}
+
+//--------------------------------------------------------
+// loadReplayFile()
+// @fileName : (IN) Text file, one message per line: <time_s> <address> [<float arg> ...]. '#' for comments.
+// @messages : (OUT) The messages (sorted by time).
+// @returns : True if loaded.
+//--------------------------------------------------------
+static bool loadReplayFile(const std::string& fileName, std::vector<ReplayMessage>& messages)
+{
+	std::ifstream file(fileName);
+	if (!file.is_open())
+		return false;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream ss(line);
+		ReplayMessage msg;
+		if (!(ss >> msg.time >> msg.address))
+			continue;
+		float v;
+		while (ss >> v)
+			msg.args.push_back(v);
+		messages.push_back(msg);
+	}
+	std::stable_sort(messages.begin(), messages.end(), [](const ReplayMessage& a, const ReplayMessage& b) { return a.time < b.time; });
+	return true;
+}
+
+//--------------------------------------------------------
+// printUsage()
+//--------------------------------------------------------
+static void printUsage(const char* exeName)
+{
+	printf("Usage: %s [options]\n", exeName);
+	printf("  --mode cv|seq|replay|echo  Traffic to send (default cv). 'echo' just echoes --port back to --listen.\n");
+	printf("  --host <ip>                Where to send (default 127.0.0.1).\n");
+	printf("  --port <n>                 Port to send to, the module's Rx port (default 7001).\n");
+	printf("  --listen <n>               Port to listen on, the module's Tx port (default 7000). 0 to not listen.\n");
+	printf("  --ns <namespace>           OSC namespace, e.g. /tsseq (default blank).\n");
+	printf("  --rate <msgs/s>            Messages per second (default 100).\n");
+	printf("  --duration <s>             How long to send (default 10).\n");
+	printf("  --bundle <n>               Messages per bundle, 0 for no bundles (default 0).\n");
+	printf("  --poly <n>                 Args per message, 1-16 (default 1).\n");
+	printf("  --channels <n>             Number of addresses to cycle through (default 8).\n");
+	printf("  --timetag <ms>             Time tag bundles this far ahead (default 'immediate').\n");
+	printf("  --replay <file>            Replay a file (<time_s> <address> [<args>...] per line).\n");
+	printf("  --quiet                    Only print the summary.\n");
+	return;
+}
+
+//--------------------------------------------------------
+// parseArgs()
+// @returns : True if ok.
+//--------------------------------------------------------
+static bool parseArgs(int argc, char* argv[], LoadGenOptions& opts)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasVal = i + 1 < argc;
+		if (arg == "--help" || arg == "-h")
+			return false;
+		else if (arg == "--quiet")
+			opts.quiet = true;
+		else if (!hasVal)
+		{
+			fprintf(stderr, "Missing value for %s.\n", arg.c_str());
+			return false;
+		}
+		else if (arg == "--mode")
+		{
+			std::string m = argv[++i];
+			if (m == "cv")
+				opts.mode = LoadGenOptions::ModeCV;
+			else if (m == "seq")
+				opts.mode = LoadGenOptions::ModeSeq;
+			else if (m == "replay")
+				opts.mode = LoadGenOptions::ModeReplay;
+			else if (m == "echo")
+				opts.mode = LoadGenOptions::ModeEcho;
+			else
+			{
+				fprintf(stderr, "Unknown mode %s.\n", m.c_str());
+				return false;
+			}
+		}
+		else if (arg == "--host")
+			opts.host = argv[++i];
+		else if (arg == "--port")
+			opts.port = atoi(argv[++i]);
+		else if (arg == "--listen")
+			opts.listenPort = atoi(argv[++i]);
+		else if (arg == "--ns")
+			opts.oscNamespace = argv[++i];
+		else if (arg == "--rate")
+			opts.rate = atof(argv[++i]);
+		else if (arg == "--duration")
+			opts.duration = atof(argv[++i]);
+		else if (arg == "--bundle")
+			opts.bundleSize = atoi(argv[++i]);
+		else if (arg == "--poly")
+			opts.polyWidth = atoi(argv[++i]);
+		else if (arg == "--channels")
+			opts.numChannels = atoi(argv[++i]);
+		else if (arg == "--timetag")
+			opts.timeTagAhead_ms = atoi(argv[++i]);
+		else if (arg == "--replay")
+		{
+			opts.replayFile = argv[++i];
+			opts.mode = LoadGenOptions::ModeReplay;
+		}
+		else
+		{
+			fprintf(stderr, "Unknown option %s.\n", arg.c_str());
+			return false;
+		}
+	}
+	if (!opts.oscNamespace.empty() && opts.oscNamespace[0] != '/')
+		opts.oscNamespace = "/" + opts.oscNamespace;
+	opts.polyWidth = std::min(std::max(opts.polyWidth, 1), 16);
+	opts.numChannels = std::max(opts.numChannels, 1);
+	opts.bundleSize = std::max(opts.bundleSize, 0);
+	if (opts.rate <= 0)
+		opts.rate = 1;
+	return true;
+}
+
+//--------------------------------------------------------
+// percentile()
+// @sorted : (IN) Sorted values.
+// @p : (IN) Percentile (0-100).
+//--------------------------------------------------------
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0.0;
+	size_t ix = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+	ix = std::min(std::max(ix, static_cast<size_t>(1)), sorted.size());
+	return sorted[ix - 1];
+}
+
+//--------------------------------------------------------
+// runEcho()
+// Echo --port back to --host:--listen until killed.
+//--------------------------------------------------------
+static int runEcho(const LoadGenOptions& opts)
+{
+	UdpTransmitSocket txSocket(IpEndpointName(opts.host.c_str(), opts.listenPort));
+	EchoListener listener(&txSocket);
+	UdpListeningReceiveSocket rxSocket(IpEndpointName(IpEndpointName::ANY_ADDRESS, opts.port), &listener);
+	printf("Echoing port %d to %s:%d. Ctrl-C to stop.\n", opts.port, opts.host.c_str(), opts.listenPort);
+	rxSocket.Run();
+	return 0;
+}
+
+//--------------------------------------------------------
+// main()
+//--------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	LoadGenOptions opts;
+	if (!parseArgs(argc, argv, opts))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+	try
+	{
+		if (opts.mode == LoadGenOptions::ModeEcho)
+			return runEcho(opts);
+
+		std::vector<ReplayMessage> replay;
+		if (opts.mode == LoadGenOptions::ModeReplay)
+		{
+			if (!loadReplayFile(opts.replayFile, replay) || replay.empty())
+			{
+				fprintf(stderr, "Could not load any messages from '%s'.\n", opts.replayFile.c_str());
+				return 1;
+			}
+			opts.duration = replay.back().time;
+		}
+
+		// Addresses
+		std::vector<std::string> addresses;
+		int numAddresses = (opts.mode == LoadGenOptions::ModeSeq) ? NUM_SEQ_PATHS : opts.numChannels;
+		for (int i = 0; i < numAddresses; i++)
+		{
+			if (opts.mode == LoadGenOptions::ModeSeq)
+				addresses.push_back(opts.oscNamespace + SEQ_PATHS[i].path);
+			else
+				addresses.push_back(opts.oscNamespace + "/ch/" + std::to_string(i + 1));
+		}
+
+		bool matchEchoes = opts.mode == LoadGenOptions::ModeCV;
+		LoadGenStats stats(opts.numChannels);
+		LoadGenListener listener(&stats, matchEchoes);
+		UdpListeningReceiveSocket* rxSocket = NULL;
+		std::thread rxThread;
+		if (opts.listenPort > 0)
+		{
+			rxSocket = new UdpListeningReceiveSocket(IpEndpointName(IpEndpointName::ANY_ADDRESS, opts.listenPort), &listener);
+			rxThread = std::thread(&UdpListeningReceiveSocket::Run, rxSocket);
+		}
+		UdpTransmitSocket txSocket(IpEndpointName(opts.host.c_str(), opts.port));
+
+		if (!opts.quiet)
+		{
+			printf("Sending to %s:%d, listening on %d. %.1f msgs/s for %.1f s, bundle %d, poly %d, %d addresses.\n",
+				opts.host.c_str(), opts.port, opts.listenPort, opts.rate, opts.duration, opts.bundleSize, opts.polyWidth, numAddresses);
+		}
+
+		// Send
+		std::vector<char> buffer(LOADGEN_BUFFER_SIZE);
+		std::vector<uint64_t> channelSeq(numAddresses, 0);
+		std::vector<std::pair<int, float>> bundleValues; // What was in the bundle (channel, value) for matching.
+		osc::OutboundPacketStream oscStream(buffer.data(), buffer.size());
+		LoadGenClock::time_point start = LoadGenClock::now();
+		uint64_t msgIx = 0;
+		size_t replayIx = 0;
+		int inBundle = 0;
+		double nextReport = 1.0;
+		uint32_t rng = 12345;
+		while (true)
+		{
+			// When is the next message due?
+			double msgTime = (opts.mode == LoadGenOptions::ModeReplay) ? replay[replayIx].time : msgIx / opts.rate;
+			if (msgTime > opts.duration || (opts.mode == LoadGenOptions::ModeReplay && replayIx >= replay.size()))
+				break;
+			std::this_thread::sleep_until(start + std::chrono::duration_cast<LoadGenClock::duration>(std::chrono::duration<double>(msgTime)));
+
+			if (inBundle == 0)
+			{
+				oscStream.Clear();
+				bundleValues.clear();
+				if (opts.bundleSize > 0)
+					oscStream << osc::BeginBundle(getTimeTag(opts.timeTagAhead_ms));
+			}
+			// Build the message
+			int chIx = static_cast<int>(msgIx % numAddresses);
+			if (opts.mode == LoadGenOptions::ModeReplay)
+			{
+				oscStream << osc::BeginMessage(replay[replayIx].address.c_str());
+				for (size_t a = 0; a < replay[replayIx].args.size(); a++)
+					oscStream << replay[replayIx].args[a];
+				oscStream << osc::EndMessage;
+				replayIx++;
+			}
+			else if (opts.mode == LoadGenOptions::ModeSeq)
+			{
+				const SeqPathInfo& info = SEQ_PATHS[chIx];
+				oscStream << osc::BeginMessage(addresses[chIx].c_str());
+				for (int a = 0; a < opts.polyWidth; a++)
+				{
+					rng = rng * 1664525u + 1013904223u;
+					float v = info.minVal + (info.maxVal - info.minVal) * ((rng >> 8) / 16777216.0f);
+					if (info.argType == 'i')
+						oscStream << static_cast<osc::int32>(v);
+					else
+						oscStream << v;
+				}
+				oscStream << osc::EndMessage;
+			}
+			else
+			{
+				// Unique value on this channel (poly voices get the same value so the echo can be matched from voice 1).
+				float v = getChannelValue(channelSeq[chIx]++);
+				oscStream << osc::BeginMessage(addresses[chIx].c_str());
+				for (int a = 0; a < opts.polyWidth; a++)
+					oscStream << v;
+				oscStream << osc::EndMessage;
+				bundleValues.push_back(std::make_pair(chIx, v));
+			}
+			msgIx++;
+			stats.sentMessages++;
+			inBundle++;
+
+			// Send when the bundle is full (or no bundles)
+			if (opts.bundleSize < 1 || inBundle >= opts.bundleSize)
+			{
+				if (opts.bundleSize > 0)
+					oscStream << osc::EndBundle;
+				// Register before sending so a fast echo can't beat us
+				LoadGenClock::time_point now = LoadGenClock::now();
+				for (size_t i = 0; i < bundleValues.size(); i++)
+					stats.onSent(bundleValues[i].first, bundleValues[i].second, now);
+				txSocket.Send(oscStream.Data(), oscStream.Size());
+				stats.sentPackets++;
+				stats.sentBytes += oscStream.Size();
+				inBundle = 0;
+			}
+			if (!opts.quiet && msgTime >= nextReport)
+			{
+				printf("  %5.1f s: sent %llu, received %llu\n", msgTime, static_cast<unsigned long long>(stats.sentMessages), static_cast<unsigned long long>(stats.receivedMessages));
+				nextReport += 1.0;
+			}
+		} // end while
+		if (inBundle > 0)
+		{
+			// Partial bundle
+			if (opts.bundleSize > 0)
+				oscStream << osc::EndBundle;
+			LoadGenClock::time_point now = LoadGenClock::now();
+			for (size_t i = 0; i < bundleValues.size(); i++)
+				stats.onSent(bundleValues[i].first, bundleValues[i].second, now);
+			txSocket.Send(oscStream.Data(), oscStream.Size());
+			stats.sentPackets++;
+			stats.sentBytes += oscStream.Size();
+		}
+		double sendTime = std::chrono::duration<double>(LoadGenClock::now() - start).count();
+
+		// Wait for stragglers
+		if (rxSocket != NULL)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(LOADGEN_GRACE_TIME_S + std::max(opts.timeTagAhead_ms, 0) * 0.001));
+			rxSocket->AsynchronousBreak();
+			rxThread.join();
+			delete rxSocket;
+			rxSocket = NULL;
+		}
+
+		// Report
+		printf("Sent:     %llu msgs in %llu packets (%.1f KB) in %.2f s = %.1f msgs/s\n",
+			static_cast<unsigned long long>(stats.sentMessages), static_cast<unsigned long long>(stats.sentPackets),
+			stats.sentBytes / 1024.0, sendTime, (sendTime > 0) ? stats.sentMessages / sendTime : 0.0);
+		printf("Received: %llu msgs in %llu packets (%.1f KB)\n",
+			static_cast<unsigned long long>(stats.receivedMessages), static_cast<unsigned long long>(stats.receivedPackets), stats.receivedBytes / 1024.0);
+		if (matchEchoes && opts.listenPort > 0)
+		{
+			std::lock_guard<std::mutex> lock(stats.mutex);
+			uint64_t matched = stats.latencies_ms.size();
+			uint64_t expected = stats.expectedEchoes;
+			uint64_t lost = 0;
+			for (size_t c = 0; c < stats.pending.size(); c++)
+				lost += stats.pending[c].size();
+			printf("Echoes:   %llu matched, %llu superseded (newer value sent first), %llu lost (%.2f%%), %llu unmatched\n",
+				static_cast<unsigned long long>(matched), static_cast<unsigned long long>(stats.supersededValues),
+				static_cast<unsigned long long>(lost), (expected > 0) ? 100.0 * lost / expected : 0.0,
+				static_cast<unsigned long long>(stats.unmatchedMessages));
+			std::vector<double> sorted = stats.latencies_ms;
+			std::sort(sorted.begin(), sorted.end());
+			if (!sorted.empty())
+			{
+				printf("Latency:  p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, p99.9 %.3f ms, max %.3f ms\n",
+					percentile(sorted, 50), percentile(sorted, 90), percentile(sorted, 99), percentile(sorted, 99.9), sorted.back());
+			}
+		}
+	}
+	catch (std::exception& ex)
+	{
+		fprintf(stderr, "Error: %s\n", ex.what());
+		return 1;
+	}
+	return 0;
+} // end main()
@@ -0,0 +1,303 @@
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// tsrtcheck
+// Real-time safety checker for the trowaSoft process() paths (Linux, LD_PRELOAD).
+// Interposes malloc/calloc/realloc/memalign/free and pthread_mutex_lock. Calls made
+// while a thread is inside a trowaSoft process() (the plugin built with
+// TROWA_RT_CHECK=1 calls tsrt_enter()/tsrt_exit() around each one) are violations.
+// Each violation is counted per call site (hash of the return addresses). The first
+// time a site is hit its backtrace is printed to stderr; a summary prints at exit.
+//
+// Environment:
+// TSRT_TRAP=1 : Raise SIGTRAP on each new site (run under gdb to stop at the call).
+//
+// Build: make (in this folder). See the Makefile for how to run it.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <execinfo.h>
+#include <atomic>
+
+#define TSRT_MAX_SITES		1024 // Max distinct call sites we track.
+#define TSRT_MAX_FRAMES		  32 // Frames captured (and printed) per site.
+#define TSRT_KEY_FRAMES		   8 // Frames hashed into the site key.
+#define TSRT_MSG_SIZE		 256 // Max header line length.
+
+#define TSRT_EXPORT		extern "C" __attribute__((visibility("default")))
+#define TSRT_TLS		__thread __attribute__((tls_model("initial-exec")))
+
+// glibc's own allocator entry points (so we never need dlsym for these).
+extern "C" {
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t num, size_t size);
+	void* __libc_realloc(void* ptr, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void* ptr);
+}
+
+// What the audio thread did.
+enum TSRTKind {
+	TSRTMalloc,
+	TSRTCalloc,
+	TSRTRealloc,
+	TSRTMemalign,
+	TSRTFree,
+	TSRTMutexLock,
+	TSRT_NUM_KINDS
+};
+static const char* TSRTKindNames[TSRT_NUM_KINDS] = { "malloc", "calloc", "realloc", "memalign", "free", "pthread_mutex_lock" };
+
+// One call site.
+struct TSRTSite {
+	// Hash of kind + return addresses (0 for an empty slot).
+	std::atomic<uint64_t> key;
+	std::atomic<uint32_t> count;
+	int kind;
+	// Module (process()) it was first seen in.
+	const char* module;
+};
+
+static TSRTSite tsrtSites[TSRT_MAX_SITES];
+// Number of sites in use.
+static std::atomic<int> tsrtNumSites { 0 };
+// Violations we could not give a site (table full).
+static std::atomic<uint32_t> tsrtOverflowCount { 0 };
+// Raise SIGTRAP on new sites.
+static int tsrtTrap = 0;
+// Real pthread_mutex_lock.
+typedef int (*TSRTMutexLockFn)(pthread_mutex_t*);
+static TSRTMutexLockFn tsrtRealMutexLock = NULL;
+
+// Depth of process() calls on this thread (> 0 means we are on the audio path).
+static TSRT_TLS int tsrtDepth = 0;
+// Name of the outermost process() on this thread.
+static TSRT_TLS const char* tsrtModule = NULL;
+// We are inside our own reporting code (anything it allocates is ours).
+static TSRT_TLS int tsrtInHook = 0;
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// tsrtWrite()
+// Write a string to stderr (no stdio, no allocation).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+static void tsrtWrite(const char* str)
+{
+	size_t len = strlen(str);
+	while (len > 0)
+	{
+		ssize_t n = write(STDERR_FILENO, str, len);
+		if (n <= 0)
+			break;
+		str += n;
+		len -= n;
+	}
+	return;
+}
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// tsrtViolation()
+// Record a real-time violation on this thread.
+// @kind : (IN) What was called.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+static void tsrtViolation(TSRTKind kind)
+{
+	tsrtInHook = 1;
+	void* frames[TSRT_MAX_FRAMES];
+	int numFrames = backtrace(frames, TSRT_MAX_FRAMES);
+	// Frame 0 is us, frame 1 is the interposed function.
+	uint64_t key = 14695981039346656037ULL ^ (uint64_t)kind;
+	for (int i = 2; i < numFrames && i < 2 + TSRT_KEY_FRAMES; i++)
+	{
+		key ^= (uint64_t)(uintptr_t)frames[i];
+		key *= 1099511628211ULL;
+	}
+	if (key == 0)
+		key = 1;
+	// Find or claim the slot (linear probe).
+	bool isNew = false;
+	TSRTSite* site = NULL;
+	for (int n = 0; n < TSRT_MAX_SITES && site == NULL; n++)
+	{
+		TSRTSite* s = &(tsrtSites[(key + n) % TSRT_MAX_SITES]);
+		uint64_t k = s->key.load(std::memory_order_acquire);
+		if (k == 0)
+		{
+			if (s->key.compare_exchange_strong(k, key))
+			{
+				s->kind = kind;
+				s->module = tsrtModule;
+				tsrtNumSites.fetch_add(1);
+				site = s;
+				isNew = true;
+			}
+		}
+		if (k == key)
+			site = s;
+	}
+	if (site == NULL)
+	{
+		tsrtOverflowCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		site->count.fetch_add(1, std::memory_order_relaxed);
+		if (isNew)
+		{
+			char msg[TSRT_MSG_SIZE];
+			snprintf(msg, TSRT_MSG_SIZE, "[tsrtcheck] %s in process() of %s (new site %d):\n", TSRTKindNames[kind],
+				(tsrtModule) ? tsrtModule : "?", tsrtNumSites.load());
+			tsrtWrite(msg);
+			backtrace_symbols_fd(frames + 1, numFrames - 1, STDERR_FILENO);
+			if (tsrtTrap)
+				raise(SIGTRAP);
+		}
+	}
+	tsrtInHook = 0;
+	return;
+}
+
+// If a call on this thread right now is a violation.
+static inline bool tsrtOnAudioPath()
+{
+	return tsrtDepth > 0 && !tsrtInHook;
+}
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Exported: called by the plugin (TSRealTimeCheck.cpp) around each process().
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+TSRT_EXPORT void tsrt_enter(const char* module)
+{
+	if (tsrtDepth++ == 0)
+		tsrtModule = module;
+	return;
+}
+TSRT_EXPORT void tsrt_exit()
+{
+	if (tsrtDepth > 0)
+		tsrtDepth--;
+	return;
+}
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Interposed allocator.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+TSRT_EXPORT void* malloc(size_t size)
+{
+	if (tsrtOnAudioPath())
+		tsrtViolation(TSRTMalloc);
+	return __libc_malloc(size);
+}
+TSRT_EXPORT void* calloc(size_t num, size_t size)
+{
+	if (tsrtOnAudioPath())
+		tsrtViolation(TSRTCalloc);
+	return __libc_calloc(num, size);
+}
+TSRT_EXPORT void* realloc(void* ptr, size_t size)
+{
+	if (tsrtOnAudioPath())
+		tsrtViolation(TSRTRealloc);
+	return __libc_realloc(ptr, size);
+}
+TSRT_EXPORT void free(void* ptr)
+{
+	if (ptr != NULL && tsrtOnAudioPath())
+		tsrtViolation(TSRTFree);
+	__libc_free(ptr);
+	return;
+}
+TSRT_EXPORT void* memalign(size_t alignment, size_t size)
+{
+	if (tsrtOnAudioPath())
+		tsrtViolation(TSRTMemalign);
+	return __libc_memalign(alignment, size);
+}
+TSRT_EXPORT void* aligned_alloc(size_t alignment, size_t size)
+{
+	if (tsrtOnAudioPath())
+		tsrtViolation(TSRTMemalign);
+	return __libc_memalign(alignment, size);
+}
+TSRT_EXPORT int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+	if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+		return EINVAL;
+	if (tsrtOnAudioPath())
+		tsrtViolation(TSRTMemalign);
+	void* p = __libc_memalign(alignment, size);
+	if (p == NULL && size > 0)
+		return ENOMEM;
+	*ptr = p;
+	return 0;
+}
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Interposed mutex lock (std::mutex::lock() ends up here). try_lock is fine.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+TSRT_EXPORT int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+	if (tsrtRealMutexLock == NULL)
+		tsrtRealMutexLock = (TSRTMutexLockFn)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+	if (tsrtOnAudioPath())
+		tsrtViolation(TSRTMutexLock);
+	return tsrtRealMutexLock(mutex);
+}
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// tsrtInit()
+// Load time: resolve the real lock and warm up backtrace() (its first call loads
+// libgcc_s, which allocates).
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+__attribute__((constructor)) static void tsrtInit()
+{
+	if (tsrtRealMutexLock == NULL)
+		tsrtRealMutexLock = (TSRTMutexLockFn)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+	void* frames[2];
+	backtrace(frames, 2);
+	const char* trap = getenv("TSRT_TRAP");
+	tsrtTrap = (trap != NULL && trap[0] == '1');
+	tsrtWrite("[tsrtcheck] Loaded. Checking trowaSoft process() calls (plugin must be built with RTCHECK=1).\n");
+	return;
+}
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// tsrtSummary()
+// Exit: print the count for every site.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+__attribute__((destructor)) static void tsrtSummary()
+{
+	char msg[TSRT_MSG_SIZE];
+	uint32_t total = tsrtOverflowCount.load();
+	for (int i = 0; i < TSRT_MAX_SITES; i++)
+		total += tsrtSites[i].count.load();
+	if (total == 0)
+	{
+		tsrtWrite("[tsrtcheck] No real-time violations in process().\n");
+		return;
+	}
+	snprintf(msg, TSRT_MSG_SIZE, "[tsrtcheck] %u violation(s) at %d site(s):\n", total, tsrtNumSites.load());
+	tsrtWrite(msg);
+	for (int i = 0; i < TSRT_MAX_SITES; i++)
+	{
+		TSRTSite* s = &(tsrtSites[i]);
+		if (s->key.load() == 0)
+			continue;
+		snprintf(msg, TSRT_MSG_SIZE, "  %-18s x %u in %s (key %016llx)\n", TSRTKindNames[s->kind], s->count.load(),
+			(s->module) ? s->module : "?", (unsigned long long)s->key.load());
+		tsrtWrite(msg);
+	}
+	if (tsrtOverflowCount.load() > 0)
+	{
+		snprintf(msg, TSRT_MSG_SIZE, "  (%u more at untracked sites - table full)\n", tsrtOverflowCount.load());
+		tsrtWrite(msg);
+	}
+	return;
+}
@@ -0,0 +1,211 @@
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// scopeBench
+// Stand-alone benchmark for the multiScope XY (lissajous) trace simplification
+// (src/TSScopeTrace). Builds screen space traces of some typical (and some bad)
+// figures the way multiScopeDisplay does (BUFFER_SIZE points mapped onto the
+// display) and, for each quality, reports:
+//   + Vertices handed to nanovg (before/after).
+//   + Time spent simplifying per trace.
+//   + Fidelity: the farthest any buffered point is from the simplified trace [px].
+// nanovg itself is not run here; its stroke expansion and the GPU work scale
+// with the vertex count.
+//
+// Build: make (in this folder). Run with --help for options.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include "TSScopeTrace.hpp"
+
+#define BENCH_BUFFER_SIZE		512 // Same as the scope (BUFFER_SIZE in TSScopeBase.hpp).
+
+typedef std::chrono::steady_clock BenchClock;
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// Command line options.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct BenchOptions {
+	float width = 600.0f; // Display size [px]
+	float height = 380.0f;
+	float lineThickness = 3.0f; // Scope default
+	int iterations = 2000; // Traces timed per figure/quality
+};
+
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+// A test figure: x = sin(fx * t + phase), y = sin(fy * t) with t over the buffer.
+//-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-
+struct BenchFigure {
+	const char* name;
+	// Cycles (of the y wave) in one buffer.
+	float cycles;
+	// X frequency / Y frequency.
+	float ratio;
+	float phase;
+	// Random walk instead (worst case, nothing to drop).
+	bool noise;
+};
+static const BenchFigure FIGURES[] = {
+	{ "slow 1:1 (0.05 cycle)", 0.05f, 1.0f, 1.5708f, false },
+	{ "slow 1:2 (0.25 cycle)", 0.25f, 2.0f, 0.0f, false },
+	{ "circle 1:1 (1 cycle)", 1.0f, 1.0f, 1.5708f, false },
+	{ "3:2 (4 cycles)", 4.0f, 1.5f, 0.3f, false },
+	{ "13:8 dense (20 cycles)", 20.0f, 1.625f, 0.1f, false },
+	{ "noise", 0.0f, 0.0f, 0.0f, true }
+};
+#define BENCH_NUM_FIGURES	(int)(sizeof(FIGURES) / sizeof(FIGURES[0]))
+
+//--------------------------------------------------------
+// buildTrace()
+// Fill the path like multiScopeDisplay::drawWaveform() does (80% of the display).
+//--------------------------------------------------------
+static void buildTrace(const BenchFigure& fig, const BenchOptions& opts, TSScopeTracePath* path)
+{
+	path->clear();
+	float nx = 0.0f, ny = 0.0f;
+	srand(1);
+	for (int i = 0; i < BENCH_BUFFER_SIZE; i++)
+	{
+		float vx, vy;
+		if (fig.noise)
+		{
+			nx = fminf(fmaxf(nx + (rand() / (float)RAND_MAX - 0.5f) * 0.2f, -1.0f), 1.0f);
+			ny = fminf(fmaxf(ny + (rand() / (float)RAND_MAX - 0.5f) * 0.2f, -1.0f), 1.0f);
+			vx = nx;
+			vy = ny;
+		}
+		else
+		{
+			float t = 2.0f * (float)M_PI * fig.cycles * i / (BENCH_BUFFER_SIZE - 1);
+			vx = sinf(fig.ratio * t + fig.phase);
+			vy = sinf(t);
+		}
+		float x = opts.width * (vx * 0.4f + 0.5f);
+		float y = opts.height * (1.0f - (vy * 0.4f + 0.5f));
+		if (i == 0)
+			path->moveTo(x, y);
+		else
+			path->lineTo(x, y);
+	}
+	return;
+}
+
+//--------------------------------------------------------
+// maxDeviation()
+// @returns : The farthest any raw point is from the simplified path [px].
+//--------------------------------------------------------
+static float maxDeviation(const TSScopeTracePath& raw, const TSScopeTracePath& simple)
+{
+	float maxD = 0.0f;
+	for (int i = 0; i < raw.numPoints; i++)
+	{
+		float best = 1e30f;
+		for (int j = 0; j < simple.numPoints; j++)
+		{
+			float ax = simple.x[j], ay = simple.y[j];
+			float bx = ax, by = ay;
+			if (j + 1 < simple.numPoints && !simple.start[j + 1])
+			{
+				bx = simple.x[j + 1];
+				by = simple.y[j + 1];
+			}
+			float dx = bx - ax, dy = by - ay;
+			float len2 = dx * dx + dy * dy;
+			float t = (len2 > 0.0f) ? ((raw.x[i] - ax) * dx + (raw.y[i] - ay) * dy) / len2 : 0.0f;
+			t = fminf(fmaxf(t, 0.0f), 1.0f);
+			float ex = ax + t * dx - raw.x[i], ey = ay + t * dy - raw.y[i];
+			best = fminf(best, ex * ex + ey * ey);
+		}
+		maxD = fmaxf(maxD, sqrtf(best));
+	}
+	return maxD;
+}
+
+//--------------------------------------------------------
+// printUsage()
+//--------------------------------------------------------
+static void printUsage(const char* exeName)
+{
+	printf("Usage: %s [options]\n", exeName);
+	printf("  --width <px>         Display width (default 600).\n");
+	printf("  --height <px>        Display height (default 380).\n");
+	printf("  --thickness <px>     Line thickness (default 3).\n");
+	printf("  --iterations <n>     Traces timed per figure and quality (default 2000).\n");
+	return;
+}
+
+//--------------------------------------------------------
+// parseArgs()
+// @returns : True if ok.
+//--------------------------------------------------------
+static bool parseArgs(int argc, char* argv[], BenchOptions& opts)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasVal = i + 1 < argc;
+		if (arg == "--help" || arg == "-h")
+			return false;
+		else if (!hasVal)
+		{
+			fprintf(stderr, "Missing value for %s.\n", arg.c_str());
+			return false;
+		}
+		else if (arg == "--width")
+			opts.width = (float)atof(argv[++i]);
+		else if (arg == "--height")
+			opts.height = (float)atof(argv[++i]);
+		else if (arg == "--thickness")
+			opts.lineThickness = (float)atof(argv[++i]);
+		else if (arg == "--iterations")
+			opts.iterations = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Unknown option %s.\n", arg.c_str());
+			return false;
+		}
+	}
+	return opts.width > 0 && opts.height > 0 && opts.lineThickness > 0 && opts.iterations > 0;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchOptions opts;
+	if (!parseArgs(argc, argv, opts))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+	static TSScopeTracePath raw;
+	static TSScopeTracePath path;
+	printf("Display %.0fx%.0f px, line thickness %.1f px, %d points per trace.\n\n", opts.width, opts.height, opts.lineThickness, BENCH_BUFFER_SIZE);
+	printf("%-24s %-20s %9s %9s %9s %12s\n", "Figure", "Quality", "Vertices", "Kept", "Us/trace", "Max dev px");
+	for (int f = 0; f < BENCH_NUM_FIGURES; f++)
+	{
+		buildTrace(FIGURES[f], opts, &raw);
+		for (int q = 0; q < TRACE_NUM_QUALITIES; q++)
+		{
+			float tolerance = opts.lineThickness * TSScopeTraceQualityTolerance[q];
+			BenchClock::time_point start = BenchClock::now();
+			for (int i = 0; i < opts.iterations; i++)
+			{
+				path = raw;
+				path.simplify(tolerance);
+			}
+			double us = std::chrono::duration<double, std::micro>(BenchClock::now() - start).count() / opts.iterations;
+			// Copy alone (not part of the simplification cost)
+			start = BenchClock::now();
+			for (int i = 0; i < opts.iterations; i++)
+			{
+				path = raw;
+			}
+			us -= std::chrono::duration<double, std::micro>(BenchClock::now() - start).count() / opts.iterations;
+			path.simplify(tolerance);
+			printf("%-24s %-20s %9d %8.1f%% %9.2f %12.3f\n", FIGURES[f].name, TSScopeTraceQualityNames[q], raw.numPoints,
+				100.0 * path.numPoints / raw.numPoints, (us > 0) ? us : 0.0, maxDeviation(raw, path));
+		}
+	}
+	return 0;
+}